@@ -55,9 +55,9 @@
 // ADCConfig structure for stm32 MCUs is empty
 static ADCConfig adccfg = {0};
 
-// Create buffer to store ADC results
+// Create buffer to store ADC results, VEX_ADC_DEPTH scans of all channels
 #define ADC_CH_NUM      8
-static adcsample_t samples_buf[ ADC_CH_NUM ];
+static adcsample_t samples_buf[ ADC_CH_NUM * VEX_ADC_DEPTH ];
 
 // Fill ADCConversionGroup structure fields
 static ADCConversionGroup adccg = {
@@ -106,8 +106,9 @@ vexAdcInit()
     adcInit();
     adcStart(&ADCD1, &adccfg);
 
-    // Start conversions
-    adcStartConversion(&ADCD1, &adccg, &samples_buf[0], 1);
+    // Start conversions, the DMA interrupts once per half buffer
+    // rather than after every scan
+    adcStartConversion(&ADCD1, &adccg, &samples_buf[0], VEX_ADC_DEPTH);
 }
 
 /*-----------------------------------------------------------------------------*/
@@ -115,6 +116,9 @@ vexAdcInit()
 /** @param[in]  index The index of the adc channel (0 through 7)               */
 /** @return     The ADC value in the range 0 to 4095                           */
 /*-----------------------------------------------------------------------------*/
+/** @details
+ *  The value is the average of the last VEX_ADC_DEPTH conversions
+ */
 
 int16_t
 vexAdcGet( int16_t index )
@@ -122,7 +126,34 @@ vexAdcGet( int16_t index )
     if( (index < 0) || (index > 7))
         return(-1);
     else
-        return( samples_buf[ index ] );
+        return( (vexAdcGetSum( index ) + VEX_ADC_DEPTH/2) / VEX_ADC_DEPTH );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Return the sum of the ADC samples in the sample buffer         */
+/** @param[in]  index The index of the adc channel (0 through 7)               */
+/** @return     The sum in the range 0 to 4095 * VEX_ADC_DEPTH                 */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Used to oversample an analog port, the sum has log2(VEX_ADC_DEPTH) more
+ *  bits than a single conversion although only about half of them are
+ *  useful.  The DMA may update some samples while they are added, each
+ *  sample is still a complete conversion.
+ */
+
+int32_t
+vexAdcGetSum( int16_t index )
+{
+    int32_t     sum = 0;
+    int16_t     i;
+
+    if( (index < 0) || (index > 7))
+        return(-1);
+
+    for(i=0;i<VEX_ADC_DEPTH;i++)
+        sum += samples_buf[ index + (i * ADC_CH_NUM) ];
+
+    return( sum );
 }
 
 /*-----------------------------------------------------------------------------*/
@@ -71,12 +71,23 @@ typedef enum {
     kVexAnalog_Num
     } tVexAnalogPin;
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      Number of conversions kept for each analog port                */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The ADC scans all 8 ports continuously, one scan takes about 56uS.  The
+ *  last VEX_ADC_DEPTH scans are kept, about 0.9mS, so a task sampling at 1mS
+ *  can oversample a port with vexAdcGetSum.
+ */
+#define VEX_ADC_DEPTH   16
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 void        vexAdcInit( void );
 int16_t     vexAdcGet( int16_t index );
+int32_t     vexAdcGetSum( int16_t index );
 void        vexAdcDebug( vexStream *chp, int argc, char *argv[] );
 
 #ifdef __cplusplus
@@ -288,6 +288,8 @@ vexMotorConfigure( vexMotorCfg *cfg, int16_t cfg_num )
                 vexMotorPositionGetCallback( _cfg->port, vexEncoderGet, _cfg->channel );
                 // set the set position callback
                 vexMotorPositionSetCallback( _cfg->port, vexEncoderSet, _cfg->channel );
+                // set the get velocity callback
+                vexMotorVelocityGetCallback( _cfg->port, vexEncoderVelocityGet, _cfg->channel );
                 // set the id request callback
                 vexMotorEncoderIdCallback( _cfg->port, vexEncoderGetId, _cfg->channel );
                 break;
@@ -469,8 +469,9 @@ vexCortexSystemTask(void *arg) {
           for(m=0;m<8;m++)
               vexSpiSetMotor( m, vexMotorGet( m+1 ), vexMotorDirectionGet(m+1) );
 
-          // comms to master
-          vexSpiSend();
+          // comms to master, wake anyone waiting for a new controller frame
+          if( vexSpiSend() )
+              chEvtBroadcast( vexSpiGetFrameEventSource() );
 #ifdef    VEX_WATCHDOG_ENABLE
           vexWatchdogReload();
 #endif
@@ -58,6 +58,8 @@
 
 static  uint16_t    vexLocalCompState;  ///< Used to override the comp state
 
+static  int16_t     vexControllerDecode( const jsdata *js, tCtlIndex index );
+
 /*-----------------------------------------------------------------------------*/
 /** @brief      Set competition state, a simulation of the competition modes   */
 /** @param[in]  ctl The control byte                                           */
@@ -123,14 +125,40 @@ vexControllerCompetitonState()
 int16_t
 vexControllerGet( tCtlIndex index )
 {
-    jsdata *js;
-    int16_t analog;
-
     // Get pointer to raw joystick data
     if(index < Ch1Xmtr2)
-        js = vexSpiGetJoystickDataPtr( 1 );
+        return( vexControllerDecode( vexSpiGetJoystickDataPtr( 1 ), index ) );
     else
-        js = vexSpiGetJoystickDataPtr( 2 );
+        return( vexControllerDecode( vexSpiGetJoystickDataPtr( 2 ), index ) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get controller data from a saved frame                         */
+/** @param[in]  frame A frame copied with vexSpiGetFrame                       */
+/** @param[in]  index The required controller variable eg. Btn8U               */
+/** @returns    The requested controller data                                  */
+/*-----------------------------------------------------------------------------*/
+
+int16_t
+vexControllerFrameGet( const vexSpiFrame *frame, tCtlIndex index )
+{
+    if(index < Ch1Xmtr2)
+        return( vexControllerDecode( &frame->js_1, index ) );
+    else
+        return( vexControllerDecode( &frame->js_2, index ) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Decode controller data from raw joystick data                  */
+/** @param[in]  js    Pointer to the raw joystick data                         */
+/** @param[in]  index The required controller variable eg. Btn8U               */
+/** @returns    The requested controller data                                  */
+/*-----------------------------------------------------------------------------*/
+
+static int16_t
+vexControllerDecode( const jsdata *js, tCtlIndex index )
+{
+    int16_t analog;
 
     // decode data, needs transmitter 2 to be defined as index + 0x80
     switch( index & 0x7F )
@@ -60,6 +60,39 @@
 
 static  vexQuadEncoder_t    vexQuadEncoders[kVexQuadEncoder_Num];
 
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*  Common part of both service routines, count the edge and time it.          */
+/*  Edges are timed with the free running cycle counter, the time of each of   */
+/*  the last four edges is kept in times[] indexed by the count so period      */
+/*  covers a full quadrature cycle, this removes the uneven spacing of the A   */
+/*  and B edges.  run counts edges since the last change of direction, period  */
+/*  is only valid once it reaches 4.                                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+static inline void
+vexEncoderIrqEdge( vexQuadEncoder_t *enc, uint32_t now, int16_t dir )
+{
+    volatile uint32_t *slot;
+
+    enc->count += dir;
+
+    if( dir != enc->dir )
+        {
+        enc->dir = dir;
+        enc->run = 0;
+        }
+    else
+    if( enc->run < 4 )
+        enc->run++;
+
+    slot = &enc->times[ enc->count & 3 ];
+    enc->period = now - *slot;
+    *slot = now;
+    enc->edge = now;
+}
+
 /*-----------------------------------------------------------------------------*/
 /*                                                                             */
 /*  There are 10 interrupt handlers, one for each input on up to 5 encoders    */
@@ -74,13 +107,17 @@ vexEncoderIrqServiceA( vexQuadEncoder_t *enc )
 {
     int16_t pa;
     int16_t pb;
+    uint32_t now;
+
+    // time the edge before anything else
+    now = halGetCounterValue();
 
     // Read state of pins
     pa = (int16_t)palReadPad( enc->pa_port,  enc->pa_pad );
     pb = (int16_t)palReadPad( enc->pb_port,  enc->pb_pad );
 
     // we were interrupted by pa
-    if( pa ^ pb )enc->count--; else enc->count++;
+    vexEncoderIrqEdge( enc, now, ( pa ^ pb ) ? -1 : 1 );
 }
 
 /*-----------------------------------------------------------------------------*/
@@ -91,13 +128,17 @@ vexEncoderIrqServiceB( vexQuadEncoder_t *enc )
 {
     int16_t pa;
     int16_t pb;
+    uint32_t now;
+
+    // time the edge before anything else
+    now = halGetCounterValue();
 
     // Read state of pins
     pa = (int16_t)palReadPad( enc->pa_port,  enc->pa_pad );
     pb = (int16_t)palReadPad( enc->pb_port,  enc->pb_pad );
 
     // we were interrupted by pb
-    if( pa ^ pb )enc->count++; else enc->count--;
+    vexEncoderIrqEdge( enc, now, ( pa ^ pb ) ? 1 : -1 );
 }
 
 /*-----------------------------------------------------------------------------*/
@@ -283,6 +324,29 @@ static  extcallback_t   _vqe_cb_b[kVexQuadEncoder_Num] = {
         _vqe_5_cb_b
     };
 
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*  Clear the edge timing and velocity window of an encoder, call with the     */
+/*  encoder interrupts stopped.                                                */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+static void
+vexEncoderVelocityReset( vexQuadEncoder_t *enc )
+{
+    int16_t i;
+
+    enc->edge   = 0;
+    enc->period = 0;
+    for(i=0;i<4;i++)
+        enc->times[i] = 0;
+    enc->run    = 0;
+    enc->dir    = 0;
+    enc->vel_count = enc->count;
+    enc->vel_edge  = 0;
+    enc->velocity  = 0;
+}
+
 /*-----------------------------------------------------------------------------*/
 /** @brief    Initialize all the encoder data, counts to zero etc.             */
 /*-----------------------------------------------------------------------------*/
@@ -297,6 +361,7 @@ vexEncoderInit()
         vexQuadEncoders[c].state  = 0;
         vexQuadEncoders[c].count  = 0;
         vexQuadEncoders[c].offset = 0;
+        vexEncoderVelocityReset( &vexQuadEncoders[c] );
         }
 }
 
@@ -324,6 +389,7 @@ vexEncoderAdd( tVexQuadEncoderChannel channel, tVexDigitalPin pa, tVexDigitalPin
     // zero variables
     vexQuadEncoders[channel].count  = 0;
     vexQuadEncoders[channel].offset = 0;
+    vexEncoderVelocityReset( &vexQuadEncoders[channel] );
 
     // setup first input
     vexDigitalModeSet( pa, kVexDigitalInput);
@@ -425,6 +491,157 @@ vexEncoderSet( int16_t channel, int32_t value )
     vexQuadEncoders[channel].offset = vexQuadEncoders[channel].count - value;
 }
 
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*  counts * cycle counter frequency / cycles without needing 64 bit math,     */
+/*  both sides are scaled by 1000 which leaves a resolution of 1000 cycles,    */
+/*  about 14uS, against a window of at least one SmartMotor period.            */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+static int32_t
+vexEncoderRate( int32_t counts, uint32_t cycles )
+{
+    int32_t kfreq   = (int32_t)(halGetCounterFrequency() / 1000);
+    int32_t kcycles = (int32_t)(cycles / 1000);
+
+    if( kcycles == 0 )
+        kcycles = 1;
+
+    if( abs(counts) < 0x7FFFFFFF / kfreq )
+        return( (counts * kfreq) / kcycles );
+    else
+        return( (counts / kcycles) * kfreq );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get encoder velocity                                           */
+/** @param[in]  channel The encoder channel                                    */
+/** @returns    The velocity in counts per second                              */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Estimate the velocity of an encoder from the edge times recorded by the
+ *  interrupt handlers.  At low speed the count difference over a sample
+ *  period is only a few counts and very noisy, so the speed is taken from
+ *  the time the last four edges took (1/T), and limited by the time since
+ *  the last edge so it falls away when the encoder stops.  At high speed the
+ *  count difference is used, divided by the time between the edges that
+ *  bound the window rather than by the sample period so it is not affected
+ *  by when in the edge interval the sample was taken.
+ *
+ *  Each call ends the velocity window of the previous call, so this should
+ *  only be called from one periodic task, usually the SmartMotor task, other
+ *  code can read the last estimate from the velocity member.  The window
+ *  stays open until at least one edge arrives.
+ *
+ *  The cycle counter wraps after about 60 seconds, an encoder that has not
+ *  moved for VEX_ENCODER_VEL_TIMEOUT mS is marked stopped so a stale edge
+ *  time is never used, this relies on the function being called more often
+ *  than the counter wraps.
+ */
+
+int32_t
+vexEncoderVelocityGet( int16_t channel )
+{
+    vexQuadEncoder_t *enc;
+    int32_t     count;
+    uint32_t    edge;
+    uint32_t    period;
+    int16_t     run;
+    int16_t     dir;
+    uint32_t    now;
+    uint32_t    since;
+    uint32_t    freq = halGetCounterFrequency();
+    int32_t     delta;
+    int32_t     vt = 0;
+    int32_t     vc = 0;
+    int32_t     w;
+    int32_t     v;
+
+    if( channel < 0 || channel >= kVexQuadEncoder_Num )
+        return(0);
+
+    enc = &vexQuadEncoders[channel];
+
+    // take the edge data as one set
+    chSysLock();
+    count  = enc->count;
+    edge   = enc->edge;
+    period = enc->period;
+    run    = enc->run;
+    dir    = enc->dir;
+    now    = halGetCounterValue();
+    since  = now - edge;
+    if( dir != 0 && since > (freq / 1000) * VEX_ENCODER_VEL_TIMEOUT )
+        {
+        // stopped, the next edge starts a new run
+        enc->dir = 0;
+        dir = 0;
+        }
+    chSysUnlock();
+
+    if( dir == 0 )
+        {
+        enc->vel_count = count;
+        enc->vel_edge  = edge;
+        enc->velocity  = 0;
+        return(0);
+        }
+
+    // count difference over the edges bounding the window
+    delta = count - enc->vel_count;
+    if( delta != 0 && edge != enc->vel_edge )
+        vc = vexEncoderRate( delta, edge - enc->vel_edge );
+
+    // period of the last four edges, but no faster than the time since the
+    // last edge allows
+    if( run >= 4 && period != 0 )
+        {
+        if( since > period / 4 )
+            vt = (int32_t)(freq / since);
+        else
+            vt = (int32_t)((4 * freq) / period);
+        vt = dir * vt;
+        }
+
+    if( run < 4 )
+        {
+        // just reversed or started, no period yet
+        if( delta != 0 )
+            v = vc;
+        else
+            {
+            // hold the last estimate while it is still possible
+            v = (int32_t)(freq / since);
+            if( abs(enc->velocity) < v )
+                v = abs(enc->velocity);
+            v = dir * v;
+            }
+        }
+    else
+        {
+        // weight of the count difference, 0 to 256
+        w = ((abs(delta) - VEX_ENCODER_BLEND_LOW) * 256) / (VEX_ENCODER_BLEND_HIGH - VEX_ENCODER_BLEND_LOW);
+        if( w < 0 || vc == 0 )
+            w = 0;
+        if( w > 256 )
+            w = 256;
+
+        v = (vt * (256 - w) + vc * w) / 256;
+        }
+
+    // a new window starts at the last edge
+    if( delta != 0 )
+        {
+        enc->vel_count = count;
+        enc->vel_edge  = edge;
+        }
+
+    enc->velocity = v;
+
+    return( v );
+}
+
 /*-----------------------------------------------------------------------------*/
 /** @brief      Get encoder id                                                 */
 /** @param[in]  channel The encoder channel                                    */
@@ -463,7 +680,7 @@ vexEncoderDebug(vexStream *chp, int argc, char *argv[])
     tVexQuadEncoderChannel  c;
 
     for(c=kVexQuadEncoder_1;c<kVexQuadEncoder_Num;c++)
-        vex_chprintf(chp,"E%d %8ld  %8ld\r\n", c, vexQuadEncoders[c].count, vexQuadEncoders[c].offset );
+        vex_chprintf(chp,"E%d %8ld  %8ld  %8ld\r\n", c, vexQuadEncoders[c].count, vexQuadEncoders[c].offset, vexQuadEncoders[c].velocity );
 }
 
 
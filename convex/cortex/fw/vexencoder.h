@@ -83,8 +83,30 @@ typedef struct _vexQuadEncoder_t {
     int16_t           pa_pad;     ///< Encoder GPIO pad a
     ioportid_t        pb_port;    ///< Encoder GPIO port b
     int16_t           pb_pad;     ///< Encoder GPIO pad b
+    volatile uint32_t edge;       ///< cycle counter at the last edge
+    volatile uint32_t period;     ///< cycles taken by the last four edges
+    volatile uint32_t times[4];   ///< cycle counter at each of the last four edges
+    volatile int16_t  run;        ///< edges seen in the current direction, max 4
+    volatile int16_t  dir;        ///< direction of the last edge, 0 if stopped
+    int32_t           vel_count;  ///< count at the start of the velocity window
+    uint32_t          vel_edge;   ///< edge time at the start of the velocity window
+    int32_t           velocity;   ///< last velocity estimate in counts/s
 } vexQuadEncoder_t;
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      Velocity estimation                                            */
+/*-----------------------------------------------------------------------------*/
+/** @note
+ *  Below VEX_ENCODER_BLEND_LOW counts in a velocity window the speed comes
+ *  from the time taken by the last four edges, above VEX_ENCODER_BLEND_HIGH
+ *  it comes from the counts divided by the time between the first and last
+ *  edge of the window, in between the two are blended.  With no edge for
+ *  VEX_ENCODER_VEL_TIMEOUT mS the encoder is considered stopped.
+ */
+#define VEX_ENCODER_BLEND_LOW       2
+#define VEX_ENCODER_BLEND_HIGH      8
+#define VEX_ENCODER_VEL_TIMEOUT     250
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -97,6 +119,7 @@ void                vexEncoderStop( tVexQuadEncoderChannel channel );
 void                vexEncoderStartAll(void);
 int32_t             vexEncoderGet( int16_t channel );
 void                vexEncoderSet( int16_t channel, int32_t value );
+int32_t             vexEncoderVelocityGet( int16_t channel );
 int16_t             vexEncoderGetId( int16_t channel );
 void                vexEncoderDebug(vexStream *chp, int argc, char *argv[]);
 
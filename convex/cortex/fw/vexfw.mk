@@ -17,6 +17,7 @@ VEXFWSRC = ${CONVEX}/fw/vexshell.c \
            ${CONVEX}/fw/vexrttl.c \
            ${CONVEX}/fw/vexsensor.c \
            ${CONVEX}/fw/vexbkup.c \
+           ${CONVEX}/fw/vextrace.c \
            ${CONVEX}/fw/vextest.c
 
 # Required include directories
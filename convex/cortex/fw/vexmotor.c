@@ -86,6 +86,7 @@ vexMotorInit()
         vexMotors[i].reversed = FALSE;
         vexMotors[i].motorPositionGet = NULL;
         vexMotors[i].motorPositionSet = NULL;
+        vexMotors[i].motorVelocityGet = NULL;
         }
 
     // Initialize the two H-Bridge motor controllers
@@ -340,6 +341,55 @@ vexMotorEncoderIdGet( int16_t index )
         return(-1);
 }
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the current motor velocity                                 */
+/** @param[in]  index The motor index                                          */
+/** @returns    The motor velocity in encoder counts per second                */
+/** @note       Only quad encoders provide a velocity, others return 0         */
+/*-----------------------------------------------------------------------------*/
+
+int32_t
+vexMotorVelocityGet( int16_t index )
+{
+    int32_t     velocity;
+
+    if( (index < kVexMotor_1) || (index >= kVexMotorNum))
+        return(0);
+
+    if( vexMotors[ index ].motorVelocityGet != NULL )
+        {
+        velocity = vexMotors[ index ].motorVelocityGet( vexMotors[ index ].port );
+
+        // 269 needs reversing
+        if( vexMotors[ index ].type == kVexMotor269 )
+            velocity = -velocity;
+
+        if(!vexMotors[ index ].reversed )
+            return( velocity );
+        else
+            return( -velocity );
+        }
+    else
+        return(0);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Set the callback used to get motor velocity                    */
+/** @param[in]  index The motor index                                          */
+/** @param[in]  cb function used to get motor velocity                         */
+/** @param[in]  port A variable to send to the callback                        */
+/*-----------------------------------------------------------------------------*/
+
+void
+vexMotorVelocityGetCallback( int16_t index, int32_t (*cb)(int16_t), int16_t port )
+{
+    if( (index < kVexMotor_1) || (index >= kVexMotorNum))
+        return;
+
+    vexMotors[ index ].motorVelocityGet = cb;
+    vexMotors[ index ].port = port;
+}
+
 /*-----------------------------------------------------------------------------*/
 /** @brief      Command line debug of motors                                   */
 /** @param[in]  chp     A pointer to a vexStream object                        */
@@ -407,6 +457,8 @@ CH_IRQ_HANDLER(TIM4_IRQHandler) {
 
     if( m0_cur_value != m0_new_value )
         {
+        vexTracePoint( kVexTracePwm );
+
         // new value is 0 then just set
         if( m0_new_value == 0 ) {
             _vexMotorPwmSet_0( 0 );
@@ -445,6 +497,8 @@ CH_IRQ_HANDLER(TIM4_IRQHandler) {
          m9_new_value = -vexMotors[kVexMotor_10].value;
      if( m9_cur_value != m9_new_value )
         {
+        vexTracePoint( kVexTracePwm );
+
         // new value is 0 then just set
         if( m9_new_value == 0 ) {
             _vexMotorPwmSet_9( 0 );
@@ -135,6 +135,7 @@ typedef struct _vexMotor {
     tVexMotorType       type;
     bool_t              reversed;
     int32_t            (*motorPositionGet)( int16_t port );
+    int32_t            (*motorVelocityGet)( int16_t port );
     void               (*motorPositionSet)( int16_t port, int32_t value );
     int16_t            (*getEncoderId)( int16_t port );
     int16_t             port;
@@ -158,6 +159,8 @@ void            vexMotorPositionGetCallback( int16_t index, int32_t (*cb)(int16_
 void            vexMotorPositionSetCallback( int16_t index, void    (*cb)(int16_t, int32_t), int16_t port );
 void            vexMotorEncoderIdCallback( int16_t index, int16_t (*cb)(int16_t), int16_t port );
 int16_t         vexMotorEncoderIdGet( int16_t index );
+int32_t         vexMotorVelocityGet( int16_t index );
+void            vexMotorVelocityGetCallback( int16_t index, int32_t (*cb)(int16_t), int16_t port );
 
 // do not call these
 /** @private                                                                   */
@@ -59,6 +59,8 @@
 /*  Storage for our SPI data                                                   */
 /*-----------------------------------------------------------------------------*/
 static  SpiData             vexSpiData;
+static  vexSpiFrame         vexSpiFrameData;
+static  EVENTSOURCE_DECL(spiFrameEvent);
 
 static  GPTDriver          *spiGpt    = &GPTD2;
 static  Thread             *spiThread = NULL;
@@ -141,6 +143,9 @@ vexSpiInit()
 
     vexSpiData.online = 0;
 
+    vexSpiFrameData.sequence = 0;
+    chEvtInit(&spiFrameEvent);
+
     // Initializes the SPI driver 1.
     spiStart(&SPID1, &spicfg);
 
@@ -309,6 +314,7 @@ vexSpiTickDelay(int16_t tick)
 
 /*-----------------------------------------------------------------------------*/
 /** @brief      Send/receive one message with the master processor             */
+/** @returns    TRUE if a valid packet was received                            */
 /** @note       This is generally called by the system task                    */
 /*-----------------------------------------------------------------------------*/
 /** @details
@@ -316,9 +322,11 @@ vexSpiTickDelay(int16_t tick)
  *  replaced with the use of a timer so compiler optimization can be used.
  *  Timing was then changed so there is really not much resemblance to the
  *  original code.
+ *  Each valid packet also replaces the controller frame snapshot, the caller
+ *  is expected to broadcast the frame event when TRUE is returned.
  */
 
-void
+bool_t
 vexSpiSend()
 {
     int16_t      i;
@@ -326,6 +334,9 @@ vexSpiSend()
     uint16_t    *txbuf = (uint16_t *)vexSpiData.txdata.data;
     uint16_t    *rxbuf = (uint16_t *)vexSpiData.rxdata_t.data;
 
+    // motor values for the current frame go out now
+    vexTracePoint( kVexTraceSpi );
+
     // configure team name if in configuration state
     if(vexSpiData.txdata.pak.state == 0x03)
         {
@@ -399,9 +410,60 @@ vexSpiSend()
                 vexSpiData.txdata.pak.type  = 0;
                 }
             }
+
+        // publish the new controller frame
+        chSysLock();
+        vexSpiFrameData.sequence++;
+        vexSpiFrameData.time    = chTimeNow();
+        vexSpiFrameData.counter = halGetCounterValue();
+        vexSpiFrameData.ctl     = (uint16_t)vexSpiData.rxdata.pak.ctl;
+        vexSpiFrameData.js_1    = vexSpiData.rxdata.pak.js_1;
+        vexSpiFrameData.js_2    = vexSpiData.rxdata.pak.js_2;
+        chSysUnlock();
+
+        vexTraceFrame( vexSpiFrameData.counter );
+
+        return( TRUE );
         }
     else
         vexSpiData.errors++;
+
+    return( FALSE );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Take a copy of the most recent controller frame                */
+/** @param[out] frame pointer to the vexSpiFrame to fill                       */
+/*-----------------------------------------------------------------------------*/
+
+void
+vexSpiGetFrame( vexSpiFrame *frame )
+{
+    chSysLock();
+    *frame = vexSpiFrameData;
+    chSysUnlock();
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the sequence number of the most recent controller frame    */
+/** @returns    The frame sequence number, 0 if no frame was received yet     */
+/*-----------------------------------------------------------------------------*/
+
+uint32_t
+vexSpiGetFrameSequence()
+{
+    return( vexSpiFrameData.sequence );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the event source broadcast after each controller frame     */
+/** @returns    pointer to the EventSource                                     */
+/*-----------------------------------------------------------------------------*/
+
+EventSource *
+vexSpiGetFrameEventSource()
+{
+    return( &spiFrameEvent );
 }
 
 /*-----------------------------------------------------------------------------*/
@@ -158,6 +158,23 @@ typedef struct _SpiData {
     uint32_t    errors;             ///< number of packets received with error
 } SpiData;
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      Controller frame snapshot                                      */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  A copy of the controller data from one valid SPI exchange.  The snapshot
+ *  is replaced as a whole after each exchange, readers take a copy with
+ *  vexSpiGetFrame so they never see data from two different frames.
+ */
+typedef struct _vexSpiFrame {
+    uint32_t    sequence;           ///< incremented for every valid exchange
+    systime_t   time;               ///< system time the frame was received
+    uint32_t    counter;            ///< cycle counter when the frame was received
+    uint16_t    ctl;                ///< status and control byte
+    jsdata      js_1;               ///< data for main joystick
+    jsdata      js_2;               ///< data for partner joystick
+} vexSpiFrame;
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -170,12 +187,15 @@ void        vexSpiTeamnameSet( char *name );
 void        vexSpiModeStandalone(void);
 short       vexSpiGetOnlineStatus(void);
 void        vexSpiSetMotor( int16_t index, int16_t data, bool_t reversed );
-void        vexSpiSend(void);
+bool_t      vexSpiSend(void);
 void        vexSpiTickDelay( int16_t tick);
 jsdata     *vexSpiGetJoystickDataPtr( int16_t index );
 uint16_t    vexSpiGetControl(void);
 uint16_t    vexSpiGetMainBattery(void);
 uint16_t    vexSpiGetBackupBattery(void);
+void        vexSpiGetFrame( vexSpiFrame *frame );
+uint32_t    vexSpiGetFrameSequence(void);
+EventSource *vexSpiGetFrameEventSource(void);
 
 void        vexSpiDebug(vexStream *chp, int argc, char *argv[]);
 
@@ -0,0 +1,214 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     vextrace.c                                                   */
+/*                                                                             */
+/*    Revisions:                                                               */
+/*                V1.00  Initial release                                       */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    This file is part of ConVEX.                                             */
+/*                                                                             */
+/*    ConVEX is free software; you can redistribute it and/or modify it        */
+/*    under the terms of the GNU General Public License as published by the    */
+/*    Free Software Foundation; either version 3 of the License, or (at your   */
+/*    option) any later version.                                               */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#include <string.h>
+
+#include "ch.h"         // needs for all ChibiOS programs
+#include "hal.h"        // hardware abstraction layer header
+#include "vex.h"        // vex library header
+
+/*-----------------------------------------------------------------------------*/
+/** @file    vextrace.c
+  * @brief   Input to output latency trace points
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *  A trace point records the time since the most recent controller frame
+ *  was received from the master processor.  Timestamps come from the free
+ *  running cycle counter so no timer or interrupt is needed.
+ *
+ *  Each stage has its own ring and is normally written by one thread or
+ *  interrupt only, so no locking is used.  The frame origin is published
+ *  with an odd/even sequence, a trace point that sees it change simply
+ *  skips the sample rather than waiting.  A second writer on a stage can
+ *  at worst lose or duplicate a sample.
+ */
+
+/*-----------------------------------------------------------------------------*/
+/*  Storage for the trace data                                                 */
+/*-----------------------------------------------------------------------------*/
+static  volatile uint32_t   traceSequence = 0;
+static  volatile uint32_t   traceOrigin = 0;
+static  vexTraceRing        traceRings[kVexTraceNum];
+
+static  const char         *traceNames[kVexTraceNum] = {
+    "control", "setmotor", "motor", "pwm", "spi"
+    };
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Start a new trace at the time a controller frame arrived       */
+/** @param[in]  counter The cycle counter when the frame was received          */
+/** @note       Called by the system task after each valid SPI exchange       */
+/*-----------------------------------------------------------------------------*/
+
+void
+vexTraceFrame( uint32_t counter )
+{
+    // odd while the origin is being changed
+    traceSequence++;
+    traceOrigin = counter;
+    traceSequence++;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Record that a stage was reached for the current frame          */
+/** @param[in]  stage The trace stage                                          */
+/** @note       May be called from an interrupt handler                        */
+/*-----------------------------------------------------------------------------*/
+
+void
+vexTracePoint( tVexTraceStage stage )
+{
+    vexTraceRing *ring;
+    uint32_t      sequence;
+    uint32_t      origin;
+    uint32_t      latency;
+
+    if( (stage < kVexTraceControl) || (stage >= kVexTraceNum) )
+        return;
+
+    ring = &traceRings[ stage ];
+
+    // no frame yet or the origin is changing
+    sequence = traceSequence;
+    if( (sequence == 0) || ((sequence & 1) != 0) )
+        return;
+
+    // already recorded this stage for the frame
+    if( ring->sequence == sequence )
+        return;
+
+    origin = traceOrigin;
+    if( sequence != traceSequence )
+        return;
+
+    latency = (halGetCounterValue() - origin) / (halGetCounterFrequency() / 1000000);
+    if( latency > 0xFFFF )
+        latency = 0xFFFF;
+
+    ring->sequence = sequence;
+    ring->latency[ ring->head & (VEX_TRACE_DEPTH - 1) ] = (uint16_t)latency;
+    ring->head++;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Clear all trace samples                                        */
+/*-----------------------------------------------------------------------------*/
+
+void
+vexTraceReset()
+{
+    int16_t i;
+
+    for(i=0;i<kVexTraceNum;i++)
+        {
+        traceRings[i].head = 0;
+        traceRings[i].sequence = 0;
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Calculate latency percentiles for a stage                      */
+/** @param[in]  stage The trace stage                                          */
+/** @param[out] stats pointer to the vexTraceStats to fill                     */
+/** @returns    FALSE if the stage is not valid                                */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Works on a copy of the most recent VEX_TRACE_DEPTH samples, an insertion
+ *  sort is fine for this many samples and needs no extra storage.
+ */
+
+bool_t
+vexTraceGetStats( tVexTraceStage stage, vexTraceStats *stats )
+{
+    uint16_t  sorted[VEX_TRACE_DEPTH];
+    uint16_t  value;
+    uint32_t  n;
+    int16_t   i, j;
+
+    if( (stage < kVexTraceControl) || (stage >= kVexTraceNum) )
+        return( FALSE );
+
+    memcpy( sorted, traceRings[ stage ].latency, sizeof(sorted) );
+    stats->count = traceRings[ stage ].head;
+    n = (stats->count < VEX_TRACE_DEPTH) ? stats->count : VEX_TRACE_DEPTH;
+    stats->samples = (uint16_t)n;
+
+    if( n == 0 )
+        {
+        stats->p50 = stats->p90 = stats->p99 = stats->max = 0;
+        return( TRUE );
+        }
+
+    for(i=1;i<(int16_t)n;i++)
+        {
+        value = sorted[i];
+        for(j=i;(j>0) && (sorted[j-1] > value);j--)
+            sorted[j] = sorted[j-1];
+        sorted[j] = value;
+        }
+
+    stats->p50 = sorted[ ((n - 1) * 50) / 100 ];
+    stats->p90 = sorted[ ((n - 1) * 90) / 100 ];
+    stats->p99 = sorted[ ((n - 1) * 99) / 100 ];
+    stats->max = sorted[ n - 1 ];
+
+    return( TRUE );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the name of a trace stage                                  */
+/** @param[in]  stage The trace stage                                          */
+/** @returns    pointer to the name                                            */
+/*-----------------------------------------------------------------------------*/
+
+const char *
+vexTraceGetName( tVexTraceStage stage )
+{
+    if( (stage < kVexTraceControl) || (stage >= kVexTraceNum) )
+        return( "unknown" );
+
+    return( traceNames[ stage ] );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Dump trace latency percentiles for debug                       */
+/** @param[in]  chp     A pointer to a vexStream object                        */
+/** @param[in]  argc    The number of command line arguments                   */
+/** @param[in]  argv    An array of pointers to the command line args          */
+/*-----------------------------------------------------------------------------*/
+
+void
+vexTraceDebug(vexStream *chp, int argc, char *argv[])
+{
+    vexTraceStats stats;
+    int16_t i;
+
+    if( (argc == 1) && (strcmp( argv[0], "reset" ) == 0) )
+        {
+        vexTraceReset();
+        return;
+        }
+
+    vex_chprintf(chp, "stage       count   p50   p90   p99   max (uS)\r\n");
+    for(i=0;i<kVexTraceNum;i++)
+        {
+        vexTraceGetStats( (tVexTraceStage)i, &stats );
+        vex_chprintf(chp, "%-8s %8lu %5d %5d %5d %5d\r\n", vexTraceGetName( (tVexTraceStage)i ),
+                     stats.count, stats.p50, stats.p90, stats.p99, stats.max );
+        }
+}
@@ -0,0 +1,86 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     vextrace.h                                                   */
+/*                                                                             */
+/*    Revisions:                                                               */
+/*                V1.00  Initial release                                       */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    This file is part of ConVEX.                                             */
+/*                                                                             */
+/*    ConVEX is free software; you can redistribute it and/or modify it        */
+/*    under the terms of the GNU General Public License as published by the    */
+/*    Free Software Foundation; either version 3 of the License, or (at your   */
+/*    option) any later version.                                               */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#ifndef __VEXTRACE__
+#define __VEXTRACE__
+
+/*-----------------------------------------------------------------------------*/
+/** @file    vextrace.h
+  * @brief   Input to output latency trace points, macros and prototypes
+*//*---------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Number of samples kept for each stage, must be a power of 2    */
+/*-----------------------------------------------------------------------------*/
+#define VEX_TRACE_DEPTH     64
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      The trace stages in the order a controller frame reaches them  */
+/*-----------------------------------------------------------------------------*/
+typedef enum {
+    kVexTraceControl = 0,           ///< control loop has read the frame
+    kVexTraceSetMotor,              ///< SetMotor called by a control loop
+    kVexTraceMotor,                 ///< slew task changed a motor value
+    kVexTracePwm,                   ///< new value loaded into the pwm timer
+    kVexTraceSpi,                   ///< motor values sent to the master cpu
+
+    kVexTraceNum
+} tVexTraceStage;
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Samples for one stage                                          */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Each sample is the time in uS from the controller frame being received
+ *  to the stage being reached, only the first time a stage is reached for
+ *  a frame is recorded.
+ */
+typedef struct _vexTraceRing {
+    uint32_t    head;                       ///< total number of samples
+    uint32_t    sequence;                   ///< trace sequence of the last sample
+    uint16_t    latency[VEX_TRACE_DEPTH];   ///< samples in uS
+} vexTraceRing;
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Latency statistics for one stage                               */
+/*-----------------------------------------------------------------------------*/
+typedef struct _vexTraceStats {
+    uint32_t    count;              ///< total number of samples
+    uint16_t    samples;            ///< number of samples used for statistics
+    uint16_t    p50;                ///< median latency in uS
+    uint16_t    p90;                ///< 90th percentile latency in uS
+    uint16_t    p99;                ///< 99th percentile latency in uS
+    uint16_t    max;                ///< maximum latency in uS
+} vexTraceStats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void        vexTraceFrame( uint32_t counter );
+void        vexTracePoint( tVexTraceStage stage );
+void        vexTraceReset(void);
+bool_t      vexTraceGetStats( tVexTraceStage stage, vexTraceStats *stats );
+const char *vexTraceGetName( tVexTraceStage stage );
+void        vexTraceDebug(vexStream *chp, int argc, char *argv[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __VEXTRACE__
@@ -0,0 +1,167 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     fixmath.c                                                    */
+/*                                                                             */
+/*    Revisions:                                                               */
+/*                V1.00  Initial release                                       */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    This file is part of ConVEX.                                             */
+/*                                                                             */
+/*    ConVEX is free software; you can redistribute it and/or modify it        */
+/*    under the terms of the GNU General Public License as published by the    */
+/*    Free Software Foundation; either version 3 of the License, or (at your   */
+/*    option) any later version.                                               */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*-----------------------------------------------------------------------------*/
+/** @file    fixmath.c
+  * @brief   Q16 fixed point multiply, exp, log and sqrt for the FPU-less cortex
+  * @details
+  * Inline functions included by the libraries that need them, the same as
+  * fastmath.c.  Values are signed Q16, 1.0 is 65536.  exp and log use 33
+  * entry tables with linear interpolation, both are good to about 1e-4
+  * which is well inside the accuracy of the motor model.
+*//*---------------------------------------------------------------------------*/
+
+#define FIX_ONE         65536
+#define FIX_LN2         45426
+#define FIX_LOG2E       94548
+
+// constant conversions, only use FIX with constants or at init
+#define FIX( f )        ((int32_t)((f) * 65536.0))
+#define FIX2F( x )      ((float)(x) * (1.0f / 65536.0f))
+
+// 2^(-i/32) for i = 0 to 32
+static const int32_t fixExpTable[33] = {
+     65536,  64132,  62757,  61413,  60097,  58809,  57549,  56316,
+     55109,  53928,  52773,  51642,  50535,  49452,  48393,  47356,
+     46341,  45348,  44376,  43425,  42495,  41584,  40693,  39821,
+     38968,  38133,  37316,  36516,  35734,  34968,  34219,  33486,
+     32768
+    };
+
+// ln(1 + i/32) for i = 0 to 32
+static const int32_t fixLogTable[33] = {
+         0,   2017,   3973,   5873,   7719,   9515,  11262,  12965,
+     14624,  16242,  17821,  19364,  20870,  22343,  23783,  25193,
+     26573,  27924,  29248,  30546,  31818,  33067,  34292,  35494,
+     36675,  37835,  38975,  40095,  41196,  42280,  43345,  44394,
+     45426
+    };
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Multiply two Q16 values                                        */
+/*-----------------------------------------------------------------------------*/
+
+static inline int32_t
+fixmul( int32_t a, int32_t b )
+{
+    return( (int32_t)(((int64_t)a * b) >> 16) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Divide two Q16 values, b must not be 0                         */
+/*-----------------------------------------------------------------------------*/
+
+static inline int32_t
+fixdiv( int32_t a, int32_t b )
+{
+    return( (int32_t)(((int64_t)a << 16) / b) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      e to the power of a Q16 value, for values of 0 or less         */
+/*-----------------------------------------------------------------------------*/
+
+static inline int32_t
+fixexp( int32_t x )
+{
+    uint32_t    y;
+    uint32_t    n;
+    uint32_t    i;
+    uint32_t    f;
+    int32_t     r;
+
+    if( x >= 0 )
+        return( FIX_ONE );
+
+    // e^x = 2^-y
+    y = (uint32_t)(((int64_t)(-x) * FIX_LOG2E) >> 16);
+    n = y >> 16;
+    if( n >= 16 )
+        return( 0 );
+
+    i = (y >> 11) & 0x1F;
+    f = y & 0x7FF;
+    r = fixExpTable[i] - (((fixExpTable[i] - fixExpTable[i+1]) * (int32_t)f) >> 11);
+
+    return( r >> n );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      natural log of a Q16 value, x must be more than 0              */
+/*-----------------------------------------------------------------------------*/
+
+static inline int32_t
+fixlog( int32_t x )
+{
+    int32_t     e;
+    uint32_t    i;
+    uint32_t    f;
+    int32_t     r;
+
+    if( x <= 0 )
+        return( INT32_MIN );
+
+    // normalize to 1.0 <= x < 2.0
+    e = (31 - __builtin_clz( (uint32_t)x )) - 16;
+    if( e > 0 )
+        x >>= e;
+    else
+        x <<= -e;
+
+    i = ((uint32_t)x >> 11) & 0x1F;
+    f = (uint32_t)x & 0x7FF;
+    r = fixLogTable[i] + (((fixLogTable[i+1] - fixLogTable[i]) * (int32_t)f) >> 11);
+
+    return( r + e * FIX_LN2 );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      square root of a Q16 value, 0 for values of 0 or less          */
+/*-----------------------------------------------------------------------------*/
+
+static inline int32_t
+fixsqrt( int32_t x )
+{
+    uint64_t    v;
+    uint64_t    r = 0;
+    uint64_t    b = (uint64_t)1 << 46;
+
+    if( x <= 0 )
+        return( 0 );
+
+    // integer root of x * 65536, one result bit per pass
+    v = (uint64_t)x << 16;
+    while( b > v )
+        b >>= 2;
+
+    while( b != 0 )
+        {
+        if( v >= r + b )
+            {
+            v -= r + b;
+            r  = (r >> 1) + b;
+            }
+        else
+            r >>= 1;
+        b >>= 2;
+        }
+
+    return( (int32_t)r );
+}
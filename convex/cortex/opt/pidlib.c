@@ -12,6 +12,8 @@
 /*                                                                             */
 /*    Revisions:                                                               */
 /*                V1.00     4 July 2013 - Initial release for ChibiOS          */
+/*                V1.03     Fixed point controllers and controller banks       */
+/*                          Relay feedback autotuning                          */
 /*                                                                             */
 /*-----------------------------------------------------------------------------*/
 /*                                                                             */
@@ -234,6 +236,384 @@ PidControllerUpdate( pidController *p )
 }
 
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      Initialize a fixed point PID controller                        */
+/** @param[in]  p pointer to the controller storage                            */
+/** @param[in]  Kp proportional constant, 16.16                                */
+/** @param[in]  Ki integral constant, 16.16                                    */
+/** @param[in]  Kd derivative constant, 16.16                                  */
+/** @param[in]  sensor_index index of the sensor value in the snapshot         */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Kbias, the feed forward constants, the filter time constant and the
+ *  thresholds may be changed in the structure after this is called.
+ */
+
+void
+PidFixedControllerInit( pidFixedController *p, int32_t Kp, int32_t Ki, int32_t Kd, int16_t sensor_index )
+{
+    if( p == NULL )
+        return;
+
+    // pid constants
+    p->Kp    = Kp;
+    p->Ki    = Ki;
+    p->Kd    = Kd;
+    p->Kbias = 0;
+    p->Kv    = 0;
+    p->Ka    = 0;
+
+    p->error_threshold = 10;
+    p->integral_limit  = PIDLIB_FIX_INTEGRAL_MAX;
+    p->derivative_tau  = 0;
+
+    p->sensor_index    = sensor_index;
+    p->target_value    = 0;
+    p->target_velocity = 0;
+    p->target_accel    = 0;
+
+    PidFixedControllerReset( p );
+
+    p->enabled = 1;
+
+    PidControllerMakeLut();
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Clear the working variables of a fixed point PID controller    */
+/** @param[in]  p pointer to the controller                                    */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The next update does not use the rate of the sensor, call this when the
+ *  controller is enabled again or the sensor has been reset.
+ */
+
+void
+PidFixedControllerReset( pidFixedController *p )
+{
+    if( p == NULL )
+        return;
+
+    p->error        = 0;
+    p->integral     = 0;
+    p->derivative   = 0;
+    p->drive        = 0;
+    p->drive_raw    = 0;
+    p->drive_cmd    = 0;
+    p->sensor_value = 0;
+    p->last_sensor  = 0;
+    // no previous sensor value yet
+    p->first    = 1;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Update a fixed point PID controller                            */
+/** @param[in]  p pointer to the controller                                    */
+/** @param[in]  sensor_value the position of the sensor                        */
+/** @param[in]  dt time since the last update in mS                            */
+/** @returns    The linearized motor drive                                     */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The derivative is taken from the sensor rather than the error, so a step
+ *  in the target does not kick the output, and is low pass filtered with
+ *  the time constant derivative_tau.  The integral only accumulates while
+ *  the output is not saturated in the direction of the error.  The target
+ *  velocity and acceleration are fed forward through Kv and Ka.
+ *
+ *  Only integer arithmetic is used, the products are 64 bit.
+ */
+
+int16_t
+PidFixedControllerUpdate( pidFixedController *p, int32_t sensor_value, int32_t dt )
+{
+    int32_t     rate;
+    int32_t     delta;
+    int32_t     step;
+    int64_t     drive;
+
+    if( p == NULL )
+        return(0);
+
+    if( !p->enabled )
+        {
+        // Disabled - all 0
+        PidFixedControllerReset( p );
+        return(0);
+        }
+
+    p->sensor_value = sensor_value;
+    p->error = p->target_value - sensor_value;
+
+    // force error to 0 if below threshold
+    if( abs(p->error) < p->error_threshold )
+        p->error = 0;
+
+    // derivative on measurement, filtered, the divides are all 32 bit
+    if( p->first || (dt <= 0) )
+        rate = p->derivative;
+    else
+        {
+        delta = (sensor_value - p->last_sensor) * 1000;
+        rate  = delta / dt;
+        if( abs(rate) > 32767 )
+            rate = (rate > 0) ? PIDLIB_FIX( 32767 ) : PIDLIB_FIX( -32767 );
+        else
+            rate = (rate * 65536) + (((delta % dt) * 65536) / dt);
+        }
+
+    if( p->first )
+        p->derivative = 0;
+    else
+    if( (p->derivative_tau > 0) && (dt > 0) )
+        p->derivative += (int32_t)(((int64_t)(rate - p->derivative) * ((dt * 65536) / (p->derivative_tau + dt))) >> 16);
+    else
+        p->derivative = rate;
+
+    p->last_sensor = sensor_value;
+    p->first   = 0;
+
+    // everything but the integral
+    drive = (int64_t)p->Kp * p->error
+          - (((int64_t)p->Kd * p->derivative) >> 16)
+          + (int64_t)p->Kv * p->target_velocity
+          + (int64_t)p->Ka * p->target_accel
+          + p->Kbias;
+
+    // integral accumulation, skipped when it would only wind up further
+    if( (p->Ki != 0) && (dt > 0) )
+        {
+        // Ki * error * dt / 1000, 67109 / 2^26 is 1 / 1000
+        step = (int32_t)(((int64_t)p->Ki * p->error * dt * 67109) >> 26);
+
+        if( !((drive + p->integral >= PIDLIB_FIX( 127 )) && (step > 0)) &&
+            !((drive + p->integral <= PIDLIB_FIX( -127 )) && (step < 0)) )
+            {
+            p->integral += step;
+
+            // limit to avoid windup
+            if( p->integral > p->integral_limit )
+                p->integral = p->integral_limit;
+            else
+            if( p->integral < -p->integral_limit )
+                p->integral = -p->integral_limit;
+            }
+        }
+    else
+    if( p->Ki == 0 )
+        p->integral = 0;
+
+    drive += p->integral;
+
+    // drive should be in the range +/- 127
+    if( drive > PIDLIB_FIX( 127 ) )
+        drive = PIDLIB_FIX( 127 );
+    else
+    if( drive < PIDLIB_FIX( -127 ) )
+        drive = PIDLIB_FIX( -127 );
+
+    p->drive     = (int32_t)drive;
+    p->drive_raw = (p->drive + 0x8000) >> 16;
+
+    // linearize without the float sgn
+    if( p->drive_raw >= 0 )
+        p->drive_cmd = PidDriveLut[ p->drive_raw ];
+    else
+        p->drive_cmd = -PidDriveLut[ -p->drive_raw ];
+
+    return( p->drive_cmd );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Update a bank of fixed point PID controllers                   */
+/** @param[in]  bank pointer to the first controller                           */
+/** @param[in]  count the number of controllers                                */
+/** @param[in]  snapshot the sensor values, indexed by sensor_index            */
+/** @param[in]  dt time since the last update in mS                            */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Every controller sees sensor values taken at the same time, the results
+ *  are left in drive_cmd of each controller.  Controllers with a negative
+ *  sensor_index are updated from their own sensor_value, set by the caller.
+ */
+
+void
+PidFixedBankUpdate( pidFixedController *bank, int16_t count, const int32_t *snapshot, int32_t dt )
+{
+    int16_t     i;
+    pidFixedController *p;
+
+    if( (bank == NULL) || (snapshot == NULL) )
+        return;
+
+    for(i=0,p=bank;i<count;i++,p++)
+        {
+        if( p->sensor_index >= 0 )
+            PidFixedControllerUpdate( p, snapshot[ p->sensor_index ], dt );
+        else
+            PidFixedControllerUpdate( p, p->sensor_value, dt );
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Start a relay feedback autotune                                */
+/** @param[in]  a pointer to the autotune storage                              */
+/** @param[in]  target_value the value to oscillate around                     */
+/** @param[in]  relay the relay amplitude, a motor command                     */
+/** @param[in]  hysteresis the error needed to switch the relay                */
+/** @param[in]  cycles the number of cycles to measure                         */
+/*-----------------------------------------------------------------------------*/
+
+void
+PidAutotuneInit( pidAutotune *a, int32_t target_value, int16_t relay, int16_t hysteresis, int16_t cycles )
+{
+    if( a == NULL )
+        return;
+
+    a->state         = kPidTuneRunning;
+    a->output        = 0;
+    a->relay         = abs(relay);
+    a->hysteresis    = abs(hysteresis);
+    a->cycles        = (cycles > 0) ? cycles : 1;
+    a->measured      = 0;
+    a->switches      = 0;
+    a->target_value  = target_value;
+    a->amplitude_sum = 0;
+    a->period_sum    = 0;
+    a->updates       = 0;
+    a->Ku            = 0.0;
+    a->Pu            = 0.0;
+    a->dt            = 0.0;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Run the relay for one control loop                             */
+/** @param[in]  a pointer to the autotune                                      */
+/** @param[in]  sensor_value the position of the sensor                        */
+/** @param[in]  time the time now in mS                                        */
+/** @returns    The motor command, 0 once the autotune has finished            */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  A cycle runs from one upward switch of the relay to the next, and so
+ *  includes the overshoot after the first switch and the undershoot before
+ *  the second.  Only integers are used until the cycles have been measured.
+ */
+
+int16_t
+PidAutotuneUpdate( pidAutotune *a, int32_t sensor_value, uint32_t time )
+{
+    float   amplitude;
+
+    if( (a == NULL) || (a->state != kPidTuneRunning) )
+        return(0);
+
+    // first update, push toward the target
+    if( a->updates++ == 0 )
+        {
+        a->start_time = time;
+        a->peak_max   = sensor_value;
+        a->peak_min   = sensor_value;
+        a->output     = (sensor_value < a->target_value) ? a->relay : -a->relay;
+        }
+    a->last_time = time;
+
+    if( (time - a->start_time) > PIDLIB_TUNE_TIMEOUT )
+        {
+        a->state  = kPidTuneFailed;
+        a->output = 0;
+        return(0);
+        }
+
+    if( sensor_value > a->peak_max )
+        a->peak_max = sensor_value;
+    if( sensor_value < a->peak_min )
+        a->peak_min = sensor_value;
+
+    if( (a->output > 0) && (sensor_value > a->target_value + a->hysteresis) )
+        {
+        // upward switch, the end of a cycle
+        a->output = -a->relay;
+
+        // the first cycle is still settling
+        if( a->switches >= 2 )
+            {
+            a->amplitude_sum += a->peak_max - a->peak_min;
+            a->period_sum    += time - a->last_switch;
+            a->measured++;
+            }
+        a->switches++;
+        a->last_switch = time;
+        a->peak_max    = sensor_value;
+        a->peak_min    = sensor_value;
+        }
+    else
+    if( (a->output < 0) && (sensor_value < a->target_value - a->hysteresis) )
+        a->output = a->relay;
+
+    if( a->measured < a->cycles )
+        return( a->output );
+
+    // amplitude is half the mean peak to peak
+    amplitude = (float)a->amplitude_sum / (2.0 * a->measured);
+    if( amplitude <= a->hysteresis )
+        {
+        a->state = kPidTuneFailed;
+        }
+    else
+        {
+        a->Ku    = (4.0 * a->relay) / (3.14159265 * sqrtf( amplitude * amplitude - a->hysteresis * a->hysteresis ));
+        a->Pu    = (float)a->period_sum / (1000.0 * a->measured);
+        a->dt    = (float)(a->last_time - a->start_time) / (1000.0 * (a->updates - 1));
+        a->state = kPidTuneDone;
+        }
+
+    a->output = 0;
+    return(0);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Set the gains of a PID controller from a finished autotune     */
+/** @param[in]  a pointer to the autotune                                      */
+/** @param[in]  rule the tuning rule                                           */
+/** @param[in]  p pointer to the PID controller                                */
+/** @returns    TRUE if the gains were set                                     */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  PidControllerUpdate has no delta T, so the integral and derivative
+ *  gains are scaled by the mean loop time seen during the autotune and the
+ *  controller should be updated at the same rate.  Its drive is +/- 1.0
+ *  rather than a motor command.
+ */
+
+bool_t
+PidAutotuneApply( pidAutotune *a, tPidTuneRule rule, pidController *p )
+{
+    // Kp as a fraction of Ku, Ti and Td as a fraction of Pu
+    static const float rules[ kPidTuneRuleNum ][3] = {
+        { 0.6,       0.5, 0.125     },      // Ziegler-Nichols
+        { 1.0 / 2.2, 2.2, 1.0 / 6.3 }       // Tyreus-Luyben
+        };
+    float   Kp;
+
+    if( (a == NULL) || (p == NULL) || (a->state != kPidTuneDone) || (a->dt <= 0.0) )
+        return(FALSE);
+    if( (rule < 0) || (rule >= kPidTuneRuleNum) )
+        return(FALSE);
+
+    Kp = rules[ rule ][0] * a->Ku / 127.0;
+
+    p->Kp = Kp;
+    p->Ki = Kp * a->dt / (rules[ rule ][1] * a->Pu);
+    p->Kd = Kp * (rules[ rule ][2] * a->Pu) / a->dt;
+
+    p->integral = 0;
+    if( p->Ki != 0 )
+        p->integral_limit = (PIDLIB_INTEGRAL_DRIVE_MAX / p->Ki);
+    else
+        p->integral_limit = 0;
+
+    return(TRUE);
+}
+
 /*-----------------------------------------------------------------------------*/
 /** @brief      Create a power based lut                                       */
 /*-----------------------------------------------------------------------------*/
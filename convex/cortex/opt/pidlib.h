@@ -12,6 +12,8 @@
 /*                                                                             */
 /*    Revisions:                                                               */
 /*                V1.00     4 July 2013 - Initial release                      */
+/*                V1.03     Fixed point controllers and controller banks       */
+/*                          Relay feedback autotuning                          */
 /*                                                                             */
 /*-----------------------------------------------------------------------------*/
 /*                                                                             */
@@ -51,9 +53,9 @@
   * @brief   A port of the ROBOTC pidlib library, macros and prototypes
 *//*---------------------------------------------------------------------------*/
 
-/** @brief Current pidlib Version is 1.02
+/** @brief Current pidlib Version is 1.03
  */
-#define kPidLibVersion          102
+#define kPidLibVersion          103
 
 /** @brief Use heap for pid controller data rather than static data
  */
@@ -98,9 +100,10 @@ typedef struct _pidController {
 
 
 /*-----------------------------------------------------------------------------*/
-/** @brief Allow 4 pid controllers                                             */
+/** @brief Allow 8 pid controllers                                             */
 /*-----------------------------------------------------------------------------*/
-#define MAX_PID                     4
+// the robot uses 2, arm and lift, the drive loops are fixed point
+#define MAX_PID                     8
 
 // lookup table to linearize control
 
@@ -119,6 +122,126 @@ typedef struct _pidController {
  */
 #define PIDLIB_INTEGRAL_DRIVE_MAX   0.25
 
+/*-----------------------------------------------------------------------------*/
+/** @brief Structure to hold all data for one fixed point PID controller       */
+/*-----------------------------------------------------------------------------*/
+/** @note
+ *  Gains and the drive are 16.16 fixed point in motor command units, so
+ *  Kp is command per count, Ki command per count second and Kd command per
+ *  count per second.  Sensor values, targets and errors are whole counts.
+ *
+ *  The controller does not read the sensor, a bank of them is updated from a
+ *  snapshot of sensor values taken once per loop, sensor_index picks the
+ *  value for this controller.  They are kept in the caller's storage so a
+ *  bank is just an array of them.
+ *
+ *  Currently at 84 bytes memory usage
+ */
+typedef struct _pidFixedController {
+    // Turn on or off the control loop
+    int16_t      enabled;        ///< enable or diable pid calculations
+    int16_t      sensor_index;   ///< index of the sensor value in the snapshot
+
+    // PID constants
+    int32_t      Kp;             ///< proportional constant
+    int32_t      Ki;             ///< integral constant
+    int32_t      Kd;             ///< derivative constant
+    int32_t      Kbias;          ///< bias, a command
+    int32_t      Kv;             ///< feed forward of the target velocity
+    int32_t      Ka;             ///< feed forward of the target acceleration
+
+    // working variables
+    int32_t      error;          ///< error between actual position and target
+    int32_t      error_threshold;///< threshold below which error is ignored
+    int32_t      integral;       ///< integral term, a command
+    int32_t      integral_limit; ///< limit for the integral term
+    int32_t      derivative;     ///< filtered rate of the sensor in counts/s
+    int32_t      derivative_tau; ///< time constant of the rate filter in mS
+
+    // output
+    int32_t      drive;          ///< calculated motor drive in range +/- 127
+    int16_t      drive_raw;      ///< motor drive in the range +/- 127
+    int16_t      drive_cmd;      ///< linearized motor drive in the range +/- 127
+    int16_t      first;          ///< no previous sensor value to take a rate from
+    int16_t      res1;           ///< word alignment of sensor_value
+
+    int32_t      sensor_value;   ///< current value of the position sensor
+    int32_t      last_sensor;    ///< value of the sensor last time
+    int32_t      target_value;   ///< the target value
+    int32_t      target_velocity;///< the target velocity in counts/s
+    int32_t      target_accel;   ///< the target acceleration in counts/s/s
+    } pidFixedController;
+
+/** @brief Convert a constant to 16.16 fixed point for a pidFixedController
+ */
+#define PIDLIB_FIX( x )          ((int32_t)((x) * 65536.0))
+
+/** @brief The integral term is never more than this command, as for the
+ *  float controller
+ */
+#define PIDLIB_FIX_INTEGRAL_MAX  PIDLIB_FIX( PIDLIB_INTEGRAL_DRIVE_MAX * 127 )
+
+/*-----------------------------------------------------------------------------*/
+/** @brief Relay feedback autotuning                                           */
+/*-----------------------------------------------------------------------------*/
+/** @note
+ *  The relay drives the mechanism with +/- relay around the target, which
+ *  makes it oscillate at its ultimate period.  From the amplitude of the
+ *  oscillation the ultimate gain is 4 * relay / (pi * amplitude), with the
+ *  hysteresis taken out of the amplitude.  The first cycle is not used as
+ *  the mechanism is still moving to the target.
+ */
+
+/** @brief Give up if the oscillation has not settled after this many mS
+ */
+#define PIDLIB_TUNE_TIMEOUT     20000
+
+/** @brief States of an autotune
+ */
+typedef enum {
+    kPidTuneIdle = 0,           ///< not started
+    kPidTuneRunning,            ///< relay is running
+    kPidTuneDone,               ///< ultimate gain and period are known
+    kPidTuneFailed              ///< timed out or no oscillation
+    } tPidTuneState;
+
+/** @brief Rules that turn the ultimate gain and period into PID gains
+ */
+typedef enum {
+    kPidTuneZieglerNichols = 0, ///< fast, about a quarter decay
+    kPidTuneTyreusLuyben,       ///< less overshoot, slower integral
+    kPidTuneRuleNum
+    } tPidTuneRule;
+
+/** @brief Structure to hold the working data of one autotune
+ */
+typedef struct _pidAutotune {
+    int16_t      state;          ///< a tPidTuneState
+    int16_t      output;         ///< current relay output
+    int16_t      relay;          ///< relay amplitude, a motor command
+    int16_t      hysteresis;     ///< error needed to switch the relay
+    int16_t      cycles;         ///< number of cycles to measure
+    int16_t      measured;       ///< cycles measured so far
+    int16_t      switches;       ///< upward switches of the relay
+    int16_t      res1;           ///< word alignment
+
+    int32_t      target_value;   ///< the value the relay switches around
+    int32_t      peak_max;       ///< highest sensor value this cycle
+    int32_t      peak_min;       ///< lowest sensor value this cycle
+    int32_t      amplitude_sum;  ///< sum of peak to peak of measured cycles
+    uint32_t     period_sum;     ///< sum of the measured periods in mS
+
+    uint32_t     start_time;     ///< time of the first update in mS
+    uint32_t     last_switch;    ///< time of the last upward switch in mS
+    uint32_t     last_time;      ///< time of the last update in mS
+    uint32_t     updates;        ///< number of updates
+
+    // results
+    float        Ku;             ///< ultimate gain, motor command per count
+    float        Pu;             ///< ultimate period in seconds
+    float        dt;             ///< mean time between updates in seconds
+    } pidAutotune;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -128,6 +251,15 @@ pidController *PidControllerInitWithBias( float Kp, float Ki, float Kd, float Kb
 int16_t        PidControllerUpdate( pidController *p );
 void           PidControllerMakeLut(void);
 
+void           PidFixedControllerInit( pidFixedController *p, int32_t Kp, int32_t Ki, int32_t Kd, int16_t sensor_index );
+void           PidFixedControllerReset( pidFixedController *p );
+int16_t        PidFixedControllerUpdate( pidFixedController *p, int32_t sensor_value, int32_t dt );
+void           PidFixedBankUpdate( pidFixedController *bank, int16_t count, const int32_t *snapshot, int32_t dt );
+
+void           PidAutotuneInit( pidAutotune *a, int32_t target_value, int16_t relay, int16_t hysteresis, int16_t cycles );
+int16_t        PidAutotuneUpdate( pidAutotune *a, int32_t sensor_value, uint32_t time );
+bool_t         PidAutotuneApply( pidAutotune *a, tPidTuneRule rule, pidController *p );
+
 #ifdef __cplusplus
 }
 #endif
@@ -99,21 +99,33 @@
 /*       156 for controller data                                               */
 /*         8 misc                                                              */
 /*                                                                             */
+/*    The telemetry history adds about 7KB, 6240 bytes of 200mS and 1 second   */
+/*    buckets and 832 bytes of match totals.                                   */
+/*                                                                             */
 /*    CPU time for SmartMotorTask                                              */
 /*    Motor calculations ~ 530uS,  approx 5% cpu bandwidth                     */
 /*    Controller calculations with LED status ~ 1.25mS                         */
 /*    Worse case is therefore about 1.8mS which occurs every 100mS             */
 /*                                                                             */
+/*    Those figures are for the float model updating one motor each 10mS,      */
+/*    SmartMotorDebugStatus reports the measured time for the mode in use.     */
+/*                                                                             */
 /*    CPU time for SmartMotorSlewRateTask                                      */
 /*    approx 400uS per 15mS loop, about 3% cpu bandwidth                       */
+/*    The task now only runs while a motor is ramping, every 5mS, and is       */
+/*    otherwise idle until a new command or limit wakes it.                    */
 /*                                                                             */
 /*-----------------------------------------------------------------------------*/
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "smartmotor.h"
 #include "robotc_glue.h"
 #include "fastmath.c"
+#if SMLIB_FIXED_POINT
+#include "fixmath.c"
+#endif
 
 /*-----------------------------------------------------------------------------*/
 /** @file    smartmotor.c
@@ -136,6 +148,77 @@ static short    PtcLimitEnabled = FALSE;
 // based on preset threshold - defaults to on
 static short    CurrentLimitEnabled = FALSE;
 
+// flag to enable derating before the PTC temperature limit is reached,
+// only used when the PTC limit is enabled
+static short    PtcPredictEnabled = TRUE;
+
+// flag to select updating all motors each time the monitor task runs
+// rather than one motor each time
+static short    MonitorAllEnabled = SMLIB_MONITOR_ALL;
+
+// motors that are configured, the only ones visited when all are updated
+static smartMotor *sActive[ kVexMotorNum ];
+static short       sActiveNum = 0;
+
+#if SMLIB_FIXED_POINT
+typedef int32_t smartVolts;     // 16.16 volts
+#else
+typedef float   smartVolts;
+#endif
+
+// cpu time used by the monitor task in each mode
+typedef struct {
+    uint32_t    runs;           // task iterations
+    uint32_t    motors;         // motor updates
+    uint32_t    last;           // uS used by the last iteration
+    uint32_t    worst;          // worst uS used by an iteration
+    uint32_t    busy;           // total uS used
+    uint32_t    elapsed;        // total mS spent in this mode
+    uint32_t    overruns;       // deadlines already passed
+    } smartBudget;
+
+static smartBudget sBudget[2];
+
+// telemetry history, one bucket holds one value of one source
+typedef struct {
+    int16_t     min;
+    int16_t     max;
+    int32_t     sum;
+    } smartHistoryBucket;
+
+typedef struct {
+    int16_t     min;
+    int16_t     max;
+    int64_t     sum;
+    } smartHistoryTotal;
+
+// buckets are rings, the bucket at the head is the one being filled
+static smartHistoryBucket sHistoryFast[ SMLIB_HISTORY_FAST_NUM ][ SMLIB_HISTORY_SOURCES ][ kSmartHistoryNum ];
+static smartHistoryBucket sHistorySlow[ SMLIB_HISTORY_SLOW_NUM ][ SMLIB_HISTORY_SOURCES ][ kSmartHistoryNum ];
+static smartHistoryTotal  sHistoryMatch[ SMLIB_HISTORY_SOURCES ][ kSmartHistoryNum ];
+
+// every source is sampled together so the sample counts are shared
+static uint16_t  sHistoryFastCount[ SMLIB_HISTORY_FAST_NUM ];
+static uint16_t  sHistorySlowCount[ SMLIB_HISTORY_SLOW_NUM ];
+static uint32_t  sHistoryMatchCount = 0;
+static short     sHistoryFastHead = 0;
+static short     sHistorySlowHead = 0;
+static systime_t sHistoryFastTime = 0;
+
+// the slew rate task, woken when a motor needs to ramp
+static Thread   *sSlewThread = NULL;
+
+#if SMLIB_FIXED_POINT
+static void     SmartMotorFixedSync( void );
+#endif
+static void     SmartMotorActiveBuild( void );
+static void     SmartMotorPredictSync( void );
+static void     SmartMotorHistoryStart( void );
+static void     SmartMotorHistoryUpdate( void );
+static short    SmartMotorSlewRequest( smartMotor *m );
+static short    SmartMotorControllerLimiting( smartController *s );
+static void     SmartMotorSlewCheck( void );
+
 static inline float
 sgn(float x)
 {
@@ -276,6 +359,10 @@ _SmartMotorSetLimitCurent( tVexMotor index, float current, ... )
         return;
 
     sMotors[ index ].limit_current = current;
+
+#if SMLIB_FIXED_POINT
+    SmartMotorFixedSync();
+#endif
 }
 
 /*-----------------------------------------------------------------------------*/
@@ -301,6 +388,10 @@ SmartMotorSetFreeRpm( tVexMotor index, short max_rpm )
 
     // recalculate maximum theoretical v_bemf
     m->v_bemf_max = m->ke_motor * m->rpm_free;
+
+#if SMLIB_FIXED_POINT
+    SmartMotorFixedSync();
+#endif
 }
 
 /*-----------------------------------------------------------------------------*/
@@ -355,6 +446,69 @@ SmartMotorGetControllerTemperature( short index )
     return( sPorts[ index ].temperature );
 }
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get predicted time until the motor PTC trips                   */
+/** @param[in]  index The motor index                                          */
+/** @returns    mS until the PTC trips at the present current                  */
+/*-----------------------------------------------------------------------------*/
+
+long
+SmartMotorGetTripTime( tVexMotor index )
+{
+    // bounds check index
+    if((index < 0) || (index >= kVexMotorNum))
+        return( SMLIB_TRIP_NEVER );
+
+    if( sMotors[ index ].type == kVexMotorUndefined )
+        return( SMLIB_TRIP_NEVER );
+
+    return( sMotors[ index ].trip_time );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get predicted time until the controller PTC trips              */
+/** @param[in]  index The motor controller index (0, 1 or 2)                   */
+/** @returns    mS until the PTC trips at the present current                  */
+/*-----------------------------------------------------------------------------*/
+
+long
+SmartMotorGetControllerTripTime( short index )
+{
+    // bounds check index
+    if((index < 0) || (index >= SMLIB_TOTAL_NUM_CONTROL_BANKS))
+        return( SMLIB_TRIP_NEVER );
+
+    return( sPorts[ index ].trip_time );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the shortest predicted time until any PTC trips            */
+/** @returns    mS until the first motor or controller PTC trips               */
+/*-----------------------------------------------------------------------------*/
+
+long
+SmartMotorGetTripTimeMin()
+{
+    long    t;
+    long    trip = SMLIB_TRIP_NEVER;
+    short   i;
+
+    for( i=0;i<kVexMotorNum;i++ )
+        {
+        t = SmartMotorGetTripTime( i );
+        if( t < trip )
+            trip = t;
+        }
+    for( i=0;i<SMLIB_TOTAL_NUM_CONTROL_BANKS;i++ )
+        {
+        t = SmartMotorGetControllerTripTime( i );
+        if( t < trip )
+            trip = t;
+        }
+
+    return( trip );
+}
+
 /*-----------------------------------------------------------------------------*/
 /** @brief      Set Controller status LED                                      */
 /** @param[in]  index The motor controller index (0, 1 or 2)                   */
@@ -438,6 +592,46 @@ SmartMotorCurrentMonitorDisable()
     CurrentLimitEnabled = FALSE;
 }
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      Enable derating before the PTC temperature limit               */
+/*-----------------------------------------------------------------------------*/
+
+void
+SmartMotorPtcPredictEnable()
+{
+    PtcPredictEnabled   = TRUE;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Disable derating before the PTC temperature limit              */
+/*-----------------------------------------------------------------------------*/
+
+void
+SmartMotorPtcPredictDisable()
+{
+    PtcPredictEnabled   = FALSE;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Update all motors each period of the monitor task              */
+/*-----------------------------------------------------------------------------*/
+
+void
+SmartMotorMonitorAllEnable()
+{
+    MonitorAllEnabled = TRUE;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Update one motor each period of the monitor task               */
+/*-----------------------------------------------------------------------------*/
+
+void
+SmartMotorMonitorAllDisable()
+{
+    MonitorAllEnabled = FALSE;
+}
+
 /*-----------------------------------------------------------------------------*/
 /** @brief      Start the smart motor monitoring                               */
 /** After initialization the smart motor tasks need to be started              */
@@ -446,6 +640,13 @@ SmartMotorCurrentMonitorDisable()
 void
 SmartMotorRun()
 {
+    SmartMotorPredictSync();
+
+#if SMLIB_FIXED_POINT
+    // pick up any changes made to the model since init
+    SmartMotorFixedSync();
+#endif
+
     // Higher priority than slew rate task
     StartTask( SmartMotorTask , NORMALPRIO + 5 );
     // Higher priority than most user tasks
@@ -463,6 +664,9 @@ SmartMotorStop()
     SmartMotorCurrentMonitorDisable();
 
     StopTask( SmartMotorTask );
+
+    // nothing may signal the slew rate task once it is stopped
+    sSlewThread = NULL;
     StopTask( SmartMotorSlewRateTask );
 }
 
@@ -476,6 +680,7 @@ SmartMotorDebugStatus()
     short   i, j;
     smartMotor      *m;
     smartController *s;
+    smartBudget     *b;
 
     // Cortex ports 1 - 5
 
@@ -491,7 +696,9 @@ SmartMotorDebugStatus()
 
         vex_printf("Current:%5.2f ", s->current);
         vex_printf("Temp:%6.2f ", s->temperature);
-        vex_printf("Status:%2d ", s->ptc_tripped);
+        vex_printf("Status:%2d ", s->ptc_tripped + (s->derating<<2) );
+        if( s->trip_time != SMLIB_TRIP_NEVER )
+            vex_printf("Trip:%5.1f ", s->trip_time / 1000.0);
         vex_printf("\r\n");
 
         for(i=0;i<SMLIB_TOTAL_NUM_BANK_MOTORS;i++)
@@ -502,15 +709,85 @@ SmartMotorDebugStatus()
                 vex_printf("      Motor Port: %d - ", m->port );
                 vex_printf("Current:%5.2f ", m->current);
                 vex_printf("Temp:%6.2f ", m->temperature);
-                vex_printf("Status:%2d ", m->ptc_tripped + (m->limit_tripped<<1) );
+                vex_printf("Status:%2d ", m->ptc_tripped + (m->limit_tripped<<1) + (m->derating<<2) );
+                if( m->trip_time != SMLIB_TRIP_NEVER )
+                    vex_printf("Trip:%5.1f ", m->trip_time / 1000.0);
                 vex_printf("\r\n");
                 }
             }
         vex_printf("\r\n");
         }
+
+    // cpu used by the monitor task in each mode it has run in
+    for(j=0;j<2;j++)
+        {
+        b = &sBudget[j];
+        if( (b->runs == 0) || (b->elapsed == 0) )
+            continue;
+
+        if( j == 0 )
+            vex_printf("Monitor one motor   - Refresh:%4dmS ", kVexMotorNum * SMLIB_MONITOR_PERIOD );
+        else
+            vex_printf("Monitor all motors  - Refresh:%4dmS ", SMLIB_MONITOR_PERIOD );
+
+        vex_printf("Last:%5luuS ", b->last);
+        vex_printf("Worst:%5luuS ", b->worst);
+        vex_printf("Motor:%4luuS ", b->motors ? (b->busy / b->motors) : 0 );
+        // busy uS per elapsed mS is cpu use in tenths of a percent
+        vex_printf("Cpu:%3lu.%lu%% ", (b->busy / b->elapsed) / 10, (b->busy / b->elapsed) % 10);
+        vex_printf("Overruns:%lu", b->overruns);
+        vex_printf("\r\n");
+        }
 }
 
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      Set the control value of one motor                             */
+/** @param[in]  index The motor index                                          */
+/** @param[in]  value The motor control value (speed)                          */
+/** @param[in]  immediate If TRUE then bypass the slew rate control            */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Nothing is written when the command is the same as last time, the
+ *  control loops call SetMotor every cycle whether anything changed or not.
+ *  Does not call the kernel so it may be used with the system locked.
+ */
+
+static bool_t
+_SetMotorCommand( int index, int value, bool_t immediate )
+{
+    smartMotor  *m;
+    int16_t      cmd;
+
+    // get motor
+    m = _SmartMotorGetPtr( index );
+
+    // limit value
+    if( value > SMLIB_MOTOR_MAX_CMD )
+        cmd = SMLIB_MOTOR_MAX_CMD;
+    else
+    if( value < SMLIB_MOTOR_MIN_CMD )
+        cmd = SMLIB_MOTOR_MIN_CMD;
+    else
+    if( abs(value) >= SMLIB_MOTOR_DEADBAND )
+        cmd = value;
+    else
+        cmd = 0;
+
+    // nothing changed
+    if( (m->motor_cmd == cmd) && (!immediate || (vexMotorGet( index ) == value)) )
+        return( FALSE );
+
+    // set into motorReq
+    m->motor_cmd = cmd;
+
+    // new - for hard stop
+    if(immediate)
+        vexMotorSet( index,  value);
+
+    return( TRUE );
+}
+
 /*-----------------------------------------------------------------------------*/
 /** @brief      Set motor to value                                             */
 /** @param[in]  index The motor index                                          */
@@ -530,30 +807,54 @@ void
 //SetMotor( int index, int value = 0, bool immediate = FALSE )
 _SetMotor( int index, int value, bool_t immediate, ...  )
 {
-    smartMotor  *m;
-
     // bounds check index
     if((index < 0) || (index >= kVexMotorNum))
         return;
 
-    // get motor
-    m = _SmartMotorGetPtr( index );
+    vexTracePoint( kVexTraceSetMotor );
 
-    // limit value and set into motorReq
-    if( value > SMLIB_MOTOR_MAX_CMD )
-        m->motor_cmd = SMLIB_MOTOR_MAX_CMD;
-    else
-    if( value < SMLIB_MOTOR_MIN_CMD )
-        m->motor_cmd = SMLIB_MOTOR_MIN_CMD;
-    else
-    if( abs(value) >= SMLIB_MOTOR_DEADBAND )
-        m->motor_cmd = value;
-    else
-        m->motor_cmd = 0;
+    // wake the slew rate task if it is waiting for a new command
+    if( _SetMotorCommand( index, value, immediate ) && (sSlewThread != NULL) )
+        chEvtSignal( sSlewThread, SMLIB_SLEW_EVENT );
+}
 
-    // new - for hard stop
-    if(immediate)
-        vexMotorSet( index,  value);
+/*-----------------------------------------------------------------------------*/
+/** @brief      Set several motors at once                                     */
+/** @param[in]  count The number of motors                                     */
+/** @param[in]  index The motor indexes                                        */
+/** @param[in]  value The motor control values (speed)                         */
+/** @param[in]  immediate If TRUE then bypass the slew rate control            */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  All motors are changed with the system locked, so neither the slew rate
+ *  task nor the SPI update can see some of them changed and others not.
+ *  Use this for motors that must move together such as a drive.
+ */
+
+void
+SetMotorGroup( int16_t count, const int16_t *index, const int16_t *value, bool_t immediate )
+{
+    int16_t i;
+    bool_t  changed = FALSE;
+
+    vexTracePoint( kVexTraceSetMotor );
+
+    chSysLock();
+    for(i=0;i<count;i++)
+        {
+        if((index[i] >= 0) && (index[i] < kVexMotorNum))
+            {
+            if( _SetMotorCommand( index[i], value[i], immediate ) )
+                changed = TRUE;
+            }
+        }
+    // one wake up for the whole group
+    if( changed && (sSlewThread != NULL) )
+        {
+        chEvtSignalI( sSlewThread, SMLIB_SLEW_EVENT );
+        chSchRescheduleS();
+        }
+    chSysUnlock();
 }
 
 /*-----------------------------------------------------------------------------*/
@@ -962,6 +1263,16 @@ SmartMotorSpeed( smartMotor *m, int deltaTime )
     m->delta  = m->enc - m->oldenc;
     m->oldenc = m->enc;
 
+#ifndef _Target_Emulator_
+    // quad encoders time their edges, the count difference is very noisy
+    // at low speed with only 360 ticks per rev
+    if( m->encoder_id < 20 )
+        {
+        m->rpm = vexMotorVelocityGet(m->eport) * 60.0 / m->ticks_per_rev;
+        return;
+        }
+#endif
+
     // calculate the rpm for the motor
     m->rpm = (1000.0/deltaTime) * m->delta * 60.0 / m->ticks_per_rev;
 }
@@ -1279,6 +1590,150 @@ SmartMotorControllerTemperature( smartController *s, int deltaTime  )
     return( s->temperature );
 }
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      Calculate the PTC decay over the prediction horizon            */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Called when the tasks are started, t_const_2 does not change after that.
+ */
+
+static void
+SmartMotorPredictSync()
+{
+    int     i;
+    smartMotor      *m;
+    smartController *s;
+
+    for(i=0;i<kVexMotorNum;i++)
+        {
+        m = _SmartMotorGetPtr( i );
+        m->ptc_decay       = exp( -m->t_const_2 * SMLIB_PTC_HORIZON * 1000.0 );
+        m->allowed_current = m->safe_current;
+        m->trip_time       = SMLIB_TRIP_NEVER;
+        m->derating        = FALSE;
+        }
+
+    for(i=0;i<SMLIB_TOTAL_NUM_CONTROL_BANKS;i++)
+        {
+        s = _SmartMotorControllerGetPtr( i );
+        s->ptc_decay       = exp( -s->t_const_2 * SMLIB_PTC_HORIZON * 1000.0 );
+        s->allowed_current = s->safe_current;
+        s->trip_time       = SMLIB_TRIP_NEVER;
+        s->derating        = FALSE;
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Predict when the PTC will trip and the current it can take     */
+/** @param[in]  m pointer to smartMotor structure                              */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The PTC model is first order so at a constant current i the temperature
+ *  heads towards t_final = t_ambient + i * i * t_const_1 as
+ *
+ *  T(t) = t_final + (T(0) - t_final) * exp( -t_const_2 * t )
+ *
+ *  Rather than stepping the model forwards this is solved directly for the
+ *  time at which T reaches SMLIB_TEMP_TRIP, and for the largest current
+ *  that keeps T below SMLIB_TEMP_DERATE at the end of the horizon.  The
+ *  allowed current falls smoothly as the PTC heats up, it is never less
+ *  than safe_current which settles below the trip temperature.
+ */
+
+void
+SmartMotorPredictPtc( smartMotor *m )
+{
+    float   t_final;
+    float   ratio;
+    float   i_squared;
+
+    t_final = m->t_ambient + m->current * m->current * m->t_const_1;
+
+    if( m->temperature >= SMLIB_TEMP_TRIP )
+        m->trip_time = 0;
+    else
+    if( t_final <= SMLIB_TEMP_TRIP )
+        m->trip_time = SMLIB_TRIP_NEVER;
+    else
+        {
+        ratio = (t_final - m->temperature) / (t_final - SMLIB_TEMP_TRIP);
+        // more than about 7 time constants away, call that never
+        if( ratio > 1024 )
+            m->trip_time = SMLIB_TRIP_NEVER;
+        else
+            m->trip_time = log( ratio ) / m->t_const_2;
+        }
+
+    // hottest t_final that is still below SMLIB_TEMP_DERATE after the horizon
+    t_final = (SMLIB_TEMP_DERATE - m->temperature * m->ptc_decay) / (1.0 - m->ptc_decay);
+    i_squared = (t_final - m->t_ambient) / m->t_const_1;
+
+    if( i_squared > (m->safe_current * m->safe_current) )
+        m->allowed_current = sqrt( i_squared );
+    else
+        m->allowed_current = m->safe_current;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Predict when the controller PTC will trip                      */
+/** @param[in]  s pointer to smartController structure                         */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+
+void
+SmartMotorControllerPredictPtc( smartController *s )
+{
+    float   t_final;
+    float   ratio;
+    float   i_squared;
+
+    t_final = s->t_ambient + s->current * s->current * s->t_const_1;
+
+    if( s->temperature >= SMLIB_TEMP_TRIP )
+        s->trip_time = 0;
+    else
+    if( t_final <= SMLIB_TEMP_TRIP )
+        s->trip_time = SMLIB_TRIP_NEVER;
+    else
+        {
+        ratio = (t_final - s->temperature) / (t_final - SMLIB_TEMP_TRIP);
+        if( ratio > 1024 )
+            s->trip_time = SMLIB_TRIP_NEVER;
+        else
+            s->trip_time = log( ratio ) / s->t_const_2;
+        }
+
+    t_final = (SMLIB_TEMP_DERATE - s->temperature * s->ptc_decay) / (1.0 - s->ptc_decay);
+    i_squared = (t_final - s->t_ambient) / s->t_const_1;
+
+    if( i_squared > (s->safe_current * s->safe_current) )
+        s->allowed_current = sqrt( i_squared );
+    else
+        s->allowed_current = s->safe_current;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Is the limit cutting the command of any motor in a bank        */
+/** @param[in]  s Pointer to smartController structure                         */
+/** @returns    TRUE while a motor runs slower than it was asked to            */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+
+static short
+SmartMotorControllerLimiting( smartController *s )
+{
+    int     i;
+
+    for(i=0;i<SMLIB_TOTAL_NUM_BANK_MOTORS;i++)
+        {
+        if( s->motors[i] != NULL && SmartMotorSlewRequest( s->motors[i] ) != s->motors[i]->motor_cmd )
+            return( TRUE );
+        }
+
+    return( FALSE );
+}
+
 /*-----------------------------------------------------------------------------*/
 /** @brief      Monitor Motor PTC temperature                                  */
 /** @param[in]  m Pointer to smartMotor structure                              */
@@ -1303,17 +1758,18 @@ SmartMotorMonitorPtc( smartMotor *m, float v_battery )
             m->ptc_tripped = FALSE;
     }
 
-    // Is the bank ptc tripped ?
+    // Is the bank ptc tripped or derating ?
     // If so then leave limit_cmd alone
     if( m->bank != NULL )
         {
-        if( m->bank->ptc_tripped )
+        if( m->bank->ptc_tripped || m->bank->derating )
             return;
         }
 
     // Is (or was) the ptc tripped
     if( m->ptc_tripped )
         {
+        m->derating = FALSE;
         // we are using target_current as a debugging means
         // it must be positive
         m->target_current = m->safe_current;
@@ -1322,8 +1778,28 @@ SmartMotorMonitorPtc( smartMotor *m, float v_battery )
         }
     else
         {
-        // allow max speed
-        m->limit_cmd = SMLIB_MOTOR_MAX_CMD_UNDEFINED;
+        // derate before the ptc trips, with hysteresis as for the
+        // current limit so the command does not chatter, and keep
+        // derating while the limit still cuts the requested command
+        if( !PtcPredictEnabled )
+            m->derating = FALSE;
+        else
+        if( fabs(m->current) > m->allowed_current )
+            m->derating = TRUE;
+        else
+        if( fabs(m->current) < (m->allowed_current * 0.9) && SmartMotorSlewRequest( m ) == m->motor_cmd )
+            m->derating = FALSE;
+
+        if( m->derating )
+            {
+            m->target_current = m->allowed_current;
+            m->limit_cmd = SmartMotorSafeCommand( m, v_battery);
+            }
+        else
+            {
+            // allow max speed
+            m->limit_cmd = SMLIB_MOTOR_MAX_CMD_UNDEFINED;
+            }
         }
 }
 
@@ -1355,9 +1831,19 @@ SmartMotorControllerMonitorPtc( smartController *s, float v_battery )
             s->ptc_tripped = FALSE;
     }
 
+    // derate before the ptc trips
+    if( s->ptc_tripped || !PtcPredictEnabled )
+        s->derating = FALSE;
+    else
+    if( s->current > s->allowed_current )
+        s->derating = TRUE;
+    else
+    if( s->current < (s->allowed_current * 0.9) && !SmartMotorControllerLimiting( s ) )
+        s->derating = FALSE;
+
     // Is (or was) the PTC tripped
     // this will constantly be recalculated
-    if( s->ptc_tripped )
+    if( s->ptc_tripped || s->derating )
         {
         // now decide how to fix it.
         // divide amongst active motors, same current for each one we are using
@@ -1378,7 +1864,7 @@ SmartMotorControllerMonitorPtc( smartController *s, float v_battery )
             active_motors = 1;
 
         // calculate safe current based on number of active motors
-        float m_safe_current = s->safe_current / active_motors;
+        float m_safe_current = (s->ptc_tripped ? s->safe_current : s->allowed_current) / active_motors;
 
         for(i=0;i<SMLIB_TOTAL_NUM_BANK_MOTORS;i++)
             {
@@ -1390,6 +1876,9 @@ SmartMotorControllerMonitorPtc( smartController *s, float v_battery )
                 // see if the motor is tripped as well and use lowest current
                 if( m->ptc_tripped && (m->safe_current < m_safe_current) )
                     m->target_current = m->safe_current;
+                else
+                if( !m->ptc_tripped && (m->allowed_current < m_safe_current) )
+                    m->target_current = m->allowed_current;
                 else
                     m->target_current = m_safe_current;
 
@@ -1469,132 +1958,1275 @@ SmartMotorControllerSetLed( smartController *s )
         vexDigitalPinSet(s->statusLed,  SMLIB_LEDON);
 }
 
+#if SMLIB_FIXED_POINT
 /*-----------------------------------------------------------------------------*/
-/** @brief      The smart motor task                                           */
-/** @param[in]  arg pointer to user data (not used)                            */
+/*  Fixed point versions of the models                                         */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*  The STM32F103 has no FPU so every float operation above is a library       */
+/*  call.  These do the same calculations in Q16 with table based exp and log  */
+/*  from fixmath.c.  The constants are converted once by SmartMotorFixedSync   */
+/*  and the float variables are still written so the getters, debug output     */
+/*  and user code see the same values as before.                               */
+/*                                                                             */
 /*-----------------------------------------------------------------------------*/
-/** @note
- *  Running a little different in this version, instead of a 100mS delay
- *  and then calculations on each motor we do one motor each iteration
- */
-
-msg_t
-SmartMotorTask( void *arg )
-{
-    static  int loopDelay = 10;
-    static  int delayTimeMs = kVexMotorNum * 10;
-            int i;
-            int nextMotor = 0;
-            float   v_battery;
 
-    (void)arg;
+// model constants in Q16
+#define SMLIB_FX_V_DIODE        FIX(SMLIB_V_DIODE)
+#define SMLIB_FX_TEMP_TRIP      FIX(SMLIB_TEMP_TRIP)
+#define SMLIB_FX_TEMP_RESET     FIX(SMLIB_TEMP_TRIP - SMLIB_TEMP_HYST)
+#define SMLIB_FX_TEMP_DERATE    FIX(SMLIB_TEMP_DERATE)
+#define SMLIB_FX_I_ACTIVE       FIX(0.1)
 
-    // Must call this - but we are not terminated
-    vexTaskRegisterPersistant("smartMotor", TRUE);
+// longest step used by the fixed point temperature model, keeps the 64 bit
+// product in range, the float model is unstable long before this anyway
+#define SMLIB_FX_MAX_DELTA      10000
 
-    while(!chThdShouldTerminate())
-        {
-#ifdef  _smTestPoint_1
-        // debug time spent in this task
-        vexDigitalPinSet( _smTestPoint_1, 1);
+/*-----------------------------------------------------------------------------*/
+/** @brief      Convert the model constants to fixed point                     */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Called when the tasks are started and when a constant is changed, the
+ *  state (current and temperature) is taken from the float variables so
+ *  calling this again does not lose anything.
+ */
+
+static void
+SmartMotorFixedSync()
+{
+    int     i;
+    float   lamda;
+    smartMotor      *m;
+    smartController *s;
+
+    for(i=0;i<kVexMotorNum;i++)
+        {
+        m = _SmartMotorGetPtr( i );
+        if( m->type == kVexMotorUndefined )
+            continue;
+
+        lamda = m->r_motor/((float)SMLIB_PWM_FREQ * m->l_motor);
+
+        m->fx_lamda       = FIX( lamda );
+        m->fx_inv_lamda   = FIX( 1.0 / lamda );
+        m->fx_inv_cycle   = FIX( 1.0 / (1.0 - fastexp( -lamda )) );
+        m->fx_ke          = (int32_t)(m->ke_motor * 16777216.0);
+        m->fx_bemf_max    = FIX( m->v_bemf_max );
+        m->fx_r_on        = FIX( m->r_motor + SMLIB_R_SYS );
+        m->fx_inv_r_on    = FIX( 1.0 / (m->r_motor + SMLIB_R_SYS) );
+        m->fx_inv_r_off   = FIX( 1.0 / m->r_motor );
+        m->fx_current     = FIX( m->current );
+        m->fx_filtered    = FIX( m->filtered_current );
+        m->fx_temperature = FIX( m->temperature );
+        m->fx_t_const_1   = FIX( m->t_const_1 );
+        m->fx_t_const_2   = (uint32_t)(m->t_const_2 * 4294967296.0);
+        m->fx_t_ambient   = FIX( m->t_ambient );
+        m->fx_ptc_decay   = FIX( m->ptc_decay );
+        m->fx_allowed     = FIX( m->allowed_current );
+        m->fx_safe        = FIX( m->safe_current );
+        m->fx_limit       = FIX( m->limit_current );
+        }
+
+    for(i=0;i<SMLIB_TOTAL_NUM_CONTROL_BANKS;i++)
+        {
+        s = _SmartMotorControllerGetPtr( i );
+
+        s->fx_current     = FIX( s->current );
+        s->fx_temperature = FIX( s->temperature );
+        s->fx_t_const_1   = FIX( s->t_const_1 );
+        s->fx_t_const_2   = (uint32_t)(s->t_const_2 * 4294967296.0);
+        s->fx_t_ambient   = FIX( s->t_ambient );
+        s->fx_ptc_decay   = FIX( s->ptc_decay );
+        s->fx_allowed     = FIX( s->allowed_current );
+        s->fx_safe        = FIX( s->safe_current );
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Estimate smart motor current in fixed point                    */
+/** @param[in]  m Pointer to smartMotor structure                              */
+/** @param[in]  v_battery The battery voltage in Q16 volts                     */
+/** @returns    The calculated current in Q16 amps                             */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Same model as SmartMotorCurrent.  c1 * c2 is always exp(-lamda) so the
+ *  divide for i_0 uses the constant fx_inv_cycle, the only divides left
+ *  are duty_on and the zero crossing.
+ */
+
+static int32_t
+SmartMotorCurrentFixed( smartMotor *m, int32_t v_battery )
+{
+    int32_t v_bemf;
+    int32_t c1, c2;
+
+    int32_t duty_on, duty_off;
+
+    int32_t i_max, i_bar, i_0;
+    int32_t i_ss_on, i_ss_off;
+    int32_t num, den;
+
+    int32_t rpm;
+    int     dir;
+
+    // get current cmd
+    int     cmd = vexMotorGet( m->port );
+
+    // rpm in Q8
+    rpm = (int32_t)(m->rpm * 256.0f);
+
+    // rescale control value
+    // ports 2 through 9 behave a little differently
+    if( m->port > kVexMotor_1 && m->port < kVexMotor_10 )
+        cmd = (cmd * 128) / 90;
+
+    // clip control value to +/- 127
+    if( abs(cmd) > 127 )
+        cmd = (cmd > 0) ? 127 : -127;
+
+    // which way are we turning ?
+    if( abs(cmd) > 10 )
+        dir = (cmd > 0) - (cmd < 0);
+    else
+        dir = (rpm > 0) - (rpm < 0);
+
+    duty_on = (abs(cmd) << 16) / 127;
+
+    // constants for this pwm cycle
+    c1 = fixexp( -fixmul( m->fx_lamda, duty_on ) );
+    c2 = fixexp( -fixmul( m->fx_lamda, FIX_ONE - duty_on ) );
+
+    // Calculate back emf voltage, Q24 * Q8 gives Q32
+    v_bemf = (int32_t)(((int64_t)m->fx_ke * rpm) >> 16);
+
+    // clip v_bemf
+    if( v_bemf > m->fx_bemf_max )
+        v_bemf = m->fx_bemf_max;
+    else
+    if( v_bemf < -m->fx_bemf_max )
+        v_bemf = -m->fx_bemf_max;
+
+    // Calculate staady state current for on and off pwm phases
+    i_ss_on  =  fixmul( v_battery * dir - v_bemf, m->fx_inv_r_on );
+    i_ss_off = -fixmul( SMLIB_FX_V_DIODE * dir + v_bemf, m->fx_inv_r_off );
+
+    // compute trial i_0
+    i_0 = fixmul( fixmul( fixmul( i_ss_on, FIX_ONE - c1 ), c2 ) + fixmul( i_ss_off, FIX_ONE - c2 ), m->fx_inv_cycle );
+
+    //check to see if i_0 crosses 0 during off phase if diode were not in circuit
+    if( (dir > 0 && i_0 < 0) || (dir < 0 && i_0 > 0) )
+        {
+        i_0 = 0;
+
+        // peak current
+        i_max = fixmul( i_ss_on, FIX_ONE - c1 );
+
+        //where does the zero crossing occur
+        // log of a ratio that is not positive is where the float model
+        // gives NaN, use the whole off phase instead
+        num = -i_ss_off;
+        den = i_max - i_ss_off;
+        if( (num > 0 && den > 0) || (num < 0 && den < 0) )
+            duty_off = -fixmul( fixlog( fixdiv( num, den ) ), m->fx_inv_lamda );
+        else
+            duty_off = FIX_ONE - duty_on;
+        }
+    else
+        {
+        // peak current
+        i_max = fixmul( i_0, c1 ) + fixmul( i_ss_on, FIX_ONE - c1 );
+
+        // i_0 is non zero so final value of waveform must occur at end of cycle
+        duty_off = FIX_ONE - duty_on;
+        }
+
+    // Average current for cycle
+    i_bar = fixmul( i_ss_on, duty_on ) + fixmul( i_ss_off, duty_off );
+
+    // Save current
+    m->fx_current = i_bar;
+    m->current    = FIX2F( i_bar );
+
+    // simple iir filter to remove transients, 0.8 and 0.2
+    m->fx_filtered = (m->fx_filtered * 4 + i_bar) / 5;
+    m->filtered_current = FIX2F( m->fx_filtered );
+
+    // peak current - probably not useful
+    if( fabs(m->current) > m->peak_current )
+        m->peak_current = fabs(m->current);
+
+    return( i_bar );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Calculate the current for a controller bank in fixed point     */
+/** @param[in]  s A pointer to a smartController structure                     */
+/** @returns    The calculated current in Q16 amps                             */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+
+static int32_t
+SmartMotorControllerCurrentFixed( smartController *s )
+{
+    int     i;
+
+    s->fx_current = 0;
+
+    for(i=0;i<SMLIB_TOTAL_NUM_BANK_MOTORS;i++)
+        {
+        if( s->motors[i] != NULL )
+            {
+            if( s->motors[i]->type != kVexMotorUndefined )
+                s->fx_current += abs( s->motors[i]->fx_current );
+            }
+        }
+
+    s->current = FIX2F( s->fx_current );
+
+    // peak current - probably no use
+    if( s->current > s->peak_current )
+        s->peak_current = s->current;
+
+    return( s->fx_current );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Calculate safe current command in fixed point                  */
+/** @param[in]  m Pointer to smartMotor structure                              */
+/** @param[in]  v_battery The battery voltage in Q16 volts                     */
+/** @param[in]  target_current The target current in Q16 amps, positive        */
+/** @returns    The calculated command value                                   */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+
+static int
+SmartMotorSafeCommandFixed( smartMotor *m, int32_t v_battery, int32_t target_current )
+{
+    // get current cmd
+    int     cmd = vexMotorGet( m->port );
+    int32_t rpm = (int32_t)(m->rpm * 256.0f);
+    int32_t v_bemf = (int32_t)(((int64_t)m->fx_ke * rpm) >> 16);
+    int32_t v_drop = fixmul( target_current, m->fx_r_on );
+
+    // cmd polarity must match rpm polarity
+    if (cmd >= 0)
+        {
+        if (rpm >= 0)
+            cmd = (SMLIB_MOTOR_MAX_CMD * (v_bemf + v_drop + SMLIB_FX_V_DIODE)) / ( v_battery + SMLIB_FX_V_DIODE );
+        else
+            cmd = SMLIB_MOTOR_MAX_CMD;
+
+        // clip
+        if( cmd > SMLIB_MOTOR_MAX_CMD )
+            cmd = SMLIB_MOTOR_MAX_CMD;
+        }
+    else
+        {
+        if(rpm <= 0)
+            cmd = (SMLIB_MOTOR_MAX_CMD * (v_bemf - v_drop - SMLIB_FX_V_DIODE)) / ( v_battery + SMLIB_FX_V_DIODE );
+        else
+            cmd = SMLIB_MOTOR_MIN_CMD;
+
+        // clip
+        if( cmd < SMLIB_MOTOR_MIN_CMD )
+            cmd = SMLIB_MOTOR_MIN_CMD;
+        }
+
+    // override if current is 0
+    if( target_current == 0 )
+        cmd = 0;
+
+    // ports 2 through 9 behave a little differently
+    if( m->port > kVexMotor_1 && m->port < kVexMotor_10 )
+        cmd = (cmd * 90) / 128;
+
+    return( cmd );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Calculate the PTC temperature for a motor in fixed point       */
+/** @param[in]  m Pointer to smartMotor structure                              */
+/** @param[in]  deltaTime The time in mS from the last call to this function   */
+/** @returns    The calculated ptc temperature in Q16 degrees                  */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+
+static int32_t
+SmartMotorTemperatureFixed( smartMotor *m, int deltaTime )
+{
+    int32_t error;
+
+    if( deltaTime > SMLIB_FX_MAX_DELTA )
+        deltaTime = SMLIB_FX_MAX_DELTA;
+
+    error = fixmul( fixmul( m->fx_current, m->fx_current ), m->fx_t_const_1 ) - (m->fx_temperature - m->fx_t_ambient);
+
+    m->fx_temperature += (int32_t)(((int64_t)error * m->fx_t_const_2 * deltaTime) >> 32);
+    m->temperature = FIX2F( m->fx_temperature );
+
+    return( m->fx_temperature );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Calculate the PTC temperature for a bank in fixed point        */
+/** @param[in]  s Pointer to smartController structure                         */
+/** @param[in]  deltaTime The time in mS from the last call to this function   */
+/** @returns    The calculated ptc temperature in Q16 degrees                  */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+
+static int32_t
+SmartMotorControllerTemperatureFixed( smartController *s, int deltaTime )
+{
+    int32_t error;
+
+    if( deltaTime > SMLIB_FX_MAX_DELTA )
+        deltaTime = SMLIB_FX_MAX_DELTA;
+
+    error = fixmul( fixmul( s->fx_current, s->fx_current ), s->fx_t_const_1 ) - (s->fx_temperature - s->fx_t_ambient);
+
+    s->fx_temperature += (int32_t)(((int64_t)error * s->fx_t_const_2 * deltaTime) >> 32);
+    s->temperature = FIX2F( s->fx_temperature );
+
+    return( s->fx_temperature );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Predict the PTC in fixed point, motors and banks share this    */
+/** @param[in]  current The present current, Q16 amps                          */
+/** @param[in]  temperature The modeled PTC temperature, Q16 C                 */
+/** @param[in]  t_ambient The ambient temperature, Q16 C                       */
+/** @param[in]  t_const_1 The first thermal constant, Q16                      */
+/** @param[in]  t_const_2 The second thermal constant, Q32 per mS              */
+/** @param[in]  ptc_decay The decay over the prediction horizon, Q16           */
+/** @param[in]  i_safe The safe current, Q16 amps                              */
+/** @param[out] trip_time The time to trip in mS, or SMLIB_TRIP_NEVER          */
+/** @returns    The allowed current in Q16 amps                                */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+
+static int32_t
+SmartMotorPtcModelFixed( int32_t current, int32_t temperature, int32_t t_ambient,
+                         int32_t t_const_1, uint32_t t_const_2, int32_t ptc_decay,
+                         int32_t i_safe, long *trip_time )
+{
+    int32_t t_final;
+    int32_t i_squared;
+
+    t_final = t_ambient + fixmul( fixmul( current, current ), t_const_1 );
+
+    if( temperature >= SMLIB_FX_TEMP_TRIP )
+        *trip_time = 0;
+    else
+    if( t_final <= SMLIB_FX_TEMP_TRIP )
+        *trip_time = SMLIB_TRIP_NEVER;
+    else
+    if( (t_final - temperature) > ((int64_t)(t_final - SMLIB_FX_TEMP_TRIP) << 10) )
+        *trip_time = SMLIB_TRIP_NEVER;
+    else
+        *trip_time = ((int64_t)fixlog( fixdiv( t_final - temperature, t_final - SMLIB_FX_TEMP_TRIP ) ) << 16) / t_const_2;
+
+    t_final = fixdiv( SMLIB_FX_TEMP_DERATE - fixmul( temperature, ptc_decay ), FIX_ONE - ptc_decay );
+    i_squared = fixdiv( t_final - t_ambient, t_const_1 );
+
+    if( i_squared > fixmul( i_safe, i_safe ) )
+        return( fixsqrt( i_squared ) );
+    else
+        return( i_safe );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Fixed point version of SmartMotorPredictPtc                    */
+/** @param[in]  m pointer to smartMotor structure                              */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+
+static void
+SmartMotorPredictPtcFixed( smartMotor *m )
+{
+    m->fx_allowed = SmartMotorPtcModelFixed( m->fx_current, m->fx_temperature, m->fx_t_ambient,
+                                             m->fx_t_const_1, m->fx_t_const_2, m->fx_ptc_decay,
+                                             m->fx_safe, &m->trip_time );
+
+    m->allowed_current = FIX2F( m->fx_allowed );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Fixed point version of SmartMotorControllerPredictPtc          */
+/** @param[in]  s pointer to smartController structure                         */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+
+static void
+SmartMotorControllerPredictPtcFixed( smartController *s )
+{
+    s->fx_allowed = SmartMotorPtcModelFixed( s->fx_current, s->fx_temperature, s->fx_t_ambient,
+                                             s->fx_t_const_1, s->fx_t_const_2, s->fx_ptc_decay,
+                                             s->fx_safe, &s->trip_time );
+
+    s->allowed_current = FIX2F( s->fx_allowed );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Monitor Motor PTC temperature in fixed point                   */
+/** @param[in]  m Pointer to smartMotor structure                              */
+/** @param[in]  v_battery The battery voltage in Q16 volts                     */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+
+static void
+SmartMotorMonitorPtcFixed( smartMotor *m, int32_t v_battery )
+{
+    if( !m->ptc_tripped ) {
+        if( m->fx_temperature > SMLIB_FX_TEMP_TRIP )
+            m->ptc_tripped = TRUE;
+    }
+    else {
+        // 10 deg hysterisis
+        if( m->fx_temperature < SMLIB_FX_TEMP_RESET )
+            m->ptc_tripped = FALSE;
+    }
+
+    // Is the bank ptc tripped or derating ?
+    // If so then leave limit_cmd alone
+    if( m->bank != NULL )
+        {
+        if( m->bank->ptc_tripped || m->bank->derating )
+            return;
+        }
+
+    // Is (or was) the ptc tripped
+    if( m->ptc_tripped )
+        {
+        m->derating = FALSE;
+        m->target_current = m->safe_current;
+        m->limit_cmd = SmartMotorSafeCommandFixed( m, v_battery, m->fx_safe );
+        }
+    else
+        {
+        // derate before the ptc trips, the limited current is always low
+        // so only stop once the limit no longer cuts the request
+        if( !PtcPredictEnabled )
+            m->derating = FALSE;
+        else
+        if( abs(m->fx_current) > m->fx_allowed )
+            m->derating = TRUE;
+        else
+        if( abs(m->fx_current) < ((m->fx_allowed / 10) * 9) && SmartMotorSlewRequest( m ) == m->motor_cmd )
+            m->derating = FALSE;
+
+        if( m->derating )
+            {
+            m->target_current = m->allowed_current;
+            m->limit_cmd = SmartMotorSafeCommandFixed( m, v_battery, m->fx_allowed );
+            }
+        else
+            {
+            // allow max speed
+            m->limit_cmd = SMLIB_MOTOR_MAX_CMD_UNDEFINED;
+            }
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Monitor controller bank PTC temperature in fixed point         */
+/** @param[in]  s Pointer to smartController structure                         */
+/** @param[in]  v_battery The battery voltage in Q16 volts                     */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+
+static void
+SmartMotorControllerMonitorPtcFixed( smartController *s, int32_t v_battery )
+{
+    smartMotor    *m;
+    int            i;
+    int            active_motors = 0;
+    int32_t        m_safe_current;
+    int32_t        m_own_current;
+
+    if( !s->ptc_tripped ) {
+        if( s->fx_temperature > SMLIB_FX_TEMP_TRIP )
+            s->ptc_tripped = TRUE;
+    }
+    else {
+        // 10 deg hysterisis
+        if( s->fx_temperature < SMLIB_FX_TEMP_RESET )
+            s->ptc_tripped = FALSE;
+    }
+
+    // derate before the ptc trips
+    if( s->ptc_tripped || !PtcPredictEnabled )
+        s->derating = FALSE;
+    else
+    if( s->fx_current > s->fx_allowed )
+        s->derating = TRUE;
+    else
+    if( s->fx_current < ((s->fx_allowed / 10) * 9) && !SmartMotorControllerLimiting( s ) )
+        s->derating = FALSE;
+
+    if( !s->ptc_tripped && !s->derating )
+        return;
+
+    // divide amongst active motors, same current for each one we are using
+    for(i=0;i<SMLIB_TOTAL_NUM_BANK_MOTORS;i++)
+        {
+        m = s->motors[i];
+        if( m != NULL )
+            {
+            if( abs(m->fx_current) > SMLIB_FX_I_ACTIVE )
+                active_motors++;
+            }
+        }
+
+    // avoid divide by 0
+    if( active_motors == 0)
+        active_motors = 1;
+
+    if( s->ptc_tripped )
+        m_safe_current = s->fx_safe / active_motors;
+    else
+        m_safe_current = s->fx_allowed / active_motors;
+
+    for(i=0;i<SMLIB_TOTAL_NUM_BANK_MOTORS;i++)
+        {
+        m = s->motors[i];
+        if( m != NULL )
+            {
+            // see if the motor is tripped as well and use lowest current
+            m_own_current = m->ptc_tripped ? m->fx_safe : m->fx_allowed;
+            if( m_own_current < m_safe_current )
+                {
+                m->target_current = FIX2F( m_own_current );
+                m->limit_cmd = SmartMotorSafeCommandFixed( m, v_battery, m_own_current );
+                }
+            else
+                {
+                m->target_current = FIX2F( m_safe_current );
+                m->limit_cmd = SmartMotorSafeCommandFixed( m, v_battery, m_safe_current );
+                }
+            }
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Monitor Motor Current in fixed point                           */
+/** @param[in]  m Pointer to smartMotor structure                              */
+/** @param[in]  v_battery The battery voltage in Q16 volts                     */
+/** @warning    Internal smartMotorLibrary function, do not call, ref only     */
+/*-----------------------------------------------------------------------------*/
+
+static void
+SmartMotorMonitorCurrentFixed( smartMotor *m, int32_t v_battery )
+{
+    int32_t target = m->fx_limit;
+
+    m->target_current = m->limit_current;
+
+    if( !m->limit_tripped ) {
+        if( abs(m->fx_filtered) > target )
+            m->limit_tripped = TRUE;
+    }
+    else {
+        if( abs(m->fx_filtered) < ((target / 10) * 9) )
+            m->limit_tripped = FALSE;
+    }
+
+    if( m->limit_tripped )
+        m->limit_cmd = SmartMotorSafeCommandFixed( m, v_battery, target );
+    else
+        m->limit_cmd = SMLIB_MOTOR_MAX_CMD_UNDEFINED;
+}
+#endif
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Clear a history bucket                                         */
+/** @param[in]  b pointer to the buckets of one source                         */
+/*-----------------------------------------------------------------------------*/
+
+static void
+SmartMotorHistoryClear( smartHistoryBucket *b )
+{
+    int     v;
+
+    for( v=0;v<kSmartHistoryNum;v++ )
+        {
+        b[v].min =  32767;
+        b[v].max = -32768;
+        b[v].sum = 0;
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Add a sample to the history buckets of one source              */
+/** @param[in]  b pointer to the buckets being filled for the source           */
+/** @param[in]  sample the values to add                                       */
+/*-----------------------------------------------------------------------------*/
+
+static void
+SmartMotorHistoryAdd( smartHistoryBucket *b, const int16_t *sample )
+{
+    int     v;
+
+    for( v=0;v<kSmartHistoryNum;v++ )
+        {
+        if( sample[v] < b[v].min )
+            b[v].min = sample[v];
+        if( sample[v] > b[v].max )
+            b[v].max = sample[v];
+        b[v].sum += sample[v];
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Restart the match window of the telemetry history              */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The 1 and 10 second windows carry on, only the match totals are cleared.
+ *  Called when the monitor task starts and by the user code at the start of
+ *  a match.
+ */
+
+void
+SmartMotorHistoryReset()
+{
+    int     i, v;
+
+    chSysLock();
+    for( i=0;i<SMLIB_HISTORY_SOURCES;i++ )
+        {
+        for( v=0;v<kSmartHistoryNum;v++ )
+            {
+            sHistoryMatch[i][v].min =  32767;
+            sHistoryMatch[i][v].max = -32768;
+            sHistoryMatch[i][v].sum = 0;
+            }
+        }
+    sHistoryMatchCount = 0;
+    chSysUnlock();
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Empty all windows of the telemetry history                     */
+/*-----------------------------------------------------------------------------*/
+
+static void
+SmartMotorHistoryStart()
+{
+    int     i, j;
+
+    chSysLock();
+    for( j=0;j<SMLIB_HISTORY_FAST_NUM;j++ )
+        {
+        for( i=0;i<SMLIB_HISTORY_SOURCES;i++ )
+            SmartMotorHistoryClear( sHistoryFast[j][i] );
+        sHistoryFastCount[j] = 0;
+        }
+    for( j=0;j<SMLIB_HISTORY_SLOW_NUM;j++ )
+        {
+        for( i=0;i<SMLIB_HISTORY_SOURCES;i++ )
+            SmartMotorHistoryClear( sHistorySlow[j][i] );
+        sHistorySlowCount[j] = 0;
+        }
+    sHistoryFastHead = 0;
+    sHistorySlowHead = 0;
+    sHistoryFastTime = chTimeNow();
+    chSysUnlock();
+
+    SmartMotorHistoryReset();
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Sample every source into the telemetry history                 */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Called once per iteration of the monitor task.  Samples only go into the
+ *  200mS bucket being filled, a full bucket is folded into the 1 second
+ *  bucket and the match totals, and the oldest 200mS bucket is reused.  A
+ *  full 1 second bucket likewise reuses the oldest 1 second bucket, so the
+ *  cost of a sample does not depend on the length of the windows.
+ */
+
+static void
+SmartMotorHistoryUpdate()
+{
+    int16_t             sample[ kVexMotorNum + SMLIB_TOTAL_NUM_CONTROL_BANKS ][ kSmartHistoryNum ];
+    smartHistoryBucket *f, *s;
+    smartHistoryTotal  *t;
+    smartMotor         *m;
+    smartController    *c;
+    int                 i, v;
+
+    // convert all sources first, the motors that are not used stay empty
+    for( i=0;i<sActiveNum;i++ )
+        {
+        m = sActive[i];
+#if SMLIB_FIXED_POINT
+        sample[i][kSmartHistoryCurrent]     = ((m->fx_current >> 6) * 1000) >> 10;
+        sample[i][kSmartHistoryTemperature] = (m->fx_temperature * 10) >> 16;
+#else
+        sample[i][kSmartHistoryCurrent]     = m->current * 1000;
+        sample[i][kSmartHistoryTemperature] = m->temperature * 10;
+#endif
+        sample[i][kSmartHistoryCommand]     = m->motor_req;
+        sample[i][kSmartHistoryRpm]         = m->rpm;
+        }
+    for( i=0;i<SMLIB_TOTAL_NUM_CONTROL_BANKS;i++ )
+        {
+        c = _SmartMotorControllerGetPtr( i );
+#if SMLIB_FIXED_POINT
+        sample[kVexMotorNum+i][kSmartHistoryCurrent]     = ((c->fx_current >> 6) * 1000) >> 10;
+        sample[kVexMotorNum+i][kSmartHistoryTemperature] = (c->fx_temperature * 10) >> 16;
+#else
+        sample[kVexMotorNum+i][kSmartHistoryCurrent]     = c->current * 1000;
+        sample[kVexMotorNum+i][kSmartHistoryTemperature] = c->temperature * 10;
 #endif
+        sample[kVexMotorNum+i][kSmartHistoryCommand]     = 0;
+        sample[kVexMotorNum+i][kSmartHistoryRpm]         = 0;
+        }
 
-        v_battery = vexSpiGetMainBattery()/1000.0;
+    chSysLock();
 
-        smartMotor *m = _SmartMotorGetPtr( nextMotor );
+    for( i=0;i<sActiveNum;i++ )
+        SmartMotorHistoryAdd( sHistoryFast[ sHistoryFastHead ][ sActive[i]->port ], sample[i] );
+    for( i=0;i<SMLIB_TOTAL_NUM_CONTROL_BANKS;i++ )
+        SmartMotorHistoryAdd( sHistoryFast[ sHistoryFastHead ][ kVexMotorNum+i ], sample[kVexMotorNum+i] );
+    sHistoryFastCount[ sHistoryFastHead ]++;
 
-        // may be overkill, could just use default from above
-        delayTimeMs = chTimeNow()  - m->lastPgmTime;
-        m->lastPgmTime = chTimeNow() ;
-        m->delayTimeMs = delayTimeMs; // debug
+    if( (chTimeNow() - sHistoryFastTime) >= MS2ST( SMLIB_HISTORY_FAST_MS ) )
+        {
+        sHistoryFastTime += MS2ST( SMLIB_HISTORY_FAST_MS );
+        if( (chTimeNow() - sHistoryFastTime) >= MS2ST( SMLIB_HISTORY_FAST_MS ) )
+            sHistoryFastTime = chTimeNow();
 
-        // Set current etc. for one motor if it exists and has an encoder
-        if( m->type != kVexMotorUndefined )
+        // fold the full bucket into the 1 second bucket and the match
+        for( i=0;i<SMLIB_HISTORY_SOURCES;i++ )
             {
-            if( m->encoder_id >= 0)
+            f = sHistoryFast[ sHistoryFastHead ][i];
+            s = sHistorySlow[ sHistorySlowHead ][i];
+            t = sHistoryMatch[i];
+            for( v=0;v<kSmartHistoryNum;v++ )
                 {
-                if( m->encoder_id < ENCODER_ID_SENSOR )
-                    SmartMotorSpeed( m, delayTimeMs );
-                else
-                    SmartMotorSensorSpeed( m, delayTimeMs );
+                if( f[v].min < s[v].min ) s[v].min = f[v].min;
+                if( f[v].max > s[v].max ) s[v].max = f[v].max;
+                if( f[v].min < t[v].min ) t[v].min = f[v].min;
+                if( f[v].max > t[v].max ) t[v].max = f[v].max;
+                s[v].sum += f[v].sum;
+                t[v].sum += f[v].sum;
                 }
-            else
-                SmartMotorSimulateSpeed( m );
-
-            SmartMotorCurrent( m, v_battery );
-            SmartMotorTemperature( m, delayTimeMs );
-            if( PtcLimitEnabled )
-                SmartMotorMonitorPtc( m, v_battery );
-            if( CurrentLimitEnabled )
-                SmartMotorMonitorCurrent( m, v_battery );
             }
-
-#ifdef  __SMARTMOTORLIBDEBUG__
-        // Call user debug code
-        SmartMotorUserDebug( m );
-#endif
-        // next motor
-        if(++nextMotor == kVexMotorNum)
+        sHistorySlowCount[ sHistorySlowHead ] += sHistoryFastCount[ sHistoryFastHead ];
+        sHistoryMatchCount += sHistoryFastCount[ sHistoryFastHead ];
+
+        // start the next 200mS bucket
+        if( ++sHistoryFastHead == SMLIB_HISTORY_FAST_NUM )
+            sHistoryFastHead = 0;
+        for( i=0;i<SMLIB_HISTORY_SOURCES;i++ )
+            SmartMotorHistoryClear( sHistoryFast[ sHistoryFastHead ][i] );
+        sHistoryFastCount[ sHistoryFastHead ] = 0;
+
+        // and the next 1 second bucket every fifth time
+        if( sHistoryFastHead == 0 )
             {
-            nextMotor = 0;
+            if( ++sHistorySlowHead == SMLIB_HISTORY_SLOW_NUM )
+                sHistorySlowHead = 0;
+            for( i=0;i<SMLIB_HISTORY_SOURCES;i++ )
+                SmartMotorHistoryClear( sHistorySlow[ sHistorySlowHead ][i] );
+            sHistorySlowCount[ sHistorySlowHead ] = 0;
+            }
+        }
 
-            // now set cortext current
-            // this is much quicker than setting the motor currents so do all
-            // three ports, cortex and power expander.
-            for( i=0;i<SMLIB_TOTAL_NUM_CONTROL_BANKS;i++ )
-                {
-                smartController *s = _SmartMotorControllerGetPtr( i );
+    chSysUnlock();
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get min, max and mean of one source over a window              */
+/** @param[in]  source motor index, or SMLIB_HISTORY_BANK( bank )              */
+/** @param[in]  window the window to use                                       */
+/** @param[in]  stats pointer to the results                                   */
+/** @return     FALSE if the source or window is not valid                     */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The 1 second window is the 200mS buckets, including the one being
+ *  filled, so it covers between 0.8 and 1 second.  The 10 second and match
+ *  windows are made from full 200mS buckets and lag by up to 200mS.
+ */
 
-                SmartMotorControllerCurrent( s );
-                SmartMotorControllerTemperature( s, delayTimeMs );
+bool_t
+SmartMotorHistoryGet( short source, tSmartHistoryWindow window, smartHistoryStats *stats )
+{
+    const smartHistoryBucket *b;
+    int32_t     sum[ kSmartHistoryNum ];
+    int64_t     total;
+    int         i, v;
 
-                if( PtcLimitEnabled )
-                    SmartMotorControllerMonitorPtc( s, v_battery );
+    if( (source < 0) || (source >= SMLIB_HISTORY_SOURCES) || (stats == NULL) )
+        return( FALSE );
 
-                // turn off status leds here, more than one controller may
-                // share an led so we turn them off each loop
-                // and then any tripped controller may turn them on.
-                if( s->statusLed >= 0 )
-                    vexDigitalPinSet( s->statusLed, SMLIB_LEDOFF);
-                }
+    for( v=0;v<kSmartHistoryNum;v++ )
+        {
+        stats->min[v]  =  32767;
+        stats->max[v]  = -32768;
+        stats->mean[v] = 0;
+        sum[v] = 0;
+        }
+    stats->samples = 0;
+
+    // unused motors are never sampled
+    if( (source < kVexMotorNum) && (_SmartMotorGetPtr( source )->type == kVexMotorUndefined) )
+        return( TRUE );
 
-            // check status LED
-            for( i=0;i<SMLIB_TOTAL_NUM_CONTROL_BANKS;i++ )
+    chSysLock();
+
+    switch( window )
+        {
+        case    kSmartHistory1s:
+            for( i=0;i<SMLIB_HISTORY_FAST_NUM;i++ )
                 {
-                smartController *s = _SmartMotorControllerGetPtr( i );
-                if( s->statusLed >= 0 )
-                    SmartMotorControllerSetLed(s);
+                if( sHistoryFastCount[i] == 0 )
+                    continue;
+                b = sHistoryFast[i][source];
+                for( v=0;v<kSmartHistoryNum;v++ )
+                    {
+                    if( b[v].min < stats->min[v] ) stats->min[v] = b[v].min;
+                    if( b[v].max > stats->max[v] ) stats->max[v] = b[v].max;
+                    sum[v] += b[v].sum;
+                    }
+                stats->samples += sHistoryFastCount[i];
                 }
+            break;
 
-            // Monitor power expander status port
-            smartController *s = _SmartMotorControllerGetPtr( SMLIB_PWREXP_PORT_0 );
-            if( s->statusPort >= 0 )
+        case    kSmartHistory10s:
+            for( i=0;i<SMLIB_HISTORY_SLOW_NUM;i++ )
                 {
-                // assume A2 power expander
-                float pe_battery = vexAdcGet( s->statusPort ) / 270.0;
-                // Use 3 volts as threshold, should work for old and new power expanders
-                if( pe_battery < 3.0 )
+                if( sHistorySlowCount[i] == 0 )
+                    continue;
+                b = sHistorySlow[i][source];
+                for( v=0;v<kSmartHistoryNum;v++ )
                     {
-                    // tripped - bad !
-                    s->temperature  = 110;
-                    // drop safe current forever to 0
-                    s->safe_current = 0;
+                    if( b[v].min < stats->min[v] ) stats->min[v] = b[v].min;
+                    if( b[v].max > stats->max[v] ) stats->max[v] = b[v].max;
+                    sum[v] += b[v].sum;
                     }
+                stats->samples += sHistorySlowCount[i];
+                }
+            break;
+
+        case    kSmartHistoryMatch:
+            stats->samples = sHistoryMatchCount;
+            for( v=0;v<kSmartHistoryNum;v++ )
+                {
+                stats->min[v] = sHistoryMatch[source][v].min;
+                stats->max[v] = sHistoryMatch[source][v].max;
+                total = sHistoryMatch[source][v].sum;
+                if( sHistoryMatchCount > 0 )
+                    stats->mean[v] = total / (int64_t)sHistoryMatchCount;
+                }
+            break;
+
+        default:
+            chSysUnlock();
+            return( FALSE );
+        }
+
+    chSysUnlock();
+
+    if( window != kSmartHistoryMatch && stats->samples > 0 )
+        {
+        for( v=0;v<kSmartHistoryNum;v++ )
+            stats->mean[v] = sum[v] / (int32_t)stats->samples;
+        }
+
+    if( stats->samples == 0 )
+        {
+        for( v=0;v<kSmartHistoryNum;v++ )
+            {
+            stats->min[v] = 0;
+            stats->max[v] = 0;
+            }
+        }
+
+    return( TRUE );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Dump the telemetry history to the debug stream                 */
+/** @param[in]  chp     A pointer to a vexStream object                        */
+/** @param[in]  argc    The number of command line arguments                   */
+/** @param[in]  argv    An array of pointers to the command line args          */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The window is 1s, 10s or match, "reset" restarts the match window.
+ */
+
+void
+SmartMotorHistoryDebug( vexStream *chp, int argc, char *argv[] )
+{
+    static  const char *names[] = { "1s", "10s", "match" };
+            smartHistoryStats stats;
+            tSmartHistoryValue v;
+            int     window = kSmartHistory1s;
+            int     i;
+
+    if( argc == 1 )
+        {
+        if( strcmp( argv[0], "reset" ) == 0 )
+            {
+            SmartMotorHistoryReset();
+            return;
+            }
+        for( i=0;i<kSmartHistoryWindows;i++ )
+            {
+            if( strcmp( argv[0], names[i] ) == 0 )
+                window = i;
+            }
+        }
+
+    vex_chprintf(chp, "window %s      current mA (min max mean)  temp C (min max mean)     cmd (min max mean)    rpm (min max mean)\r\n", names[window] );
+    for( i=0;i<SMLIB_HISTORY_SOURCES;i++ )
+        {
+        SmartMotorHistoryGet( i, (tSmartHistoryWindow)window, &stats );
+        if( stats.samples == 0 )
+            continue;
+
+        if( i < kVexMotorNum )
+            vex_chprintf(chp, "motor %2d %6lu ", i + 1, stats.samples );
+        else
+            vex_chprintf(chp, "bank  %2d %6lu ", i - kVexMotorNum, stats.samples );
+
+        v = kSmartHistoryCurrent;
+        vex_chprintf(chp, "%6d %6d %6d   ", stats.min[v], stats.max[v], stats.mean[v] );
+        v = kSmartHistoryTemperature;
+        vex_chprintf(chp, "%4d.%d %4d.%d %4d.%d   ", stats.min[v] / 10, abs(stats.min[v]) % 10,
+                     stats.max[v] / 10, abs(stats.max[v]) % 10, stats.mean[v] / 10, abs(stats.mean[v]) % 10 );
+        v = kSmartHistoryCommand;
+        vex_chprintf(chp, "%4d %4d %4d   ", stats.min[v], stats.max[v], stats.mean[v] );
+        v = kSmartHistoryRpm;
+        vex_chprintf(chp, "%4d %4d %4d\r\n", stats.min[v], stats.max[v], stats.mean[v] );
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Build the list of motors the monitor visits                    */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Unused ports are left out so that updating every motor each period only
+ *  costs as much as the motors that are actually configured.
+ */
+
+static void
+SmartMotorActiveBuild()
+{
+    int         i;
+    smartMotor *m;
+
+    sActiveNum = 0;
+
+    for( i=0;i<kVexMotorNum;i++ )
+        {
+        m = _SmartMotorGetPtr( i );
+        if( m->type != kVexMotorUndefined )
+            sActive[ sActiveNum++ ] = m;
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Update speed, current and temperature of one motor             */
+/** @param[in]  m pointer to smartMotor structure                              */
+/** @param[in]  v_battery the main battery voltage                             */
+/*-----------------------------------------------------------------------------*/
+
+static void
+SmartMotorMonitorMotor( smartMotor *m, smartVolts v_battery )
+{
+    int     delayTimeMs;
+
+    // may be overkill, could just use default from above
+    delayTimeMs = chTimeNow()  - m->lastPgmTime;
+    m->lastPgmTime = chTimeNow() ;
+    m->delayTimeMs = delayTimeMs; // debug
+
+    // Set current etc. for one motor if it exists and has an encoder
+    if( m->type != kVexMotorUndefined )
+        {
+        if( m->encoder_id >= 0)
+            {
+            if( m->encoder_id < ENCODER_ID_SENSOR )
+                SmartMotorSpeed( m, delayTimeMs );
+            else
+                SmartMotorSensorSpeed( m, delayTimeMs );
+            }
+        else
+            SmartMotorSimulateSpeed( m );
+
+#if SMLIB_FIXED_POINT
+        SmartMotorCurrentFixed( m, v_battery );
+        SmartMotorTemperatureFixed( m, delayTimeMs );
+        SmartMotorPredictPtcFixed( m );
+        if( PtcLimitEnabled )
+            SmartMotorMonitorPtcFixed( m, v_battery );
+        if( CurrentLimitEnabled )
+            SmartMotorMonitorCurrentFixed( m, v_battery );
+#else
+        SmartMotorCurrent( m, v_battery );
+        SmartMotorTemperature( m, delayTimeMs );
+        SmartMotorPredictPtc( m );
+        if( PtcLimitEnabled )
+            SmartMotorMonitorPtc( m, v_battery );
+        if( CurrentLimitEnabled )
+            SmartMotorMonitorCurrent( m, v_battery );
+#endif
+        }
+
+#ifdef  __SMARTMOTORLIBDEBUG__
+    // Call user debug code
+    SmartMotorUserDebug( m );
+#endif
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Update current and temperature of all controller banks         */
+/** @param[in]  v_battery the main battery voltage                             */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The time step is measured from the last bank update, that is the time
+ *  taken to visit every motor in one motor mode or a single period when
+ *  all motors are updated together.
+ */
+
+static void
+SmartMotorMonitorControllers( smartVolts v_battery )
+{
+    static  systime_t lastTime = 0;
+            int       delayTimeMs;
+            int       i;
+
+    delayTimeMs = chTimeNow() - lastTime;
+    lastTime = chTimeNow();
+
+    // now set cortext current
+    // this is much quicker than setting the motor currents so do all
+    // three ports, cortex and power expander.
+    for( i=0;i<SMLIB_TOTAL_NUM_CONTROL_BANKS;i++ )
+        {
+        smartController *s = _SmartMotorControllerGetPtr( i );
+
+#if SMLIB_FIXED_POINT
+        SmartMotorControllerCurrentFixed( s );
+        SmartMotorControllerTemperatureFixed( s, delayTimeMs );
+        SmartMotorControllerPredictPtcFixed( s );
+
+        if( PtcLimitEnabled )
+            SmartMotorControllerMonitorPtcFixed( s, v_battery );
+#else
+        SmartMotorControllerCurrent( s );
+        SmartMotorControllerTemperature( s, delayTimeMs );
+        SmartMotorControllerPredictPtc( s );
+
+        if( PtcLimitEnabled )
+            SmartMotorControllerMonitorPtc( s, v_battery );
+#endif
+
+        // turn off status leds here, more than one controller may
+        // share an led so we turn them off each loop
+        // and then any tripped controller may turn them on.
+        if( s->statusLed >= 0 )
+            vexDigitalPinSet( s->statusLed, SMLIB_LEDOFF);
+        }
+
+    // check status LED
+    for( i=0;i<SMLIB_TOTAL_NUM_CONTROL_BANKS;i++ )
+        {
+        smartController *s = _SmartMotorControllerGetPtr( i );
+        if( s->statusLed >= 0 )
+            SmartMotorControllerSetLed(s);
+        }
+
+    // Monitor power expander status port
+    smartController *s = _SmartMotorControllerGetPtr( SMLIB_PWREXP_PORT_0 );
+    if( s->statusPort >= 0 )
+        {
+        // assume A2 power expander, 270 counts per volt
+        // Use 3 volts as threshold, should work for old and new power expanders
+        if( vexAdcGet( s->statusPort ) < (3 * 270) )
+            {
+            // tripped - bad !
+            s->temperature  = 110;
+#if SMLIB_FIXED_POINT
+            s->fx_temperature = FIX( 110 );
+#endif
+            // drop safe current forever to 0
+            s->safe_current = 0;
+#if SMLIB_FIXED_POINT
+            s->fx_safe = 0;
+#endif
+            }
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      The smart motor task                                           */
+/** @param[in]  arg pointer to user data (not used)                            */
+/*-----------------------------------------------------------------------------*/
+/** @note
+ *  Running a little different in this version, instead of a 100mS delay
+ *  and then calculations on each motor we do one motor each iteration.
+ *  With MonitorAllEnabled every configured motor and then the banks are
+ *  updated each iteration so current limiting reacts within one period.
+ *
+ *  The period is kept on an absolute deadline so time spent in the
+ *  calculations does not stretch it, and the time used is kept separately
+ *  for each mode so SmartMotorDebugStatus can compare them.
+ */
+
+msg_t
+SmartMotorTask( void *arg )
+{
+            int         nextMotor = 0;
+            int         i;
+            short       mode;
+            uint32_t    cyclesPerUs = halGetCounterFrequency() / 1000000;
+            uint32_t    start;
+            uint32_t    used;
+            systime_t   begin;
+            systime_t   deadline;
+            smartBudget *b;
+            smartVolts  v_battery;
+
+    (void)arg;
+
+    // Must call this - but we are not terminated
+    vexTaskRegisterPersistant("smartMotor", TRUE);
+
+    SmartMotorActiveBuild();
+    SmartMotorHistoryStart();
+
+    deadline = chTimeNow();
+
+    while(!chThdShouldTerminate())
+        {
+#ifdef  _smTestPoint_1
+        // debug time spent in this task
+        vexDigitalPinSet( _smTestPoint_1, 1);
+#endif
+        begin = chTimeNow();
+        start = halGetCounterValue();
+
+#if SMLIB_FIXED_POINT
+        v_battery = ((int32_t)vexSpiGetMainBattery() << 16) / 1000;
+#else
+        v_battery = vexSpiGetMainBattery()/1000.0;
+#endif
+
+        mode = MonitorAllEnabled;
+        b = &sBudget[ mode ? 1 : 0 ];
+
+        if( mode )
+            {
+            // every configured motor and then the banks
+            for( i=0;i<sActiveNum;i++ )
+                SmartMotorMonitorMotor( sActive[i], v_battery );
+            b->motors += sActiveNum;
+
+            SmartMotorMonitorControllers( v_battery );
+            }
+        else
+            {
+            // one motor, banks once all motors have been done
+            SmartMotorMonitorMotor( _SmartMotorGetPtr( nextMotor ), v_battery );
+            if( _SmartMotorGetPtr( nextMotor )->type != kVexMotorUndefined )
+                b->motors++;
+
+            // next motor
+            if(++nextMotor == kVexMotorNum)
+                {
+                nextMotor = 0;
+                SmartMotorMonitorControllers( v_battery );
                 }
             }
 
+        SmartMotorHistoryUpdate();
+
+        // a new limit needs the slew rate task
+        SmartMotorSlewCheck();
+
+        used = (halGetCounterValue() - start) / cyclesPerUs;
+        b->runs++;
+        b->last  = used;
+        b->busy += used;
+        if( used > b->worst )
+            b->worst = used;
+
 #ifdef  _smTestPoint_1
         // debug time spent in this task
         vexDigitalPinSet( _smTestPoint_1, 0);
 #endif
-        // wait
-        vexSleep(loopDelay);
+        // wait for the next deadline, chThdSleepUntil would sleep for a
+        // whole wrap of the system timer if it has already passed
+        deadline += MS2ST( SMLIB_MONITOR_PERIOD );
+        if( (int32_t)(deadline - chTimeNow()) <= 0 )
+            {
+            b->overruns++;
+            deadline = chTimeNow() + 1;
+            }
+        chThdSleepUntil( deadline );
+
+        b->elapsed += chTimeNow() - begin;
         }
 
     return (msg_t)0;
 }
 
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      The requested speed of a motor after any current limit         */
+/** @param[in]  m pointer to smartMotor structure                              */
+/** @returns    The requested speed                                            */
+/*-----------------------------------------------------------------------------*/
+
+static short
+SmartMotorSlewRequest( smartMotor *m )
+{
+    // check for limiting
+    if( (PtcLimitEnabled || CurrentLimitEnabled) && (m->limit_cmd != SMLIB_MOTOR_MAX_CMD_UNDEFINED) )
+        {
+        if( abs(m->motor_cmd) > abs(m->limit_cmd) ) {
+            // don't limit if we are reversing direction
+            if( sgn(m->motor_cmd) == sgn(m->limit_cmd) )
+                return( m->limit_cmd );
+            }
+        }
+
+    return( m->motor_cmd );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Wake the slew rate task if a limit changed a requested speed   */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Called by the monitor task after the limits have been updated, the slew
+ *  rate task does not look at the limits while all motors are settled.
+ */
+
+static void
+SmartMotorSlewCheck()
+{
+    int motorIndex;
+
+    if( sSlewThread == NULL )
+        return;
+
+    for( motorIndex=0; motorIndex<kVexMotorNum; motorIndex++)
+        {
+        if( SmartMotorSlewRequest( _SmartMotorGetPtr( motorIndex ) ) != _SmartMotorGetPtr( motorIndex )->motor_req )
+            {
+            chEvtSignal( sSlewThread, SMLIB_SLEW_EVENT );
+            return;
+            }
+        }
+}
+
 /*-----------------------------------------------------------------------------*/
 /** @brief      The motor slew rate task                                       */
 /** @param[in]  arg pointer to user data (not used)                            */
@@ -1603,13 +3235,24 @@ SmartMotorTask( void *arg )
  *  Task  - compares the requested speed of each motor to the actual speed
  *          and increments or decrements to reduce the difference as necessary
  *
+ *  While any motor is ramping the steps are taken every SMLIB_SLEW_FINE_PERIOD
+ *  and scaled by the time since the last step, so the ramp takes as long as it
+ *  did with a full step every SMLIB_SLEW_PERIOD but moves in smaller steps.
+ *  Once every motor has reached its requested speed the task sleeps until
+ *  SetMotor, SetMotorGroup or the monitor task signal SMLIB_SLEW_EVENT.
  */
 
 msg_t SmartMotorSlewRateTask( void *arg )
 {
-    static  int delayTimeMs = 15;
     int motorIndex;
     int motorTmp;
+    int motorStep;
+    int motorNext[kVexMotorNum];
+    bool_t motorChanged[kVexMotorNum];
+    bool_t changed;
+    short ramping;
+    systime_t lastTime;
+    int delayTimeMs;
     smartMotor  *m;
 
     (void)arg;
@@ -1624,8 +3267,14 @@ msg_t SmartMotorSlewRateTask( void *arg )
         m->motor_req  = 0;
         m->motor_cmd  = 0;
         m->motor_slew = SMLIB_MOTOR_DEFAULT_SLEW_RATE;
+        m->motor_slew_acc = 0;
         }
 
+    sSlewThread = chThdSelf();
+
+    // first step after being idle is always a whole one
+    lastTime = chTimeNow() - SMLIB_SLEW_PERIOD;
+
     // run task until stopped
     while( !chThdShouldTerminate() )
         {
@@ -1633,62 +3282,91 @@ msg_t SmartMotorSlewRateTask( void *arg )
         // debug time spent in this task
         vexDigitalPinSet( _smTestPoint_2, 1);
 #endif
+        changed = FALSE;
+        ramping = 0;
+
+        delayTimeMs = chTimeNow() - lastTime;
+        if( delayTimeMs > SMLIB_SLEW_PERIOD )
+            delayTimeMs = SMLIB_SLEW_PERIOD;
+        lastTime = chTimeNow();
+
         // run loop for every motor
         for( motorIndex=0; motorIndex<kVexMotorNum; motorIndex++)
             {
             m = _SmartMotorGetPtr( motorIndex );
+            motorChanged[motorIndex] = FALSE;
 
             // So we don't keep accessing the internal storage
             motorTmp = vexMotorGet( m->port );
 
-            // check for limiting
-            if( (PtcLimitEnabled || CurrentLimitEnabled) && (m->limit_cmd != SMLIB_MOTOR_MAX_CMD_UNDEFINED) )
+            m->motor_req = SmartMotorSlewRequest( m );
+
+            // Do we need to change the motor value ?
+            if( motorTmp == m->motor_req )
                 {
-                if( abs(m->motor_cmd) > abs(m->limit_cmd) ) {
-                    // don't limit if we are reversing direction
-                    if( sgn(m->motor_cmd) == sgn(m->limit_cmd) )
-                        m->motor_req = m->limit_cmd;
-                    else
-                        m->motor_req = m->motor_cmd;
-                    }
-                else
-                    m->motor_req = m->motor_cmd;
+                m->motor_slew_acc = 0;
+                continue;
+                }
+
+            // slew is per SMLIB_SLEW_PERIOD, keep what is left of a step
+            m->motor_slew_acc += m->motor_slew * delayTimeMs;
+            motorStep = m->motor_slew_acc / SMLIB_SLEW_PERIOD;
+            m->motor_slew_acc -= motorStep * SMLIB_SLEW_PERIOD;
+
+            // increasing motor value
+            if( m->motor_req > motorTmp )
+                {
+                motorTmp += motorStep;
+                // limit
+                if( motorTmp > m->motor_req )
+                    motorTmp = m->motor_req;
                 }
             else
-                m->motor_req = m->motor_cmd;
+                {
+                // decreasing motor value
+                motorTmp -= motorStep;
+                // limit
+                if( motorTmp < m->motor_req )
+                    motorTmp = m->motor_req;
+                }
 
-            // Do we need to change the motor value ?
             if( motorTmp != m->motor_req )
-                {
-                // increasing motor value
-                if( m->motor_req > motorTmp )
-                    {
-                    motorTmp += m->motor_slew;
-                    // limit
-                    if( motorTmp > m->motor_req )
-                        motorTmp = m->motor_req;
-                    }
+                ramping++;
+            else
+                m->motor_slew_acc = 0;
 
-                // increasing motor value
-                if( m->motor_req < motorTmp )
-                    {
-                    motorTmp -= m->motor_slew;
-                    // limit
-                    if( motorTmp < m->motor_req )
-                        motorTmp = m->motor_req;
-                    }
+            // finally set motor, after all motors are calculated
+            if( motorStep != 0 )
+                {
+                motorNext[motorIndex] = motorTmp;
+                motorChanged[motorIndex] = TRUE;
+                changed = TRUE;
+                }
+            }
 
-                // finally set motor
-                vexMotorSet( m->port, motorTmp);
+        // apply all changes together so they go out in the same SPI frame
+        if( changed )
+            {
+            chSysLock();
+            for( motorIndex=0; motorIndex<kVexMotorNum; motorIndex++)
+                {
+                if( motorChanged[motorIndex] )
+                    vexMotorSet( _SmartMotorGetPtr( motorIndex )->port, motorNext[motorIndex] );
                 }
+            chSysUnlock();
+            vexTracePoint( kVexTraceMotor );
             }
 
 #ifdef  _smTestPoint_2
         // debug time spent in this task
         vexDigitalPinSet( _smTestPoint_2, 0);
 #endif
-        // Wait approx the speed of motor update over the spi
-        vexSleep( delayTimeMs );
+        // take the next step soon while ramping, otherwise wait to be woken,
+        // the idle period only catches motors set from elsewhere
+        if( ramping )
+            vexSleep( SMLIB_SLEW_FINE_PERIOD );
+        else
+            vexSleep( SMLIB_SLEW_IDLE_PERIOD );
         }
 
     return (msg_t)0;
@@ -56,6 +56,19 @@
 // Version 1.11
 #define kSmartMotorLibVersion   112
 
+// Set to 0 to run the current, temperature and PTC models in float
+#ifndef SMLIB_FIXED_POINT
+#define SMLIB_FIXED_POINT       1
+#endif
+
+// Set to 0 to start with one motor updated each period rather than all
+#ifndef SMLIB_MONITOR_ALL
+#define SMLIB_MONITOR_ALL       SMLIB_FIXED_POINT
+#endif
+
+// Period of the monitor task in mS
+#define SMLIB_MONITOR_PERIOD    10
+
 // System parameters - don't change
 #define SMLIB_R_SYS             0.3
 #define SMLIB_PWM_FREQ          1150
@@ -101,6 +114,12 @@
 #define SMLIB_TEMP_HYST         10.0
 // Reference temperature for data below, 25 deg C
 #define SMLIB_TEMP_REF          25.0
+// Predictive limit, current is derated so that the modeled PTC would stay
+// below SMLIB_TEMP_DERATE for the next SMLIB_PTC_HORIZON seconds
+#define SMLIB_PTC_HORIZON       10.0
+#define SMLIB_TEMP_DERATE       (SMLIB_TEMP_TRIP - 5.0)
+// Time to trip when the PTC will not trip, or not for many time constants
+#define SMLIB_TRIP_NEVER        0x7FFFFFFF
 
 // Hold current is the current where thr PTC should not trip
 // Time to trip is the time at 5 x hold current
@@ -177,6 +196,8 @@ typedef struct {
     short   motor_cmd;
     short   motor_req;
     short   motor_slew;
+    // part of a slew step carried to the next step, in units of slew * mS
+    short   motor_slew_acc;
 
     // current limit and max cmd value
     short   limit_tripped;
@@ -222,6 +243,35 @@ typedef struct {
     float   t_ambient;
     short   ptc_tripped;
 
+    // PTC prediction, decay is exp( -t_const_2 * horizon )
+    float   ptc_decay;
+    float   allowed_current;
+    long    trip_time;          // mS at the present current
+    short   derating;
+
+#if SMLIB_FIXED_POINT
+    // fixed point copy of the model, Q16 unless noted
+    // the float variables above are kept up to date for everyone else
+    int32_t  fx_lamda;
+    int32_t  fx_inv_lamda;
+    int32_t  fx_inv_cycle;
+    int32_t  fx_ke;             // Q24 volts per rpm
+    int32_t  fx_bemf_max;
+    int32_t  fx_r_on;
+    int32_t  fx_inv_r_on;
+    int32_t  fx_inv_r_off;
+    int32_t  fx_current;
+    int32_t  fx_filtered;
+    int32_t  fx_temperature;
+    int32_t  fx_t_const_1;
+    uint32_t fx_t_const_2;      // Q32 per mS
+    int32_t  fx_t_ambient;
+    int32_t  fx_ptc_decay;
+    int32_t  fx_allowed;
+    int32_t  fx_safe;
+    int32_t  fx_limit;
+#endif
+
     // Last program time we ran - may not keep this, bit overkill
     long    lastPgmTime;
     } smartMotor;
@@ -236,6 +286,14 @@ typedef struct {
 #define SMLIB_MOTOR_FAST_SLEW_RATE      256     // essentially off
 #define SMLIB_MOTOR_DEADBAND            10      // values below this are set to 0
 
+// The slew rate is in command units per SMLIB_SLEW_PERIOD, while any motor
+// is ramping smaller steps are taken every SMLIB_SLEW_FINE_PERIOD.  When all
+// motors are settled the task waits for SMLIB_SLEW_EVENT or the idle period.
+#define SMLIB_SLEW_PERIOD               15      // mS
+#define SMLIB_SLEW_FINE_PERIOD          5       // mS
+#define SMLIB_SLEW_IDLE_PERIOD          100     // mS
+#define SMLIB_SLEW_EVENT                EVENT_MASK(1)
+
 // When current limit is not needed set limit_cmd to this value
 #define SMLIB_MOTOR_MAX_CMD_UNDEFINED   255     // special value for limit_motor
 
@@ -275,6 +333,24 @@ typedef struct _smartController {
     float  t_const_2;
     float  t_ambient;
 
+    // PTC prediction, as for the motors
+    float  ptc_decay;
+    float  allowed_current;
+    long   trip_time;
+    short  derating;
+
+#if SMLIB_FIXED_POINT
+    // fixed point copy of the model, Q16 unless noted
+    int32_t  fx_current;
+    int32_t  fx_temperature;
+    int32_t  fx_t_const_1;
+    uint32_t fx_t_const_2;      // Q32 per mS
+    int32_t  fx_t_ambient;
+    int32_t  fx_ptc_decay;
+    int32_t  fx_allowed;
+    int32_t  fx_safe;
+#endif
+
     // flag for ptc status
     short  ptc_tripped;
 
@@ -285,6 +361,39 @@ typedef struct _smartController {
     tVexAnalogPin statusPort;
     } smartController;
 
+// Telemetry history, sources are the motors followed by the banks
+#define SMLIB_HISTORY_SOURCES           (kVexMotorNum + SMLIB_TOTAL_NUM_CONTROL_BANKS)
+#define SMLIB_HISTORY_BANK( index )     (kVexMotorNum + (index))
+// 1 second window in 200mS buckets, 10 second window in 1 second buckets
+#define SMLIB_HISTORY_FAST_MS           200
+#define SMLIB_HISTORY_FAST_NUM          5
+#define SMLIB_HISTORY_SLOW_NUM          10
+
+// Values kept in the history, banks only have current and temperature
+typedef enum {
+    kSmartHistoryCurrent = 0,           // mA
+    kSmartHistoryTemperature,           // 0.1 deg C
+    kSmartHistoryCommand,               // motor command after slew and limit
+    kSmartHistoryRpm,                   // rpm
+
+    kSmartHistoryNum
+    } tSmartHistoryValue;
+
+typedef enum {
+    kSmartHistory1s = 0,
+    kSmartHistory10s,
+    kSmartHistoryMatch,
+
+    kSmartHistoryWindows
+    } tSmartHistoryWindow;
+
+typedef struct _smartHistoryStats {
+    uint32_t    samples;                        // samples in the window
+    int16_t     min[ kSmartHistoryNum ];
+    int16_t     max[ kSmartHistoryNum ];
+    int16_t     mean[ kSmartHistoryNum ];
+    } smartHistoryStats;
+
 
 // We have no inline so use a macro as shortcut to get ptr
 #define _SmartMotorGetPtr( index ) ((smartMotor *)&sMotors[ index ])
@@ -309,12 +418,19 @@ int              SmartMotorGetLimitCmd( tVexMotor index );
 
 float            SmartMotorGetControllerCurrent( short index );
 float            SmartMotorGetControllerTemperature( short index );
+long             SmartMotorGetTripTime( tVexMotor index );
+long             SmartMotorGetControllerTripTime( short index );
+long             SmartMotorGetTripTimeMin( void );
 
 // Control
 void             SmartMotorPtcMonitorEnable( void );
 void             SmartMotorPtcMonitorDisable( void );
 void             SmartMotorCurrentMonitorEnable( void );
 void             SmartMotorCurrentMonitorDisable( void );
+void             SmartMotorPtcPredictEnable( void );
+void             SmartMotorPtcPredictDisable( void );
+void             SmartMotorMonitorAllEnable( void );
+void             SmartMotorMonitorAllDisable( void );
 #define          SmartMotorSetLimitCurent(index, ... ) \
                  _SmartMotorSetLimitCurent( index, ##__VA_ARGS__, 1.0 )
 void             _SmartMotorSetLimitCurent( tVexMotor index, float current, ... );
@@ -332,11 +448,17 @@ void             _SmartMotorSetRpmSensor( tVexMotor index, tVexAnalogPin port, f
 #define          SetMotor( index, value, ... ) \
                  _SetMotor( index, value, ##__VA_ARGS__, FALSE )
 void             _SetMotor( int index, int value,  bool_t immediate, ... );
+void             SetMotorGroup( int16_t count, const int16_t *index, const int16_t *value, bool_t immediate );
 
 // Access raw data
 smartMotor      *SmartMotorGetPtr( tVexMotor index );
 smartController *SmartMotorControllerGetPtr( short index );
 
+// Telemetry history
+void             SmartMotorHistoryReset( void );
+bool_t           SmartMotorHistoryGet( short source, tSmartHistoryWindow window, smartHistoryStats *stats );
+void             SmartMotorHistoryDebug( vexStream *chp, int argc, char *argv[] );
+
 // Private functions for reference
 void             SmartMotorSpeed( smartMotor *m, int deltaTime );
 void             SmartMotorSimulateSpeed( smartMotor *m );
@@ -347,6 +469,8 @@ float            SmartMotorTemperature( smartMotor *m, int deltaTime );
 float            SmartMotorControllerTemperature( smartController *s, int deltaTime  );
 void             SmartMotorMonitorPtc( smartMotor *m, float v_battery );
 void             SmartMotorControllerMonitorPtc( smartController *s, float v_battery );
+void             SmartMotorPredictPtc( smartMotor *m );
+void             SmartMotorControllerPredictPtc( smartController *s );
 void             SmartMotorMonitorCurrent( smartMotor *m, float v_battery );
 void             SmartMotorControllerSetLed( smartController *s );
 msg_t            SmartMotorTask( void *arg );
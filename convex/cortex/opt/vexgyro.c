@@ -64,8 +64,14 @@ static WORKING_AREA(waVexGyroTask, USER_TASK_STACK_SIZE);
 // final value in deg * 10
 static int32_t     GyroValue = 0;
 
-// filter out noise.
-const int GyroJitterRange = 4;
+// bias in raw counts * 65536
+static int32_t     GyroBias = 0;
+
+// set while the robot is still and the bias is being tracked
+static bool_t      GyroStill = FALSE;
+
+// positions when the robot was last seen moving
+static int32_t     GyroPosition[kVexMotorNum + kVexQuadEncoder_Num];
 
 // pointer to our thread so we can kill it
 static Thread *gyroThread = NULL;
@@ -73,54 +79,147 @@ static Thread *gyroThread = NULL;
 // the gyro analog port
 static  tVexAnalogPin   gyroAnalogPin = kVexAnalog_1;
 
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*  Check whether anything on the robot is moving, no motor command may be     */
+/*  above GYRO_STILL_COMMAND and no motor position or encoder may have changed */
+/*  by more than one count.  Small commands are allowed as an arm or lift      */
+/*  holding against gravity or a switch does not move the robot, one count is  */
+/*  allowed as an encoder resting on an edge can toggle.                       */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+static bool_t
+vexGyroMoving(void)
+{
+    bool_t      moving = FALSE;
+    int32_t     position;
+    int16_t     i;
+
+    for(i=kVexMotor_1;i<kVexMotorNum;i++)
+        {
+        if( abs( vexMotorGet( i ) ) > GYRO_STILL_COMMAND )
+            moving = TRUE;
+
+        position = vexMotorPositionGet( i );
+        if( abs( position - GyroPosition[i] ) > 1 )
+            {
+            GyroPosition[i] = position;
+            moving = TRUE;
+            }
+        }
+
+    for(i=kVexQuadEncoder_1;i<kVexQuadEncoder_Num;i++)
+        {
+        position = vexEncoderGet( i );
+        if( abs( position - GyroPosition[kVexMotorNum + i] ) > 1 )
+            {
+            GyroPosition[kVexMotorNum + i] = position;
+            moving = TRUE;
+            }
+        }
+
+    return( moving );
+}
+
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*  The gyro task, each 1mS sample is the sum of the last VEX_ADC_DEPTH        */
+/*  conversions of the gyro port.  The rate is kept as raw counts * 4096 and   */
+/*  integrated with the trapezoidal rule, whole 0.1 deg steps are moved into   */
+/*  GyroValue and the remainder is kept so nothing is lost to truncation.      */
+/*  While the robot is still the bias follows the gyro output and the rate is  */
+/*  not integrated.                                                            */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
 static msg_t
 vexGyroTask(void *arg)
 {
     int16_t     i;
     int32_t     GyroBiasAcc = 0;
-    int32_t     GyroBias;
-    int32_t     GyroSmallBias;
-    int32_t     GyroRaw;
-    int32_t     GyroRawFiltered = 0;
-
-    int16_t     GyroDelta;
-    int32_t     GyroSensorScale = 130;
-    int32_t     GyroJitterCycles = 0;
+    int32_t     GyroSum;
+    int32_t     GyroRate;
+    int32_t     GyroLastRate = 0;
+    int32_t     GyroFiltered = 0;
+    int32_t     GyroAngle = 0;
+    int32_t     GyroSteps;
+    int32_t     GyroStillTime = 0;
+    int32_t     GyroUnit = GYRO_SENSOR_SCALE * 4096 * 2;
+    systime_t   lastTime;
+    int32_t     dt;
 
     (void)arg;
     chRegSetThreadName("gyro");
 
-    // find bias
-    for(i=0;i<1024;i++)
+    // start from 0 deg
+    GyroValue = 0;
+    GyroStill = FALSE;
+
+    // find bias, every sample is already VEX_ADC_DEPTH conversions
+    for(i=0;i<GYRO_CAL_TIME && !chThdShouldTerminate();i++)
         {
-        GyroBiasAcc = GyroBiasAcc + vexAdcGet( gyroAnalogPin );
+        GyroBiasAcc = GyroBiasAcc + vexAdcGetSum( gyroAnalogPin );
         chThdSleepMilliseconds(1);
         }
 
-    GyroBias      = GyroBiasAcc / 1024;
-    GyroSmallBias = GyroBiasAcc - (GyroBias * 1024);
+    GyroBias = (GyroBiasAcc / GYRO_CAL_TIME) * (65536 / VEX_ADC_DEPTH) +
+              ((GyroBiasAcc % GYRO_CAL_TIME) * (65536 / VEX_ADC_DEPTH)) / GYRO_CAL_TIME;
     // Ok bias done
 
+    for(i=0;i<kVexMotorNum + kVexQuadEncoder_Num;i++)
+        GyroPosition[i] = 0;
+    (void)vexGyroMoving();
+
+    lastTime = chTimeNow();
+
     while(!chThdShouldTerminate())
         {
-        // Get raw analog value
-        GyroRaw   = vexAdcGet( gyroAnalogPin );
-        // remove bias
-        GyroDelta = GyroRaw - GyroBias;
+        // time since the last sample, normally 1mS
+        dt = chTimeNow() - lastTime;
+        lastTime += dt;
+        if( dt > GYRO_MAX_DT )
+            dt = GYRO_MAX_DT;
 
-        // ignore small changes
-        if ((GyroDelta < -GyroJitterRange) || (GyroDelta > +GyroJitterRange))
-            {
-            // integrate angle
-            GyroRawFiltered += GyroDelta;
+        // Get oversampled analog value and remove bias
+        GyroSum  = vexAdcGetSum( gyroAnalogPin );
+        GyroRate = GyroSum * (4096 / VEX_ADC_DEPTH) - ((GyroBias + 8) >> 4);
 
-            // compensate for error in bias
-            if ((++GyroJitterCycles % 1024) == 0)
-                GyroRawFiltered -= GyroSmallBias;
+        // the robot is still once nothing has moved for a while, the rate
+        // is filtered first so noise alone does not look like movement
+        GyroFiltered += (GyroRate - GyroFiltered) / 32;
+        if( vexGyroMoving() || abs( GyroFiltered ) > GYRO_STILL_RATE * 4096 )
+            GyroStillTime = 0;
+        else
+        if( GyroStillTime < GYRO_STILL_TIME )
+            GyroStillTime += dt;
+
+        GyroStill = (GyroStillTime >= GYRO_STILL_TIME);
+
+        if( GyroStill )
+            {
+            // track the bias, nothing is integrated
+            GyroBias += (GyroSum * (65536 / VEX_ADC_DEPTH) - GyroBias + (1 << (GYRO_BIAS_SHIFT - 1))) >> GYRO_BIAS_SHIFT;
+            GyroLastRate = 0;
             }
+        else
+            {
+            // integrate angle, trapezoidal
+            GyroAngle += (GyroRate + GyroLastRate) * dt;
+            GyroLastRate = GyroRate;
+
+            // move whole steps of 0.1 deg into the result
+            GyroSteps  = GyroAngle / GyroUnit;
+            GyroAngle -= GyroSteps * GyroUnit;
+            if( GyroAngle < 0 )
+                {
+                GyroAngle += GyroUnit;
+                GyroSteps--;
+                }
 
-        // calculate angle in deg * 10
-        GyroValue = GyroRawFiltered / GyroSensorScale;
+            // calculate angle in deg * 10
+            GyroValue += GyroSteps;
+            }
 
         // sleep
         chThdSleepMilliseconds(1);
@@ -140,6 +239,28 @@ vexGyroGet()
     return( GyroValue );
 }
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the gyro bias                                              */
+/** @returns    The bias in raw ADC counts * 65536                             */
+/*-----------------------------------------------------------------------------*/
+
+int32_t
+vexGyroBiasGet()
+{
+    return( GyroBias );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Check if the bias is being tracked                             */
+/** @returns    TRUE while the robot is still                                  */
+/*-----------------------------------------------------------------------------*/
+
+bool_t
+vexGyroStillGet()
+{
+    return( GyroStill );
+}
+
 /*-----------------------------------------------------------------------------*/
 /** @brief      Init the gyro task                                            */
 /*-----------------------------------------------------------------------------*/
@@ -51,6 +51,26 @@
   * @brief   Gyro macros and prototypes
 *//*---------------------------------------------------------------------------*/
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      Gyro tuning                                                    */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  GYRO_SENSOR_SCALE is the raw counts * mS for 0.1 deg.  The bias is found
+ *  over GYRO_CAL_TIME mS at startup and then tracked whenever the robot has
+ *  been still, no motor command above GYRO_STILL_COMMAND and no encoder
+ *  moving, for GYRO_STILL_TIME mS and the gyro rate is below GYRO_STILL_RATE
+ *  raw counts.  The bias follows the gyro with a time constant of
+ *  2^GYRO_BIAS_SHIFT mS.  GYRO_STILL_COMMAND is above the power used to hold
+ *  an arm or lift, those commands do not move the robot.
+ */
+#define GYRO_SENSOR_SCALE   130
+#define GYRO_CAL_TIME       256
+#define GYRO_STILL_TIME     500
+#define GYRO_STILL_RATE     2
+#define GYRO_STILL_COMMAND  30
+#define GYRO_BIAS_SHIFT     9
+#define GYRO_MAX_DT         10
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -58,6 +78,8 @@ extern "C" {
 void        vexGyroInit(tVexAnalogPin pin);
 int32_t     vexGyroGet(void);
 void        vexGyroReset(void);
+int32_t     vexGyroBiasGet(void);
+bool_t      vexGyroStillGet(void);
 
 #ifdef __cplusplus
 }
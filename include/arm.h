@@ -13,24 +13,69 @@
 #include "vex.h" // vex library header
 
 #include "pidlib.h"
+#include "profile.h"
 #include "smartmotor.h"
 
+// positive power raises the arm, set if the pot reads lower as it rises
+#define ARM_POT_REVERSED 0
+
+// preset positions in pot counts
+#define ARM_FLOOR 400
+#define ARM_CARRY 1500
+#define ARM_CEILING 2900
+
+// pot reading with the arm horizontal, and pot counts per 10 degrees
+#define ARM_HORIZONTAL 1200
+#define ARM_COUNTS_PER_10DEG 164
+
+// travel in pot counts/s and counts/s^2, ARM_MAX_VELOCITY is the speed at full power
+#define ARM_MAX_VELOCITY 3000
+#define ARM_VELOCITY 2000
+#define ARM_ACCEL 8000
+
+// power needed to hold the arm horizontal, scaled by the cosine of the arm angle
+#define ARM_GRAVITY_POWER 18
+
+// the arm is at the target once within this many pot counts
+#define ARM_SETTLE 40
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef enum armPreset_e { kArmFloor = 0, kArmCarry, kArmCeiling, kArmPresetNumber } armPreset_t;
+
+typedef enum armMode_e {
+    kArmManual = 0, // open loop, from the buttons or armMove
+    kArmProfile,    // following a motion profile to the target
+    kArmHold,       // holding the target
+    kArmTune        // running the autotune relay
+} armMode_t;
+
 typedef struct arm_s {
     tVexMotor motor;
+    tVexAnalogPin pot;
     bool locked;
+    armMode_t mode;
+    int32_t origin;     // position at the start of the profile
+    int32_t target;     // position being moved to or held
+    systime_t start;    // time the profile started
+    profile_t profile;  // current move
+    pidController *pid; // position loop, error is calculated here
 } arm_t;
 
 extern arm_t *armGetPtr(void);
-extern void armSetup(tVexMotor motor);
+extern void armSetup(tVexMotor motor, tVexAnalogPin pot);
 extern void armInit(void);
-extern void armStart(void);
+extern void armStep(void);
 extern void armMove(int16_t cmd, bool immediate);
+extern void armMoveTo(int32_t position);
+extern void armMoveToPreset(armPreset_t preset);
+extern int32_t armPosition(void);
+extern bool armAtTarget(void);
 extern void armLock(void);
 extern void armUnlock(void);
+extern void armTune(void);
 
 #ifdef __cplusplus
 }
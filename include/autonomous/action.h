@@ -0,0 +1,83 @@
+// -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*
+ * autonomous/action.h
+ */
+
+#ifndef AUTONOMOUS_ACTION_H_
+
+#define AUTONOMOUS_ACTION_H_
+
+#include "ch.h"  // needs for all ChibiOS programs
+#include "hal.h" // hardware abstraction layer header
+#include "vex.h" // vex library header
+
+#include "autonomous/script.h"
+
+/**
+ * Actions run concurrently, every action has its own start condition and
+ * completion condition and all of them are evaluated on the same tick.
+ *
+ * Example of driving forward while the lift goes up, then running the
+ * intake once the lift pot reaches 2000:
+ *
+ *   action_t *drive, *lift, *intake;
+ *
+ *   actionReset();
+ *   drive = actionAdd(ROBOT_DRIVE, 0, 127, 1200);
+ *   lift = actionAdd(ROBOT_LIFT, 100, 0, 0);
+ *   actionUntil(lift, kVexSensorAnalog_2, 2000, false, 1500);
+ *   intake = actionAdd(ROBOT_INTAKE, 127, 0, 400);
+ *   actionAfter(intake, lift, 0);
+ *   actionRun();
+ */
+
+#define ACTION_MAX 24
+
+typedef enum {
+    kActionWaiting = 0,
+    kActionRunning,
+    kActionDone
+} kActionStateType;
+
+typedef struct actionCondition_s {
+    uint8_t sensor;    // tVexSensors channel or SCRIPT_SENSOR_NONE
+    bool below;        // value <= threshold instead of value >= threshold
+    int32_t threshold; // sensor threshold
+} actionCondition_t;
+
+typedef struct action_s {
+    uint8_t mask;            // ROBOT_* systems the action moves
+    int16_t a;               // first argument (drive: rotate)
+    int16_t b;               // second argument (drive: forward)
+    bool stop;               // stop the systems when the action finishes
+    kActionStateType state;  // current state
+    struct action_s *after;  // action that has to finish before this one starts
+    uint16_t delay;          // delay after the start condition in ms
+    actionCondition_t start; // sensor start condition
+    actionCondition_t until; // sensor completion condition
+    uint16_t duration;       // run time, or timeout with a completion condition, in ms
+    uint32_t started;        // start time in ms from the routine start
+    uint32_t finished;       // finish time in ms from the routine start
+} action_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern void actionReset(void);
+extern void actionSetOps(const scriptOps_t *ops);
+extern action_t *actionAdd(uint8_t mask, int16_t a, int16_t b, uint16_t duration);
+extern void actionAfter(action_t *action, action_t *after, uint16_t delay);
+extern void actionWhen(action_t *action, uint8_t sensor, int32_t threshold, bool below);
+extern void actionUntil(action_t *action, uint8_t sensor, int32_t threshold, bool below, uint16_t timeout);
+extern void actionHold(action_t *action);
+extern bool actionTick(uint32_t now);
+extern uint32_t actionNextEvent(uint32_t now);
+extern void actionRun(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -32,7 +32,7 @@
 #define ROBOT_ARM 0x01
 #define ROBOT_DRIVE 0x02
 #define ROBOT_INTAKE 0x04
-#define ROBOT_FLIPPER 0x06
+#define ROBOT_FLIPPER 0x20
 #define ROBOT_LIFT 0x08
 #define ROBOT_SETTER 0x10
 #define ROBOT_ALL (ROBOT_ARM | ROBOT_DRIVE | ROBOT_INTAKE | ROBOT_FLIPPER | ROBOT_LIFT | ROBOT_SETTER)
@@ -46,6 +46,7 @@ extern "C" {
 /* Arm function declarations */
 static void armRaise(int speed);
 static void armLower(int speed);
+static void armPreset(armPreset_t preset, unsigned long timeout);
 /* Drive function declarations */
 static void driveForward(int speed);
 static void driveBackward(int speed);
@@ -81,6 +82,27 @@ armLower(int speed)
     armMove(-speed, true);
 }
 
+/**
+ * Example of moving the arm to the carry position, allowing up to 800 ms for it:
+ *
+ *   armPreset(kArmCarry, 800);
+ *
+ * The step ends as soon as the arm is at the position.  The arm keeps
+ * holding the position after the step, until armMove or
+ * stopMovementOf(ROBOT_ARM, ...) is used.
+ */
+inline void
+armPreset(armPreset_t preset, unsigned long timeout)
+{
+    armMoveToPreset(preset);
+    timerRun(timeout, {
+        if (armAtTarget()) {
+            timerEnd();
+        }
+    });
+    return;
+}
+
 /* Drive function definitions */
 
 inline void
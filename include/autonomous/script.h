@@ -0,0 +1,103 @@
+// -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*
+ * autonomous/script.h
+ */
+
+#ifndef AUTONOMOUS_SCRIPT_H_
+
+#define AUTONOMOUS_SCRIPT_H_
+
+#include "ch.h"  // needs for all ChibiOS programs
+#include "hal.h" // hardware abstraction layer header
+#include "vex.h" // vex library header
+
+#include "storage.h"
+
+/**
+ * A script is a little endian image made of a header followed by an array
+ * of steps, it is uploaded over the RPC link into one of the script storage
+ * pages.  Steps that have SCRIPT_FLAG_WITH_NEXT set run in parallel with
+ * the step after them, a group of parallel steps is finished when every
+ * step in it is finished.
+ *
+ * A step is finished after duration ms, or once the sensor condition holds
+ * when sensor is set (duration then acts as a timeout, 0 means no timeout).
+ */
+
+#define SCRIPT_MAGIC 0x50524353 // "SCRP"
+#define SCRIPT_SLOTS 2
+#define SCRIPT_GROUP_MAX 8
+
+#define SCRIPT_OP_END 0x00  // end of the script
+#define SCRIPT_OP_MOVE 0x01 // move the systems in mask at speed a (drive: rotate a, forward b)
+#define SCRIPT_OP_STOP 0x02 // hold the systems in mask at 0
+#define SCRIPT_OP_WAIT 0x03 // do nothing
+
+#define SCRIPT_FLAG_WITH_NEXT 0x01 // run in parallel with the next step
+#define SCRIPT_FLAG_MIRROR 0x02    // negate a when the script runs mirrored
+#define SCRIPT_FLAG_BELOW 0x04     // sensor condition is value <= threshold instead of value >= threshold
+
+#define SCRIPT_SENSOR_NONE 0xff
+
+typedef struct scriptHeader_s {
+    uint32_t magic;    // SCRIPT_MAGIC
+    uint16_t count;    // number of steps
+    uint16_t modes;    // bit n set runs the script for lcd mode n
+    uint16_t mirror;   // bit n set runs the script mirrored for lcd mode n
+    uint16_t checksum; // fletcher-16 of the steps
+} scriptHeader_t;
+
+typedef struct scriptStep_s {
+    uint8_t op;        // SCRIPT_OP_*
+    uint8_t mask;      // ROBOT_* systems the step applies to
+    int8_t a;          // first argument
+    int8_t b;          // second argument
+    uint8_t flags;     // SCRIPT_FLAG_*
+    uint8_t sensor;    // tVexSensors channel or SCRIPT_SENSOR_NONE
+    uint16_t duration; // duration or timeout in ms
+    int16_t threshold; // sensor threshold
+    uint16_t reserved;
+} scriptStep_t;
+
+/**
+ * Everything the interpreter does to the robot goes through these, so the
+ * interpreter can be run against something other than the hardware.
+ */
+typedef struct scriptOps_s {
+    void (*move)(uint8_t mask, int16_t a, int16_t b);
+    int32_t (*sensor)(uint8_t sensor);
+} scriptOps_t;
+
+typedef struct script_s {
+    const scriptStep_t *steps; // the steps of the script
+    uint16_t count;            // number of steps
+    bool mirror;               // negate arguments of steps with SCRIPT_FLAG_MIRROR
+    const scriptOps_t *ops;    // robot operations
+    uint16_t pc;               // first step of the current group
+    uint16_t end;              // one past the last step of the current group
+    uint8_t done;              // finished steps of the current group
+    bool timed;                // every step of the current group finished on time
+    uint32_t start;            // start of the current group in ms
+    uint32_t length;           // longest duration in the current group in ms
+    bool running;              // false once the script has ended
+} script_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const scriptOps_t scriptRobotOps;
+
+extern const scriptHeader_t *scriptLoad(uint8_t slot);
+extern const scriptHeader_t *scriptFind(uint8_t mode, bool *mirror);
+extern uint16_t scriptChecksum(const scriptStep_t *steps, uint16_t count);
+extern void scriptInit(script_t *script, const scriptHeader_t *header, bool mirror, const scriptOps_t *ops, uint32_t now);
+extern bool scriptTick(script_t *script, uint32_t now);
+extern void scriptRun(const scriptHeader_t *header, bool mirror);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
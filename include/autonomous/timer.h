@@ -12,27 +12,46 @@
 #include "hal.h" // hardware abstraction layer header
 #include "vex.h" // vex library header
 
-#include <math.h>
-#include <stdlib.h>
+#include "ticker.h"
 
 /* Timer types and variables */
 
+// period of the timerRun loop in ms
+#ifndef AUTONOMOUS_TIMER_PERIOD
+#define AUTONOMOUS_TIMER_PERIOD 10
+#endif
+
+// set to 0 to stop logging the intended versus actual timeline
+#ifndef AUTONOMOUS_TIMER_LOG
+#define AUTONOMOUS_TIMER_LOG 1
+#endif
+
+/**
+ * Every step is measured against the epoch of the routine, so a step that
+ * ends late shortens the next step instead of pushing the rest of the
+ * routine back.
+ */
 typedef struct autonomousTimer_s {
-    unsigned long actual;
-    unsigned long target;
+    ticker_t ticker;        // periodic ticker for the timerRun loop
+    bool running;           // true once the epoch has been set
+    unsigned long intended; // intended end of the current step in ms from the epoch
+    unsigned long start;    // intended start of the current step in ms from the epoch
+    unsigned long step;     // number of the current step
 } autonomousTimer_t;
 
-static autonomousTimer_t autonomousTimer = {.actual = 0, .target = 0};
-
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /* Timer function declarations */
 
-static void timerSetTimeout(unsigned long target);
-static bool timerIsActive(void);
-static void timerTick(void);
+extern void timerReset(unsigned long period);
+extern void timerSetTimeout(unsigned long target);
+extern void timerSync(void);
+extern void timerEnd(void);
+extern bool timerIsActive(void);
+extern void timerTick(void);
+extern unsigned long timerElapsed(void);
 
 #define timerRun(TARGET, CODE)                                                                                                     \
     do {                                                                                                                           \
@@ -44,30 +63,6 @@ static void timerTick(void);
         }                                                                                                                          \
     } while (0)
 
-/* Timer function definitions */
-
-inline void
-timerSetTimeout(unsigned long target)
-{
-    autonomousTimer.actual = chTimeNow();
-    autonomousTimer.target = autonomousTimer.actual + target;
-    return;
-}
-
-inline bool
-timerIsActive(void)
-{
-    return (bool)(autonomousTimer.actual <= autonomousTimer.target);
-}
-
-inline void
-timerTick(void)
-{
-    vexSleep(25);
-    autonomousTimer.actual = chTimeNow();
-    return;
-}
-
 #ifdef __cplusplus
 }
 #endif
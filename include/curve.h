@@ -0,0 +1,84 @@
+// -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*
+ * curve.h
+ */
+
+#ifndef CURVE_H_
+
+#define CURVE_H_
+
+#include "ch.h"  // needs for all ChibiOS programs
+#include "hal.h" // hardware abstraction layer header
+#include "vex.h" // vex library header
+
+/**
+ * Response curves map a command of 0 to 127 onto a motor value.  Each
+ * curve is described by five parameters and its table is generated by the
+ * compiler, so tuning a curve means changing a parameter here.
+ *
+ *   DEADBAND  commands at or below this give 0
+ *   MIN       output just past the deadband, enough to get a motor moving
+ *   MAX       output just below SATURATE
+ *   SATURATE  commands at or above this give full power
+ *   EXPO      0 is linear from MIN to MAX, 100 is fully cubic
+ *
+ * SATURATE must be at least DEADBAND + 3.
+ */
+
+// linear, output equals the command
+#define CURVE_LINEAR_DEADBAND 0
+#define CURVE_LINEAR_MIN 1
+#define CURVE_LINEAR_MAX 127
+#define CURVE_LINEAR_SATURATE 128
+#define CURVE_LINEAR_EXPO 0
+
+// the motor linearization tuned for the 393 motors
+#define CURVE_STANDARD_DEADBAND 10
+#define CURVE_STANDARD_MIN 21
+#define CURVE_STANDARD_MAX 90
+#define CURVE_STANDARD_SATURATE 125
+#define CURVE_STANDARD_EXPO 30
+
+// number of entries in a curve table
+#define CURVE_SIZE 128
+
+// the value of entry x of a curve, a constant expression
+#define CURVE_SPAN(d, s) ((int64_t)(s) - (d)-2)
+#define CURVE_VALUE(x, d, lo, hi, s, e)                                                                                         \
+    ((x) <= (d) ? 0                                                                                                             \
+                : (x) >= (s) ? 127                                                                                              \
+                             : (lo) + ((hi) - (lo)) *                                                                           \
+                                          ((100 - (e)) * ((x) - (d)-1) * CURVE_SPAN(d, s) * CURVE_SPAN(d, s) +                  \
+                                           (e) * ((int64_t)(x) - (d)-1) * ((x) - (d)-1) * ((x) - (d)-1)) /                       \
+                                          (100 * CURVE_SPAN(d, s) * CURVE_SPAN(d, s) * CURVE_SPAN(d, s)))
+
+// generate the table for a curve by name
+#define CURVE_ENTRY(name, x)                                                                                                    \
+    (int8_t) CURVE_VALUE(x, CURVE_##name##_DEADBAND, CURVE_##name##_MIN, CURVE_##name##_MAX, CURVE_##name##_SATURATE,          \
+                         CURVE_##name##_EXPO)
+#define CURVE_ROW(name, x)                                                                                                      \
+    CURVE_ENTRY(name, (x) + 0), CURVE_ENTRY(name, (x) + 1), CURVE_ENTRY(name, (x) + 2), CURVE_ENTRY(name, (x) + 3),             \
+        CURVE_ENTRY(name, (x) + 4), CURVE_ENTRY(name, (x) + 5), CURVE_ENTRY(name, (x) + 6), CURVE_ENTRY(name, (x) + 7)
+#define CURVE_TABLE(name)                                                                                                       \
+    {                                                                                                                           \
+        CURVE_ROW(name, 0), CURVE_ROW(name, 8), CURVE_ROW(name, 16), CURVE_ROW(name, 24), CURVE_ROW(name, 32),                  \
+            CURVE_ROW(name, 40), CURVE_ROW(name, 48), CURVE_ROW(name, 56), CURVE_ROW(name, 64), CURVE_ROW(name, 72),            \
+            CURVE_ROW(name, 80), CURVE_ROW(name, 88), CURVE_ROW(name, 96), CURVE_ROW(name, 104), CURVE_ROW(name, 112),          \
+            CURVE_ROW(name, 120)                                                                                                \
+    }
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum curveName_e { kCurveLinear = 0, kCurveStandard, kCurveNumber } curveName_t;
+
+extern int curveApply(curveName_t curve, int command);
+extern const int8_t *curveGetTable(curveName_t curve);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,7 +12,55 @@
 #include "hal.h" // hardware abstraction layer header
 #include "vex.h" // vex library header
 
+#include "pidlib.h"
+#include "profile.h"
 #include "smartmotor.h"
+#include "vexgyro.h"
+
+// tracking encoder, ticks per inch of forward travel (360 count encoder on a 4" wheel)
+#define DRIVE_ENCODER kVexQuadEncoder_1
+#define DRIVE_TICKS_PER_INCH 29
+
+// gyro counts counter clockwise, drive headings are clockwise
+#define DRIVE_GYRO_REVERSED 1
+
+// forward motion in ticks/s and ticks/s^2, DRIVE_MAX_VELOCITY is the speed at full power
+#define DRIVE_MAX_VELOCITY 1200
+#define DRIVE_VELOCITY 900
+#define DRIVE_ACCEL 2400
+
+// turning in deg * 10/s and deg * 10/s^2, DRIVE_MAX_TURN_RATE is the rate at full power
+#define DRIVE_MAX_TURN_RATE 3600
+#define DRIVE_TURN_RATE 1800
+#define DRIVE_TURN_ACCEL 3600
+
+// ms ahead of the profile the velocity is fed forward, about the time the robot takes to reach 63% of a new
+// speed, and the command that just overcomes the friction of the drive
+#define DRIVE_FEED_LEAD 150
+#define DRIVE_FEED_STATIC 15
+
+// a move is settled once within these errors for DRIVE_SETTLE_TIME ms
+#define DRIVE_SETTLE_TICKS 15
+#define DRIVE_SETTLE_HEADING 20
+#define DRIVE_SETTLE_TIME 100
+#define DRIVE_SETTLE_TIMEOUT 1000
+
+// period of the closed loop moves in ms
+#define DRIVE_CONTROL_PERIOD 10
+
+// the distance and heading loops of the closed loop moves, one pidlib bank
+#define DRIVE_PID_DISTANCE 0
+#define DRIVE_PID_HEADING 1
+#define DRIVE_PID_NUM 2
+
+// set to 1 to start driver control with field centric driving on
+#define DRIVE_FIELD_CENTRIC 0
+
+// driver commands can be shaped per wheel in counts/s and counts/s^2, braking may be harder than speeding up,
+// an accel of 0 leaves them unshaped
+#define DRIVE_SHAPE_ACCEL 0
+#define DRIVE_SHAPE_DECEL 0
+#define DRIVE_SHAPE_JERK 0
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,13 +72,27 @@ typedef struct drive_s {
     tVexMotor southeast;
     tVexMotor southwest;
     bool locked;
+    pidFixedController pids[DRIVE_PID_NUM]; // distance and heading loops
+    bool fieldCentric;    // rotate driver input by the robot heading
+    int32_t fieldHeading; // robot heading when facing the field forward
+    bool shaping;         // shape the driver commands
+    shaper_t shapers[4];  // driver command shaping for each wheel
+    systime_t shaped;     // time of the last shaping step
 } drive_t;
 
 extern drive_t *driveGetPtr(void);
 extern void driveSetup(tVexMotor northeast, tVexMotor northwest, tVexMotor southeast, tVexMotor southwest);
 extern void driveInit(void);
-extern void driveStart(void);
+extern void driveStep(void);
 extern void driveMove(int16_t x, int16_t y, bool immediate);
+extern void driveHolonomic(int16_t x, int16_t y, int16_t r, bool immediate);
+extern void driveMix(int16_t x, int16_t y, int16_t r, int16_t wheels[4]);
+extern void driveSetFieldCentric(bool enabled);
+extern void driveSetShaping(int32_t accel, int32_t decel, int32_t jerk);
+extern int32_t driveHeading(void);
+extern bool driveDistance(int16_t inches);
+extern bool driveTurnDegrees(int16_t degrees);
+extern bool driveArc(int16_t radius, int16_t degrees);
 extern void driveLock(void);
 extern void driveUnlock(void);
 
@@ -25,7 +25,7 @@ typedef struct flipper_s {
 extern flipper_t *flipperGetPtr(void);
 extern void flipperSetup(tVexMotor motor);
 extern void flipperInit(void);
-extern void flipperStart(void);
+extern void flipperStep(void);
 extern void flipperMove(int16_t cmd, bool immediate);
 extern void flipperLock(void);
 extern void flipperUnlock(void);
@@ -26,7 +26,7 @@ typedef struct intake_s {
 extern intake_t *intakeGetPtr(void);
 extern void intakeSetup(tVexMotor motor);
 extern void intakeInit(void);
-extern void intakeStart(void);
+extern void intakeStep(void);
 extern void intakeMove(int16_t cmd, bool immediate);
 extern void intakeLock(void);
 extern void intakeUnlock(void);
@@ -0,0 +1,95 @@
+// -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*
+ * joystick.h
+ */
+
+#ifndef JOYSTICK_H_
+
+#define JOYSTICK_H_
+
+#include "ch.h"  // needs for all ChibiOS programs
+#include "hal.h" // hardware abstraction layer header
+#include "vex.h" // vex library header
+
+#include "profile.h"
+#include "storage.h"
+
+/**
+ * Joystick shaping turns the raw sticks into driver commands.  Each axis
+ * of a profile has its own deadband, expo, full scale output, slow mode
+ * limit and rate limit, and a driver picks one of the named profiles from
+ * the LCD or the RPC link.  Profiles are kept in a flash storage page.
+ *
+ *   deadband  stick values at or below this give 0
+ *   expo      0 is linear, 100 is fully cubic
+ *   scale     output at full stick
+ *   slow      output limit while JOYSTICK_SLOW is held, 0 for none
+ *   rate      counts/s the output may change by, 0 for no limit
+ */
+
+// the two transmitters have 4 axes each
+#define JOYSTICK_AXES 8
+
+// number of profiles, and the length of a profile name including the 0
+#define JOYSTICK_PROFILES 4
+#define JOYSTICK_NAME 8
+
+// button that puts every axis with a slow limit into slow mode
+#define JOYSTICK_SLOW Btn5U
+
+// magic number and version of the profiles in flash
+#define JOYSTICK_MAGIC 0x4a4f5931
+#define JOYSTICK_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct joystickAxis_s {
+    uint8_t deadband;
+    uint8_t expo;
+    uint8_t scale;
+    uint8_t slow;
+    uint16_t rate;
+} joystickAxis_t;
+
+typedef struct joystickProfile_s {
+    char name[JOYSTICK_NAME];
+    joystickAxis_t axes[JOYSTICK_AXES]; // Ch1 to Ch4, then Ch1Xmtr2 to Ch4Xmtr2
+} joystickProfile_t;
+
+// layout of the storage page
+typedef struct joystickStore_s {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t selected;
+    uint8_t count;
+    joystickProfile_t profiles[JOYSTICK_PROFILES];
+} joystickStore_t;
+
+typedef struct joystick_s {
+    joystickStore_t store;                       // profiles, as saved in flash
+    uint32_t revision;                           // bumped whenever the profiles change
+    uint32_t built;                              // revision the tables were built from
+    int8_t tables[JOYSTICK_AXES][128];           // deadband, expo and scale of the selected profile
+    shaper_t shapers[JOYSTICK_AXES];             // rate limit of each axis
+    int16_t values[JOYSTICK_AXES];               // shaped values for the current frame
+    uint32_t sequence;                           // SPI frame the values were shaped from
+    systime_t shaped;                            // time of the last shaping pass
+} joystick_t;
+
+extern joystick_t *joystickGetPtr(void);
+extern void joystickInit(void);
+extern void joystickStep(void);
+extern int16_t joystickGet(tCtlIndex index);
+extern int16_t joystickSelect(uint8_t profile);
+extern uint8_t joystickSelected(void);
+extern const joystickProfile_t *joystickGetProfile(uint8_t profile);
+extern int16_t joystickSetProfile(uint8_t profile, const joystickProfile_t *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
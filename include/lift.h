@@ -13,25 +13,88 @@
 #include "vex.h" // vex library header
 
 #include "pidlib.h"
+#include "profile.h"
 #include "smartmotor.h"
 
+// the limit switch closes at the floor, positive power drives toward it
+#define LIFT_REVERSED 1
+#define LIFT_POT_REVERSED 0
+
+// preset positions in pot counts above the floor
+#define LIFT_FLOOR 0
+#define LIFT_CARRY 600
+#define LIFT_CEILING 1400
+
+// travel in pot counts/s and counts/s^2, LIFT_MAX_VELOCITY is the speed at full power
+#define LIFT_MAX_VELOCITY 2400
+#define LIFT_VELOCITY 1800
+#define LIFT_ACCEL 6000
+
+// ms ahead of the profile the velocity is fed forward, about the time the lift takes to reach 63% of a new
+// speed and one step more, as the lift is only stepped every SYSTEM_PERIOD
+#define LIFT_FEED_LEAD 150
+
+// power used to find the limit switch, and to rest on it at the floor
+#define LIFT_HOME_POWER 80
+#define LIFT_REST_POWER 15
+
+// gravity compensation as a fraction of full power
+#define LIFT_BIAS 0.12
+
+// joystick values below this leave the lift under position control
+#define LIFT_DEADBAND 20
+
+// the lift is at the target once within this many pot counts
+#define LIFT_SETTLE 40
+
+// joystick commands are shaped in counts/s and counts/s^2, 0 jerk for none
+#define LIFT_SHAPE_ACCEL 800
+#define LIFT_SHAPE_DECEL 2000
+#define LIFT_SHAPE_JERK 0
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef enum liftMode_e {
+    kLiftManual = 0, // open loop, from the joystick or liftMove
+    kLiftHoming,     // driving toward the limit switch
+    kLiftProfile,    // following a motion profile to the target
+    kLiftHold,       // holding the target
+    kLiftTune        // running the autotune relay
+} liftMode_t;
+
 typedef struct lift_s {
     tVexMotor motor;
     tVexDigitalPin limit;
+    tVexAnalogPin pot;
     bool locked;
+    liftMode_t mode;
+    bool homed;            // zero has been set from the limit switch
+    int16_t zero;          // pot reading at the floor
+    int32_t origin;        // position at the start of the profile
+    int32_t target;        // position being moved to or held
+    systime_t start;       // time the profile started
+    profile_t profile;     // current move
+    pidController *pid;    // position loop, error is calculated here
+    shaper_t shaper;       // joystick command shaping
+    int32_t command;       // last command with up as positive
+    systime_t stepped;     // time of the last step
 } lift_t;
 
 extern lift_t *liftGetPtr(void);
-extern void liftSetup(tVexMotor motor, tVexDigitalPin limit);
+extern void liftSetup(tVexMotor motor, tVexDigitalPin limit, tVexAnalogPin pot);
 extern void liftInit(void);
-extern void liftStart(void);
+extern void liftStep(void);
 extern void liftMove(int16_t cmd, bool immediate);
+extern void liftMoveTo(int32_t position);
+extern void liftHome(void);
+extern int32_t liftPosition(void);
+extern bool liftAtTarget(void);
+extern void liftSetShaping(int32_t accel, int32_t decel, int32_t jerk);
 extern void liftLock(void);
 extern void liftUnlock(void);
+extern bool liftTune(void);
 
 #ifdef __cplusplus
 }
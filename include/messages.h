@@ -40,6 +40,8 @@
 #define MESSAGES_TOPIC_MOTOR 0x02
 #define MESSAGES_TOPIC_MOTOR_SUBTOPIC_ALL 0xff
 #define MESSAGES_TOPIC_SMARTMOTOR 0x03
+#define MESSAGES_TOPIC_SMARTMOTOR_SUBTOPIC_TRIP 0xfd
+#define MESSAGES_TOPIC_SMARTMOTOR_SUBTOPIC_RESET 0xfe
 #define MESSAGES_TOPIC_SMARTMOTOR_SUBTOPIC_ALL 0xff
 #define MESSAGES_TOPIC_NETWORK 0x04
 #define MESSAGES_TOPIC_NETWORK_SUBTOPIC_IPV4 0x00
@@ -52,6 +54,20 @@
 #define MESSAGES_TOPIC_CASSETTE_SUBTOPIC_COUNT 0xfb
 #define MESSAGES_TOPIC_CASSETTE_SUBTOPIC_FREE 0xfc
 #define MESSAGES_TOPIC_CASSETTE_SUBTOPIC_MAX 0xfd
+#define MESSAGES_TOPIC_SCRIPT 0x07
+#define MESSAGES_TOPIC_SCRIPT_SUBTOPIC_WRITE 0xf8
+#define MESSAGES_TOPIC_SCRIPT_SUBTOPIC_CLOSE 0xf9
+#define MESSAGES_TOPIC_SCRIPT_SUBTOPIC_OPEN 0xfa
+#define MESSAGES_TOPIC_SCRIPT_SUBTOPIC_COUNT 0xfb
+#define MESSAGES_TOPIC_SCRIPT_SUBTOPIC_MAX 0xfd
+#define MESSAGES_TOPIC_POSE 0x08
+#define MESSAGES_TOPIC_POSE_SUBTOPIC_FIELD 0x00
+#define MESSAGES_TOPIC_TRACE 0x09
+#define MESSAGES_TOPIC_TRACE_SUBTOPIC_RESET 0xfe
+#define MESSAGES_TOPIC_JOYSTICK 0x0a
+#define MESSAGES_TOPIC_JOYSTICK_SUBTOPIC_SELECT 0xfe
+#define MESSAGES_TOPIC_TUNE 0x0b
+#define MESSAGES_TOPIC_TUNE_SUBTOPIC_SAVE 0xfe
 #define MESSAGES_TOPIC_ALL 0xff
 #define MESSAGES_TOPIC_ALL_SUBTOPIC_ALL 0xff
 
@@ -0,0 +1,72 @@
+// -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*
+ * odometry.h
+ */
+
+#ifndef ODOMETRY_H_
+
+#define ODOMETRY_H_
+
+#include "ch.h"  // needs for all ChibiOS programs
+#include "hal.h" // hardware abstraction layer header
+#include "vex.h" // vex library header
+
+#include "drive.h"
+#include "ticker.h"
+
+// period of the pose estimator in ms
+#define ODOMETRY_PERIOD 10
+
+/**
+ * The drive encoder only measures travel along the robot, so without a
+ * lateral tracking wheel the pose is only valid for tank style moves, any
+ * strafing from the holonomic or field centric drive is lost.  Set
+ * ODOMETRY_LATERAL to 1 once a tracking wheel across the robot is on
+ * ODOMETRY_LATERAL_ENCODER, counting up when the robot moves right with
+ * the same ticks per inch as the drive encoder.
+ * ODOMETRY_LATERAL_TURN is the count of that wheel for one full turn on
+ * the spot, positive if it counts up turning clockwise, it is removed so
+ * turning is not mistaken for strafing.
+ */
+#ifndef ODOMETRY_LATERAL
+#define ODOMETRY_LATERAL 0
+#endif
+#define ODOMETRY_LATERAL_ENCODER kVexQuadEncoder_2
+#define ODOMETRY_LATERAL_TURN 0
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Field pose of the robot.  y points the way the robot faced when the pose
+ * was reset, x points to its right and heading is clockwise from y.
+ */
+typedef struct pose_s {
+    int32_t x;       // in 1/100 inch
+    int32_t y;       // in 1/100 inch
+    int32_t heading; // in deg * 10
+} pose_t;
+
+typedef struct odometry_s {
+    int32_t x;         // in encoder ticks, Q16
+    int32_t y;         // in encoder ticks, Q16
+    int32_t heading;   // in deg * 10
+    int32_t offset;    // drive heading at heading 0
+    int32_t encoder;   // last encoder count
+    int32_t lateral;   // last lateral encoder count
+    uint32_t count;    // number of updates
+    ticker_t ticker;   // periodic ticker
+} odometry_t;
+
+extern odometry_t *odometryGetPtr(void);
+extern void odometryStart(void);
+extern void odometryReset(const pose_t *pose);
+extern void odometryGet(pose_t *pose);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,60 @@
+// -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*
+ * profile.h
+ */
+
+#ifndef PROFILE_H_
+
+#define PROFILE_H_
+
+#include "ch.h"  // needs for all ChibiOS programs
+#include "hal.h" // hardware abstraction layer header
+#include "vex.h" // vex library header
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A trapezoidal velocity profile over a signed distance.  Units are up to
+ * the caller (encoder ticks, pot counts, deg * 10), velocity is in units
+ * per second and acceleration in units per second squared.  Moves that are
+ * too short to reach the velocity become triangular.
+ */
+typedef struct profile_s {
+    int32_t distance; // signed distance of the move
+    int32_t velocity; // peak velocity, always positive
+    int32_t accel;    // acceleration, always positive
+    uint32_t ramp;    // time to reach the peak velocity in ms
+    uint32_t total;   // duration of the move in ms
+} profile_t;
+
+/**
+ * A command shaper limits how fast a motor command may change.  Growing
+ * the command is limited by accel, shrinking or reversing it by decel, so
+ * a system can brake harder than it accelerates.  With jerk set the rate
+ * of change itself ramps, and it ramps down again before the target so
+ * the command does not overshoot.  Rates are in command counts per second.
+ */
+typedef struct shaper_s {
+    int32_t accel; // counts/s while the command grows
+    int32_t decel; // counts/s while the command shrinks or reverses
+    int32_t jerk;  // counts/s^2, 0 for no jerk limit
+    int32_t value; // current command, counts * 256
+    int32_t rate;  // current rate of change, counts * 256/s
+} shaper_t;
+
+extern void profileInit(profile_t *profile, int32_t distance, int32_t velocity, int32_t accel);
+extern void profileAt(const profile_t *profile, uint32_t t, int32_t *position, int32_t *velocity);
+extern uint32_t profileSqrt(uint32_t value);
+extern void shaperInit(shaper_t *shaper, int32_t accel, int32_t decel, int32_t jerk);
+extern void shaperSet(shaper_t *shaper, int32_t accel, int32_t decel, int32_t jerk);
+extern void shaperReset(shaper_t *shaper, int16_t value);
+extern int16_t shaperStep(shaper_t *shaper, int16_t target, uint32_t dt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -41,6 +41,8 @@ typedef struct rpc_s {
     int8_t motor[10];
     uint8_t cassette;
     user_param *fp;
+    uint8_t script;
+    uint16_t scriptOffset;
     uint8_t tmp[SFP_CONFIG_MAX_PACKET_SIZE];
     rpcBuffer_t in;
     rpcBuffer_t out;
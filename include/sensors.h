@@ -0,0 +1,104 @@
+// -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*
+ * sensors.h
+ */
+
+#ifndef SENSORS_H_
+
+#define SENSORS_H_
+
+#include "ch.h"  // needs for all ChibiOS programs
+#include "hal.h" // hardware abstraction layer header
+#include "vex.h" // vex library header
+
+#include "vexgyro.h"
+
+/**
+ * A snapshot of every sensor, taken by the control executive before the
+ * first step of each cycle so all steps see the same values.  Values are
+ * kept by type so reading one is an array index rather than the switch on
+ * the configured type done by vexSensorValueGet.
+ */
+
+// number of tVexSensors values
+#define SENSORS_NUM (kVexSensorIme_8 + 1)
+
+// number of IME channels
+#define SENSORS_IME_NUM (kVexSensorIme_8 - kVexSensorIme_1 + 1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct sensorsSnapshot_s {
+    uint32_t sequence;                    // bumped for every snapshot
+    systime_t time;                       // system time it was taken
+    uint32_t counter;                     // halGetCounterValue when it was taken
+    uint16_t digital;                     // digital pins, bit 0 is kVexDigital_1
+    int16_t analog[kVexAnalog_8 + 1];     // raw ADC values
+    int32_t encoder[kVexQuadEncoder_Num]; // encoder counts
+    int16_t sonar[kVexSonar_Num];         // sonar distances in cm, -1 if none
+    int32_t ime[SENSORS_IME_NUM];         // IME counts
+    int32_t gyro;                         // gyro heading in deg * 10
+} sensorsSnapshot_t;
+
+typedef enum sensorsKind_e {
+    kSensorsNone = 0,
+    kSensorsAnalog,
+    kSensorsDigital,
+    kSensorsEncoder,
+    kSensorsSonarCm,
+    kSensorsSonarInch,
+    kSensorsIme
+} sensorsKind_t;
+
+typedef struct sensorsMap_s {
+    uint8_t kind;    // a sensorsKind_t
+    uint8_t channel; // index into the array of that kind
+} sensorsMap_t;
+
+typedef struct sensors_s {
+    sensorsSnapshot_t snapshot;    // snapshot of the current cycle
+    sensorsMap_t map[SENSORS_NUM]; // where each tVexSensors value is kept
+} sensors_t;
+
+extern sensors_t *sensorsGetPtr(void);
+extern void sensorsInit(void);
+extern void sensorsStep(void);
+extern void sensorsTake(sensorsSnapshot_t *snapshot);
+extern const sensorsSnapshot_t *sensorsGet(void);
+extern int32_t sensorsValue(const sensorsSnapshot_t *snapshot, tVexSensors sensor);
+extern void sensorsDebug(vexStream *chp, int argc, char *argv[]);
+
+// Inline functions, read from the snapshot of the current cycle
+
+static inline int16_t
+sensorsAnalog(tVexAnalogPin pin)
+{
+    return sensorsGetPtr()->snapshot.analog[pin];
+}
+
+static inline tVexDigitalState
+sensorsDigital(tVexDigitalPin pin)
+{
+    return ((sensorsGetPtr()->snapshot.digital >> pin) & 1) ? kVexDigitalHigh : kVexDigitalLow;
+}
+
+static inline int32_t
+sensorsEncoder(int16_t channel)
+{
+    return sensorsGetPtr()->snapshot.encoder[channel];
+}
+
+static inline int32_t
+sensorsGyro(void)
+{
+    return sensorsGetPtr()->snapshot.gyro;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
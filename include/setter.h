@@ -26,7 +26,7 @@ typedef struct setter_s {
 extern setter_t *setterGetPtr(void);
 extern void setterSetup(tVexMotor motor);
 extern void setterInit(void);
-extern void setterStart(void);
+extern void setterStep(void);
 extern void setterMove(int16_t cmd, bool immediate);
 extern void setterLock(void);
 extern void setterUnlock(void);
@@ -0,0 +1,45 @@
+// -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*
+ * storage.h
+ */
+
+#ifndef STORAGE_H_
+
+#define STORAGE_H_
+
+#include "ch.h"  // needs for all ChibiOS programs
+#include "hal.h" // hardware abstraction layer header
+#include "vex.h" // vex library header
+
+#include "vexflash.h" // vex flash user parameter
+
+/**
+ * Whole flash pages for data that does not fit in the 32 byte user
+ * parameter block.  Pages are counted down from the user parameter page
+ * (0x0805F000), so page 0 is the page right below it.
+ */
+#define STORAGE_PAGE_SIZE 2048
+#define STORAGE_PAGE_TOP 0x0805F000
+
+typedef enum {
+    kStoragePageScript0 = 0,
+    kStoragePageScript1,
+    kStoragePageJoystick,
+    kStoragePageTune,
+    kStoragePageNumber
+} kStoragePageType;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const void *storageAddress(kStoragePageType page);
+extern int16_t storageErase(kStoragePageType page);
+extern int16_t storageWrite(kStoragePageType page, uint16_t offset, const void *data, uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,6 +12,16 @@
 #include "hal.h" // hardware abstraction layer header
 #include "vex.h" // vex library header
 
+// period of the control executive in ms when no controller frames arrive
+#define SYSTEM_PERIOD 25
+
+// maximum number of systems in the system table
+#define SYSTEM_MAX 10
+
+// events the control executive waits on, vexTaskRegister uses event 0
+#define SYSTEM_EVENT_TERMINATE EVENT_MASK(0)
+#define SYSTEM_EVENT_FRAME EVENT_MASK(1)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -24,12 +34,39 @@ typedef struct system_s {
     systemCallback_t start;
     systemCallback_t lock;
     systemCallback_t unlock;
+    systemCallback_t step;
+    const char *name;
 } system_t;
 
+typedef struct systemTiming_s {
+    uint32_t last;  // last step time in us
+    uint32_t worst; // worst step time in us
+} systemTiming_t;
+
+/**
+ * The control executive calls the step of every enabled system in table
+ * order once per controller frame, and keeps the time each one took and
+ * the time from the frame arriving to the last motor being set.
+ */
+typedef struct systemExecutive_s {
+    vexSpiFrame frame;                  // controller frame of the current cycle
+    systemTiming_t timing[SYSTEM_MAX];  // step times of each system
+    systemTiming_t cycle;               // time of all steps together
+    systemTiming_t latency;             // frame to last SetMotor time in us
+    uint32_t cycles;                    // number of cycles run
+    uint32_t timeouts;                  // cycles run without a new frame
+    uint32_t missed;                    // frames that arrived while stepping
+    uint32_t overruns;                  // number of cycles that ran over
+    systime_t reported;                 // last time an overrun was reported
+} systemExecutive_t;
+
 extern void systemInitAll(void);
 extern void systemStartAll(void);
 extern void systemLockAll(void);
 extern void systemUnlockAll(void);
+extern systemExecutive_t *systemGetPtr(void);
+extern int16_t systemControllerGet(tCtlIndex index);
+extern void systemDebug(vexStream *chp, int argc, char *argv[]);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,43 @@
+// -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*
+ * ticker.h
+ */
+
+#ifndef TICKER_H_
+
+#define TICKER_H_
+
+#include "ch.h"  // needs for all ChibiOS programs
+#include "hal.h" // hardware abstraction layer header
+#include "vex.h" // vex library header
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A periodic ticker based on absolute deadlines.  Each deadline is computed
+ * from the previous deadline rather than from "now", so the work done in
+ * each period does not accumulate into the period.
+ */
+typedef struct ticker_s {
+    systime_t period;   // period in system ticks
+    systime_t epoch;    // time the ticker was started
+    systime_t deadline; // the most recent deadline
+    uint32_t count;     // number of completed periods
+    uint32_t overruns;  // number of deadlines that were already missed
+    systime_t late;     // worst observed lateness in system ticks
+} ticker_t;
+
+extern void tickerInit(ticker_t *ticker, uint32_t periodMs);
+extern bool tickerWait(ticker_t *ticker);
+extern bool tickerWaitBounded(ticker_t *ticker, systime_t limit);
+extern systime_t tickerElapsed(const ticker_t *ticker);
+extern void tickerSleepUntil(systime_t deadline);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,29 @@
+// -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*
+ * trig.h
+ */
+
+#ifndef TRIG_H_
+
+#define TRIG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// sin and cos results are Q14, 1.0 == TRIG_ONE
+#define TRIG_SHIFT 14
+#define TRIG_ONE (1 << TRIG_SHIFT)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int32_t trigSin(int32_t angle);
+extern int32_t trigCos(int32_t angle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+// -*- mode: c++; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*
+ * tune.h
+ */
+
+#ifndef TUNE_H_
+
+#define TUNE_H_
+
+#include "ch.h"  // needs for all ChibiOS programs
+#include "hal.h" // hardware abstraction layer header
+#include "vex.h" // vex library header
+
+#include "pidlib.h"
+#include "storage.h"
+
+/**
+ * Autotuning of the position loops.  A relay experiment drives the
+ * mechanism back and forth around where it is, the ultimate gain and
+ * period of the oscillation are turned into PID gains by one of the pidlib
+ * rules.  The gains are kept in a flash storage page and applied at init.
+ *
+ * The system owning the motor runs the relay from its step while it is in
+ * its tune mode, the driver moving the mechanism cancels the tune.
+ */
+
+// relay amplitude as a motor command, gravity is added by the system
+#define TUNE_ARM_RELAY 30
+#define TUNE_LIFT_RELAY 30
+
+// pot counts either side of the target before the relay switches
+#define TUNE_HYSTERESIS 15
+
+// number of cycles the ultimate gain and period are averaged over
+#define TUNE_CYCLES 4
+
+// magic number and version of the gains in flash
+#define TUNE_MAGIC 0x54554e31
+#define TUNE_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum tuneSystem_e { kTuneArm = 0, kTuneLift, kTuneSystemNumber } tuneSystem_t;
+
+typedef struct tuneGains_s {
+    uint8_t valid; // gains have been tuned
+    uint8_t rule;  // tPidTuneRule they were worked out with
+    uint16_t reserved;
+    float Kp; // gains for PidControllerUpdate
+    float Ki;
+    float Kd;
+    float Ku; // ultimate gain, motor command per count
+    float Pu; // ultimate period in seconds
+} tuneGains_t;
+
+// layout of the storage page
+typedef struct tuneStore_s {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    tuneGains_t gains[kTuneSystemNumber];
+} tuneStore_t;
+
+typedef struct tune_s {
+    tuneStore_t store;                      // gains, as saved in flash
+    pidAutotune relay[kTuneSystemNumber];   // relay experiment of each system
+    tPidTuneRule rule[kTuneSystemNumber];   // rule used when the relay finishes
+    systime_t start[kTuneSystemNumber];     // time the relay started
+} tune_t;
+
+extern tune_t *tuneGetPtr(void);
+extern void tuneInit(void);
+extern bool tuneStart(tuneSystem_t system, tPidTuneRule rule);
+extern bool tuneStep(tuneSystem_t system, int32_t position, int16_t *cmd);
+extern tPidTuneState tuneState(tuneSystem_t system);
+extern void tuneCancel(tuneSystem_t system);
+extern const tuneGains_t *tuneGetGains(tuneSystem_t system);
+extern int16_t tuneSave(void);
+extern void tuneDebug(vexStream *chp, int argc, char *argv[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
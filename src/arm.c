@@ -6,6 +6,11 @@
 /*-----------------------------------------------------------------------------*/
 
 #include "arm.h"
+#include "curve.h"
+#include "sensors.h"
+#include "system.h"
+#include "trig.h"
+#include "tune.h"
 
 #include <math.h>
 #include <stdlib.h>
@@ -13,47 +18,24 @@
 // storage for arm
 static arm_t arm;
 
-// working area for arm task
-static WORKING_AREA(waArm, 512);
+// preset positions, indexed by armPreset_t
+static const int32_t armPresets[kArmPresetNumber] = {ARM_FLOOR, ARM_CARRY, ARM_CEILING};
 
 // private functions
-static msg_t armThread(void *arg);
+static int32_t armGravity(int32_t position);
+static void armStartProfile(void);
+static void armSet(int32_t cmd, bool immediate);
+static void armSetMode(armMode_t mode);
 
-// arm speed adjustment
-#define USE_ARM_SPEED_TABLE 1
-#ifdef USE_ARM_SPEED_TABLE
-
-const unsigned int armSpeedTable[128] = {0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  21, 21, 21, 22, 22,  22,  23, 24, 24, 25, 25,
-                                         25, 25, 26, 27, 27, 28, 28, 28, 28, 29, 30, 30, 30, 31, 31, 32,  32,  32, 33, 33, 34, 34,
-                                         35, 35, 35, 36, 36, 37, 37, 37, 37, 38, 38, 39, 39, 39, 40, 40,  41,  41, 42, 42, 43, 44,
-                                         44, 45, 45, 46, 46, 47, 47, 48, 48, 49, 50, 50, 51, 52, 52, 53,  54,  55, 56, 57, 57, 58,
-                                         59, 60, 61, 62, 63, 64, 65, 66, 67, 67, 68, 70, 71, 72, 72, 73,  74,  76, 77, 78, 79, 79,
-                                         80, 81, 83, 84, 84, 86, 86, 87, 87, 88, 88, 89, 89, 90, 90, 127, 127, 127};
+// arm response curve
+#define ARM_CURVE kCurveStandard
 
 static inline int
 armSpeed(int speed)
 {
-    if (speed > 127)
-        speed = 127;
-    else if (speed < -127)
-        speed = -127;
-    return (((speed > 0) - (speed < 0)) * armSpeedTable[abs(speed)]);
+    return curveApply(ARM_CURVE, speed);
 }
 
-#else
-
-static inline int
-armSpeed(int speed)
-{
-    if (speed > 127)
-        speed = 127;
-    else if (speed < -127)
-        speed = -127;
-    return (speed);
-}
-
-#endif
-
 /*-----------------------------------------------------------------------------*/
 /** @brief      Get pointer to arm structure - not used locally                */
 /** @return     A arm_t pointer                                                */
@@ -67,11 +49,13 @@ armGetPtr(void)
 /*-----------------------------------------------------------------------------*/
 /** @brief      Assign motor and potentiometer to the arm system.              */
 /** @param[in]  motor The arm motor (possibly a y-cabled pair)                 */
+/** @param[in]  pot The arm potentiometer                                      */
 /*-----------------------------------------------------------------------------*/
 void
-armSetup(tVexMotor motor)
+armSetup(tVexMotor motor, tVexAnalogPin pot)
 {
     arm.motor = motor;
+    arm.pot = pot;
     return;
 }
 
@@ -81,89 +65,212 @@ armSetup(tVexMotor motor)
 void
 armInit(void)
 {
+    // error is calculated from the profile setpoint, gravity is added after
+    if (arm.pid == NULL) {
+        arm.pid = PidControllerInit(0.003, 0.0002, 0.01, kVexSensorUndefined, 0);
+    }
+    arm.mode = kArmManual;
     return;
 }
 
 /*-----------------------------------------------------------------------------*/
-/** @brief      Start the arm system thread                                    */
+/** @brief      Run one control step of the arm system                        */
 /*-----------------------------------------------------------------------------*/
+/** @details
+ *  The in and out buttons drive the arm open loop, letting go holds the arm
+ *  where it is.  The floor, carry and ceiling buttons on the partner
+ *  joystick start a profiled move, unless 5U is held to use its in and out
+ *  buttons instead.
+ */
 void
-armStart(void)
+armStep(void)
 {
-    chThdCreateStatic(waArm, sizeof(waArm), NORMALPRIO - 1, armThread, NULL);
+    bool buttonIn = false;
+    bool buttonOut = false;
+    int32_t position = armPosition();
+    int32_t setpoint;
+    int32_t velocity;
+    uint32_t t;
+    int16_t armCmd = 0;
+    int16_t relay;
+
+    if (arm.locked) {
+        buttonIn = (bool)systemControllerGet(Btn8R);
+        buttonOut = (bool)systemControllerGet(Btn8D);
+        if (systemControllerGet(Btn5UXmtr2)) {
+            buttonIn = (bool)systemControllerGet(Btn8RXmtr2);
+            buttonOut = (bool)systemControllerGet(Btn8DXmtr2);
+        } else if (systemControllerGet(Btn8DXmtr2)) {
+            armMoveToPreset(kArmFloor);
+        } else if (systemControllerGet(Btn8RXmtr2)) {
+            armMoveToPreset(kArmCarry);
+        } else if (systemControllerGet(Btn8UXmtr2)) {
+            armMoveToPreset(kArmCeiling);
+        }
+        if (buttonIn == true) {
+            armCmd = 127;
+        } else if (buttonOut == true) {
+            armCmd = -127;
+        }
+        if (armCmd != 0) {
+            armSetMode(kArmManual);
+        } else if (arm.mode == kArmManual) {
+            arm.target = position;
+            armSetMode(kArmHold);
+        }
+    }
+
+    switch (arm.mode) {
+    case kArmManual:
+        // armMove owns the motor when unlocked
+        if (arm.locked) {
+            armSet(armSpeed(armCmd), false);
+        }
+        break;
+
+    case kArmProfile:
+        t = (uint32_t)((chTimeElapsedSince(arm.start) * 1000) / CH_FREQUENCY);
+        profileAt(&arm.profile, t, &setpoint, &velocity);
+        arm.pid->error = (float)(arm.origin + setpoint - position);
+        armSet((velocity * 127) / ARM_MAX_VELOCITY + PidControllerUpdate(arm.pid) + armGravity(position), true);
+        if (t >= arm.profile.total) {
+            armSetMode(kArmHold);
+        }
+        break;
+
+    case kArmHold:
+        arm.pid->error = (float)(arm.target - position);
+        armSet(PidControllerUpdate(arm.pid) + armGravity(position), true);
+        break;
+
+    case kArmTune:
+        // the autotune relay owns the motor until it finishes
+        if (tuneStep(kTuneArm, position, &relay)) {
+            armSet(relay + armGravity(position), true);
+        } else {
+            arm.target = position;
+            arm.pid->integral = 0;
+            armSetMode(kArmHold);
+        }
+        break;
+    }
+
     return;
 }
 
-static inline int
-limitSpeed(int speed, int limit)
+/*-----------------------------------------------------------------------------*/
+/** @brief      Drive the arm motor open loop                                  */
+/** @param[in]  cmd The motor command                                          */
+/** @param[in]  immediate Bypass the motor slew rate                           */
+/*-----------------------------------------------------------------------------*/
+void
+armMove(int16_t cmd, bool immediate)
 {
-    if (abs(speed) <= limit) {
-        return 0;
-    }
-    return speed;
+    armSetMode(kArmManual);
+    SetMotor(arm.motor, cmd, immediate);
 }
 
 /*-----------------------------------------------------------------------------*/
-/** @brief      The arm system thread                                          */
-/** @param[in]  arg Unused                                                     */
-/** @return     (msg_t) 0                                                      */
+/** @brief      Move the arm to a position with a motion profile               */
+/** @param[in]  position The position in pot counts                            */
 /*-----------------------------------------------------------------------------*/
-static msg_t
-armThread(void *arg)
+/** @details
+ *  The move is carried out by armStep, also while the arm is unlocked.
+ */
+void
+armMoveTo(int32_t position)
 {
-    bool buttonIn = false;
-    bool buttonOut = false;
-    int16_t armCmd = 0;
-    bool immediate = false;
-    // Unused
-    (void)arg;
-
-    // Register the task
-    vexTaskRegister("arm");
-    // while (!chThdShouldTerminate()) {
-    //     if (arm.locked) {
-    //         armCmd = vexControllerGet(Ch2Xmtr2);
-    //         if (vexControllerGet(Btn5U)) {
-    //             armCmd = vexControllerGet(Ch2);
-    //         }
-    //         armCmd = armSpeed(limitSpeed(armCmd, 20));
-    //         armMove(armCmd, immediate);
-    //     }
-    while (!chThdShouldTerminate()) {
-        if (arm.locked) {
-            // armCmd = vexControllerGet(Ch2Xmtr2);
-            buttonIn = (bool)vexControllerGet(Btn8R);
-            buttonOut = (bool)vexControllerGet(Btn8D);
-            // armCmd = vexControllerGet(Ch2Xmtr2);
-            if (vexControllerGet(Btn5UXmtr2)) {
-                // armCmd = vexControllerGet(Ch2);
-                buttonIn = (bool)vexControllerGet(Btn8RXmtr2);
-                buttonOut = (bool)vexControllerGet(Btn8DXmtr2);
-                // armCmd = vexControllerGet(Ch2);
-            }
-            if (buttonIn == true) {
-                armCmd = 127;
-            } else if (buttonOut == true) {
-                armCmd = -127;
-            } else {
-                armCmd = 0;
-            }
-            // armCmd = armSpeed(limitSpeed(armCmd, 20));
-            armCmd = armSpeed(armCmd);
-            armMove(armCmd, immediate);
-        }
+    // the same position still ends manual control or an autotune
+    if (arm.target == position && arm.mode != kArmManual && arm.mode != kArmTune) {
+        return;
+    }
+    arm.target = position;
+    armStartProfile();
+    return;
+}
 
-        //     Don't hog cpu
-        vexSleep(25);
+/*-----------------------------------------------------------------------------*/
+/** @brief      Move the arm to one of the preset positions                    */
+/** @param[in]  preset The preset                                              */
+/*-----------------------------------------------------------------------------*/
+void
+armMoveToPreset(armPreset_t preset)
+{
+    if ((unsigned int)preset >= kArmPresetNumber) {
+        return;
     }
+    armMoveTo(armPresets[preset]);
+    return;
+}
 
-    return ((msg_t)0);
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the arm position                                           */
+/** @return     The position in pot counts                                     */
+/*-----------------------------------------------------------------------------*/
+int32_t
+armPosition(void)
+{
+    int32_t position = sensorsAnalog(arm.pot);
+    return (ARM_POT_REVERSED ? 4095 - position : position);
 }
 
-void
-armMove(int16_t cmd, bool immediate)
+/*-----------------------------------------------------------------------------*/
+/** @brief      Check if the arm has reached its target                        */
+/** @return     true once the move is done and the arm is close enough         */
+/*-----------------------------------------------------------------------------*/
+bool
+armAtTarget(void)
+{
+    return (arm.mode == kArmHold && abs(arm.target - armPosition()) <= ARM_SETTLE);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Power needed to hold the arm against gravity                   */
+/** @param[in]  position The position in pot counts                            */
+/*-----------------------------------------------------------------------------*/
+static int32_t
+armGravity(int32_t position)
+{
+    int32_t angle = ((position - ARM_HORIZONTAL) * 100) / ARM_COUNTS_PER_10DEG;
+    return (ARM_GRAVITY_POWER * trigCos(angle)) / TRIG_ONE;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Plan a move from the current position to the target            */
+/*-----------------------------------------------------------------------------*/
+static void
+armStartProfile(void)
 {
+    arm.origin = armPosition();
+    profileInit(&arm.profile, arm.target - arm.origin, ARM_VELOCITY, ARM_ACCEL);
+    arm.pid->integral = 0;
+    arm.start = chTimeNow();
+    armSetMode(kArmProfile);
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Set the arm motor                                              */
+/*-----------------------------------------------------------------------------*/
+static void
+armSet(int32_t cmd, bool immediate)
+{
+    cmd = (cmd > 127) ? 127 : ((cmd < -127) ? -127 : cmd);
     SetMotor(arm.motor, cmd, immediate);
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Change the mode of the arm, cancelling a running relay         */
+/*-----------------------------------------------------------------------------*/
+static void
+armSetMode(armMode_t mode)
+{
+    if (arm.mode == kArmTune && mode != kArmTune) {
+        tuneCancel(kTuneArm);
+    }
+    arm.mode = mode;
+    return;
 }
 
 void
@@ -175,5 +282,20 @@ armLock(void)
 void
 armUnlock(void)
 {
+    armSetMode(kArmManual);
     arm.locked = false;
 }
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Hand the arm motor to the autotune relay                       */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Started by tuneStart, the in and out buttons or a preset cancel the
+ *  relay.
+ */
+void
+armTune(void)
+{
+    armSetMode(kArmTune);
+    return;
+}
@@ -0,0 +1,331 @@
+// -*- mode: c; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*-----------------------------------------------------------------------------*/
+/** @file    autonomous/action.c                                               */
+/** @brief   Concurrent actions for the autonomous routines                    */
+/*-----------------------------------------------------------------------------*/
+
+#include "autonomous/action.h"
+#include "autonomous/mode.h"
+#include "autonomous/timer.h"
+
+#define ACTION_NEVER 0xffffffff
+
+typedef struct actionGraph_s {
+    action_t actions[ACTION_MAX]; // the actions of the routine
+    uint8_t count;                // number of actions
+    const scriptOps_t *ops;       // robot operations
+} actionGraph_t;
+
+// storage for action, the autonomous thread does not have the stack for it
+static actionGraph_t actionGraph = {.count = 0, .ops = &scriptRobotOps};
+
+// private functions
+static bool actionConditionMet(const actionCondition_t *condition);
+static uint32_t actionStartTime(const action_t *action);
+static bool actionStep(uint32_t now);
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Remove all actions                                             */
+/*-----------------------------------------------------------------------------*/
+void
+actionReset(void)
+{
+    actionGraph.count = 0;
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Set the robot operations the actions use                       */
+/** @param[in]  ops The robot operations                                       */
+/*-----------------------------------------------------------------------------*/
+void
+actionSetOps(const scriptOps_t *ops)
+{
+    actionGraph.ops = ops;
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Add an action that starts with the routine                     */
+/** @param[in]  mask The ROBOT_* systems to move                               */
+/** @param[in]  a The first argument (drive: rotate)                           */
+/** @param[in]  b The second argument (drive: forward)                         */
+/** @param[in]  duration The run time in ms                                    */
+/** @return     The action or NULL if there is no room left                    */
+/*-----------------------------------------------------------------------------*/
+action_t *
+actionAdd(uint8_t mask, int16_t a, int16_t b, uint16_t duration)
+{
+    action_t *action;
+
+    if (actionGraph.count >= ACTION_MAX) {
+        return NULL;
+    }
+    action = &actionGraph.actions[actionGraph.count++];
+    action->mask = mask;
+    action->a = a;
+    action->b = b;
+    action->stop = true;
+    action->state = kActionWaiting;
+    action->after = NULL;
+    action->delay = 0;
+    action->start.sensor = SCRIPT_SENSOR_NONE;
+    action->until.sensor = SCRIPT_SENSOR_NONE;
+    action->duration = duration;
+    action->started = 0;
+    action->finished = 0;
+    return action;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Start an action after another one has finished                 */
+/** @param[in]  action The action                                              */
+/** @param[in]  after The action to wait for, NULL for the routine start       */
+/** @param[in]  delay Delay after the other action has finished in ms          */
+/*-----------------------------------------------------------------------------*/
+void
+actionAfter(action_t *action, action_t *after, uint16_t delay)
+{
+    if (action == NULL) {
+        return;
+    }
+    action->after = after;
+    action->delay = delay;
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Hold an action back until a sensor condition holds             */
+/** @param[in]  action The action                                              */
+/** @param[in]  sensor The tVexSensors channel                                 */
+/** @param[in]  threshold The sensor threshold                                 */
+/** @param[in]  below true to wait for value <= threshold                      */
+/*-----------------------------------------------------------------------------*/
+void
+actionWhen(action_t *action, uint8_t sensor, int32_t threshold, bool below)
+{
+    if (action == NULL) {
+        return;
+    }
+    action->start.sensor = sensor;
+    action->start.threshold = threshold;
+    action->start.below = below;
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Run an action until a sensor condition holds                   */
+/** @param[in]  action The action                                              */
+/** @param[in]  sensor The tVexSensors channel                                 */
+/** @param[in]  threshold The sensor threshold                                 */
+/** @param[in]  below true to run until value <= threshold                     */
+/** @param[in]  timeout Give up after timeout ms, 0 to wait forever            */
+/*-----------------------------------------------------------------------------*/
+void
+actionUntil(action_t *action, uint8_t sensor, int32_t threshold, bool below, uint16_t timeout)
+{
+    if (action == NULL) {
+        return;
+    }
+    action->until.sensor = sensor;
+    action->until.threshold = threshold;
+    action->until.below = below;
+    action->duration = timeout;
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Leave the systems moving when the action finishes              */
+/** @param[in]  action The action                                              */
+/*-----------------------------------------------------------------------------*/
+void
+actionHold(action_t *action)
+{
+    if (action == NULL) {
+        return;
+    }
+    action->stop = false;
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Run one tick of all actions                                    */
+/** @param[in]  now The time since the routine start in ms                    */
+/** @return     false once every action has finished                          */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Actions that finish on time record their intended finish time, so the
+ *  actions started after them do not drift with the tick.
+ */
+bool
+actionTick(uint32_t now)
+{
+    action_t *action;
+    bool pending = false;
+    uint8_t i;
+
+    // settle chains of actions that start and finish within this tick
+    for (i = 0; i <= actionGraph.count; i++) {
+        if (!actionStep(now)) {
+            break;
+        }
+    }
+
+    for (i = 0; i < actionGraph.count; i++) {
+        action = &actionGraph.actions[i];
+        if (action->state == kActionRunning) {
+            actionGraph.ops->move(action->mask, action->a, action->b);
+        }
+        if (action->state != kActionDone) {
+            pending = true;
+        }
+    }
+
+    return pending;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Time of the next timed start or finish                         */
+/** @param[in]  now The time since the routine start in ms                    */
+/** @return     The time in ms or ACTION_NEVER                                 */
+/*-----------------------------------------------------------------------------*/
+uint32_t
+actionNextEvent(uint32_t now)
+{
+    const action_t *action;
+    uint32_t next = ACTION_NEVER;
+    uint32_t t;
+    uint8_t i;
+
+    for (i = 0; i < actionGraph.count; i++) {
+        action = &actionGraph.actions[i];
+        t = ACTION_NEVER;
+        if (action->state == kActionWaiting && action->start.sensor == SCRIPT_SENSOR_NONE) {
+            t = actionStartTime(action);
+        } else if (action->state == kActionRunning && action->duration != 0) {
+            t = action->started + action->duration;
+        }
+        if (t > now && t < next) {
+            next = t;
+        }
+    }
+    return next;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Run the actions on the robot until they have all finished      */
+/*-----------------------------------------------------------------------------*/
+void
+actionRun(void)
+{
+    ticker_t ticker;
+    uint32_t now;
+    uint32_t next;
+
+    systemUnlockAll();
+
+    tickerInit(&ticker, AUTONOMOUS_TIMER_PERIOD);
+
+    do {
+        now = (uint32_t)((tickerElapsed(&ticker) * 1000) / CH_FREQUENCY);
+        if (!actionTick(now)) {
+            break;
+        }
+        next = actionNextEvent(now);
+        if (next != ACTION_NEVER) {
+            (void)tickerWaitBounded(&ticker, ticker.epoch + MS2ST(next));
+        } else {
+            (void)tickerWait(&ticker);
+        }
+    } while (1);
+
+    timerSync();
+
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Check a sensor condition                                       */
+/*-----------------------------------------------------------------------------*/
+static bool
+actionConditionMet(const actionCondition_t *condition)
+{
+    int32_t value;
+
+    if (condition->sensor == SCRIPT_SENSOR_NONE) {
+        return true;
+    }
+    value = actionGraph.ops->sensor(condition->sensor);
+    return condition->below ? (value <= condition->threshold) : (value >= condition->threshold);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Intended start time of a waiting action                        */
+/*-----------------------------------------------------------------------------*/
+static uint32_t
+actionStartTime(const action_t *action)
+{
+    if (action->after == NULL) {
+        return action->delay;
+    }
+    if (action->after->state != kActionDone) {
+        return ACTION_NEVER;
+    }
+    return action->after->finished + action->delay;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Finish and start actions                                       */
+/** @return     true if any action changed state                               */
+/*-----------------------------------------------------------------------------*/
+static bool
+actionStep(uint32_t now)
+{
+    action_t *action;
+    bool changed = false;
+    uint32_t t;
+    uint8_t i;
+
+    for (i = 0; i < actionGraph.count; i++) {
+        action = &actionGraph.actions[i];
+        if (action->state != kActionRunning) {
+            continue;
+        }
+        t = action->started + action->duration;
+        if (action->until.sensor != SCRIPT_SENSOR_NONE && actionConditionMet(&action->until)) {
+            action->finished = now;
+        } else if ((action->until.sensor == SCRIPT_SENSOR_NONE || action->duration != 0) && now >= t) {
+            action->finished = t;
+        } else {
+            continue;
+        }
+        action->state = kActionDone;
+        if (action->stop) {
+            actionGraph.ops->move(action->mask, 0, 0);
+        }
+#if AUTONOMOUS_TIMER_LOG
+        vex_printf("action: %u done at %lu actual %lu ms\r\n", i, action->finished, now);
+#endif
+        changed = true;
+    }
+
+    for (i = 0; i < actionGraph.count; i++) {
+        action = &actionGraph.actions[i];
+        if (action->state != kActionWaiting) {
+            continue;
+        }
+        t = actionStartTime(action);
+        if (t == ACTION_NEVER || now < t || !actionConditionMet(&action->start)) {
+            continue;
+        }
+        action->started = (action->start.sensor == SCRIPT_SENSOR_NONE) ? t : now;
+        action->state = kActionRunning;
+#if AUTONOMOUS_TIMER_LOG
+        vex_printf("action: %u start at %lu actual %lu ms\r\n", i, action->started, now);
+#endif
+        changed = true;
+    }
+
+    return changed;
+}
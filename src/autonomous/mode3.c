@@ -6,141 +6,86 @@
 /*-----------------------------------------------------------------------------*/
 
 #include "autonomous.h"
+#include "autonomous/action.h"
 #include "autonomous/mode.h"
 
+/**
+ * The same timeline as the timerRun version of this routine, written as
+ * actions so the intake, lift and setter overlap the drive moves instead
+ * of being repeated in every timerRun body.  Each drive move starts after
+ * the one before it, the delays are the old stopMovementOf pauses.
+ */
 void
 autonomousMode3(void)
 {
-    systemUnlockAll();
+    action_t *lift, *flag, *back, *turn, *wall, *grab, *intake, *retreat;
+    action_t *forward, *aim, *spit, *feed, *shoot, *setter;
+    action_t *park;
+
+    actionReset();
+
+    // Shoot Flag
+    lift = actionAdd(ROBOT_LIFT, 127, 0, 2500);
+    actionAfter(lift, NULL, 150);
+
+    // Go forward with Drift/ Hit Low flag
+    flag = actionAdd(ROBOT_DRIVE, 18, 127, 1500);
+    actionAfter(flag, lift, 100);
+
+    // Go back to start
+    back = actionAdd(ROBOT_DRIVE, -12, -127, 1125);
+    actionAfter(back, flag, 50);
+
+    // Turn to hit Cap
+    turn = actionAdd(ROBOT_DRIVE, -100, 0, 350);
+    actionAfter(turn, back, 50);
+
+    // Back against wall
+    wall = actionAdd(ROBOT_DRIVE, 0, -100, 500);
+    actionAfter(wall, turn, 50);
+
+    // Go grab ball under Cap, the intake runs until the turn to shoot
+    grab = actionAdd(ROBOT_DRIVE, 5, 100, 1350);
+    actionAfter(grab, wall, 100);
+    intake = actionAdd(ROBOT_INTAKE, 127, 0, 1350 + 75 + 1500 + 80 + 95 + 50);
+    actionAfter(intake, wall, 100);
+
+    // Come back with the ball
+    retreat = actionAdd(ROBOT_DRIVE, -10, -100, 1500);
+    actionAfter(retreat, grab, 75);
+
+    // Go forward
+    forward = actionAdd(ROBOT_DRIVE, 0, 100, 95);
+    actionAfter(forward, retreat, 80);
+
+    // Turn to shoot
+    aim = actionAdd(ROBOT_DRIVE, 127, 0, 185);
+    actionAfter(aim, forward, 50);
+    spit = actionAdd(ROBOT_INTAKE, -127, 0, 185 + 60);
+    actionAfter(spit, forward, 50);
+
+    // Shoot at medium, the shooter keeps going while the robot backs away
+    feed = actionAdd(ROBOT_INTAKE, 127, 0, 100 + 2500 + 150 + 390 + 100);
+    actionAfter(feed, spit, 0);
+    shoot = actionAdd(ROBOT_LIFT, 127, 0, 2500 + 150 + 390 + 100);
+    actionAfter(shoot, spit, 100);
+    setter = actionAdd(ROBOT_SETTER, 30, 0, 2500 + 150 + 390 + 100);
+    actionAfter(setter, spit, 100);
 
-    {
-        stopMovementOf(ROBOT_ALL, 150);
-
-        // Shoot Flag
-        timerRun(2500, { liftMove(127, true); });
-
-        stopMovementOf(ROBOT_ALL, 100);
-
-        // Go forward with Drift/ Hit Low flag
-        timerRun(1500, {
-            driveMove(18, 127, true);
-            // intakeMove(127, true);
-        });
-
-        stopMovementOf(ROBOT_ALL, 50);
-    }
-    {
-
-        // Go back to start
-        timerRun(1125, {
-            driveMove(-12, -127, true);
-            // intakeMove(127, true);
-        });
-
-        stopMovementOf(ROBOT_DRIVE, 50);
-
-        // Turn to hit Cap
-        timerRun(350, { driveMove(-100, 0, true); });
-
-        stopMovementOf(ROBOT_DRIVE, 50);
-
-        // Back against wall
-        timerRun(500, { driveMove(0, -100, true); });
-
-        stopMovementOf(ROBOT_DRIVE, 50);
-
-        // // Go forward
-        // timerRun(75, {
-        //     driveMove(0, 100, true);
-        // });
-
-        // stopMovementOf(ROBOT_DRIVE, 50);
-
-        // // Back Up
-        // timerRun(150, {
-        //     driveMove(0, -100, true);
-        // });
-
-        stopMovementOf(ROBOT_DRIVE, 50);
-
-        // Go grab ball under Cap
-        timerRun(1350, {
-            driveMove(5, 100, true);
-            intakeMove(127, true);
-        });
-
-        stopMovementOf(ROBOT_DRIVE, 75);
-
-        // Come back with the ball
-        timerRun(1500, {
-            driveMove(-10, -100, true);
-            intakeMove(127, true);
-        });
-
-        // // Go forward
-        // timerRun(75, {
-        //     driveMove(0, 100, true);
-        // });
-
-        // stopMovementOf(ROBOT_DRIVE, 50);
-
-        // // Back Up
-        // timerRun(350, {
-        //     driveMove(0, -90, true);
-        // });
-
-        stopMovementOf(ROBOT_DRIVE, 80);
-
-        // Go forward
-        timerRun(95, { driveMove(0, 100, true); });
-
-        stopMovementOf(ROBOT_DRIVE, 50);
-
-        // Turn to shoot
-        timerRun(185, {
-            driveMove(127, 0, true);
-            intakeMove(-127, true);
-        });
-
-        stopMovementOf(ROBOT_DRIVE, 60);
-
-        timerRun(100, { intakeMove(127, true); });
-
-        // Shoot at medium
-        timerRun(2500, {
-            setterMove(30, true);
-            liftMove(127, true);
-            intakeMove(127, true);
-        });
-    }
     // Park on 6pt
-    {
-        stopMovementOf(ROBOT_DRIVE, 150);
-
-        timerRun(390, { driveMove(25, -127, true); });
-
-        stopMovementOf(ROBOT_DRIVE, 100);
-
-        // timerRun(50, {
-        // liftMove(127, true);
-        // });
-
-        stopMovementOf(ROBOT_ALL, 25);
-
-        timerRun(250, { driveMove(-127, 0, true); });
-
-        stopMovementOf(ROBOT_DRIVE, 25);
-
-        timerRun(250, { driveMove(0, -127, true); });
-
-        stopMovementOf(ROBOT_DRIVE, 100);
-        timerRun(1800, {
-            driveMove(0, 100, true);
-            // liftMove(30, true);
-        });
-
-        stopMovementOf(ROBOT_ALL, 1000);
-    }
+    park = actionAdd(ROBOT_DRIVE, 25, -127, 390);
+    actionAfter(park, spit, 100 + 2500 + 150);
+    turn = actionAdd(ROBOT_DRIVE, -127, 0, 250);
+    actionAfter(turn, park, 100 + 25);
+    back = actionAdd(ROBOT_DRIVE, 0, -127, 250);
+    actionAfter(back, turn, 25);
+    forward = actionAdd(ROBOT_DRIVE, 0, 100, 1800);
+    actionAfter(forward, back, 100);
+
+    actionRun();
+
+    // actionRun resyncs the routine timer, so this step lasts the full 1s
+    stopMovementOf(ROBOT_ALL, 1000);
 
     return;
 }
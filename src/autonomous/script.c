@@ -0,0 +1,297 @@
+// -*- mode: c; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*-----------------------------------------------------------------------------*/
+/** @file    autonomous/script.c                                               */
+/** @brief   Interpreter for autonomous routines stored in flash               */
+/*-----------------------------------------------------------------------------*/
+
+#include "autonomous/script.h"
+#include "autonomous/mode.h"
+#include "autonomous/timer.h"
+#include "sensors.h"
+
+// private functions
+static void scriptBegin(script_t *script, uint32_t now);
+static bool scriptGroup(script_t *script, uint32_t now);
+static void scriptRobotMove(uint8_t mask, int16_t a, int16_t b);
+static int32_t scriptRobotSensor(uint8_t sensor);
+
+// operations on the real robot
+const scriptOps_t scriptRobotOps = {.move = scriptRobotMove, .sensor = scriptRobotSensor};
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the script stored in a slot                                */
+/** @param[in]  slot The script slot                                           */
+/** @return     A pointer to the script header in flash or NULL                */
+/*-----------------------------------------------------------------------------*/
+const scriptHeader_t *
+scriptLoad(uint8_t slot)
+{
+    const scriptHeader_t *header;
+
+    if (slot >= SCRIPT_SLOTS) {
+        return NULL;
+    }
+    header = (const scriptHeader_t *)storageAddress((kStoragePageType)(kStoragePageScript0 + slot));
+    if (header == NULL || header->magic != SCRIPT_MAGIC || header->count == 0) {
+        return NULL;
+    }
+    if ((sizeof(scriptHeader_t) + ((uint32_t)header->count * sizeof(scriptStep_t))) > STORAGE_PAGE_SIZE) {
+        return NULL;
+    }
+    if (scriptChecksum((const scriptStep_t *)(header + 1), header->count) != header->checksum) {
+        return NULL;
+    }
+    return header;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Find the script for an lcd mode                                */
+/** @param[in]  mode The lcd mode                                              */
+/** @param[out] mirror Set to true if the script runs mirrored for this mode   */
+/** @return     A pointer to the script header in flash or NULL                */
+/*-----------------------------------------------------------------------------*/
+const scriptHeader_t *
+scriptFind(uint8_t mode, bool *mirror)
+{
+    const scriptHeader_t *header;
+    uint8_t slot;
+
+    if (mode >= 16) {
+        return NULL;
+    }
+    for (slot = 0; slot < SCRIPT_SLOTS; slot++) {
+        header = scriptLoad(slot);
+        if (header != NULL && (header->modes & (1 << mode)) != 0) {
+            if (mirror != NULL) {
+                *mirror = ((header->mirror & (1 << mode)) != 0);
+            }
+            return header;
+        }
+    }
+    return NULL;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Fletcher-16 checksum of the steps of a script                  */
+/** @param[in]  steps The steps                                                */
+/** @param[in]  count The number of steps                                      */
+/** @return     The checksum                                                   */
+/*-----------------------------------------------------------------------------*/
+uint16_t
+scriptChecksum(const scriptStep_t *steps, uint16_t count)
+{
+    const uint8_t *p = (const uint8_t *)steps;
+    uint32_t len = (uint32_t)count * sizeof(scriptStep_t);
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+
+    while (len-- > 0) {
+        sum1 = (sum1 + *p++) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return (uint16_t)((sum2 << 8) | sum1);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Prepare a script to run                                        */
+/** @param[in]  script The interpreter state                                   */
+/** @param[in]  header The script                                              */
+/** @param[in]  mirror true to run the script mirrored                         */
+/** @param[in]  ops The robot operations                                       */
+/** @param[in]  now The current time in ms                                    */
+/*-----------------------------------------------------------------------------*/
+void
+scriptInit(script_t *script, const scriptHeader_t *header, bool mirror, const scriptOps_t *ops, uint32_t now)
+{
+    script->steps = (const scriptStep_t *)(header + 1);
+    script->count = header->count;
+    script->mirror = mirror;
+    script->ops = ops;
+    script->pc = 0;
+    script->running = true;
+    scriptBegin(script, now);
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Run one tick of a script                                       */
+/** @param[in]  script The interpreter state                                   */
+/** @param[in]  now The current time in ms                                    */
+/** @return     false once the script has ended                               */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  A group that finishes on time hands its intended end time to the next
+ *  group, so timed steps do not drift with the tick.  Groups that finish
+ *  within the same tick are run back to back.
+ */
+bool
+scriptTick(script_t *script, uint32_t now)
+{
+    while (script->running && scriptGroup(script, now)) {
+        script->pc = script->end;
+        scriptBegin(script, script->timed ? (script->start + script->length) : now);
+    }
+    return script->running;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Run a script on the robot until it ends                        */
+/** @param[in]  header The script                                              */
+/** @param[in]  mirror true to run the script mirrored                         */
+/*-----------------------------------------------------------------------------*/
+void
+scriptRun(const scriptHeader_t *header, bool mirror)
+{
+    script_t script;
+    ticker_t ticker;
+    uint32_t now;
+    uint16_t pc;
+
+    systemUnlockAll();
+
+    tickerInit(&ticker, AUTONOMOUS_TIMER_PERIOD);
+    scriptInit(&script, header, mirror, &scriptRobotOps, 0);
+
+    do {
+        pc = script.pc;
+        now = (uint32_t)((tickerElapsed(&ticker) * 1000) / CH_FREQUENCY);
+        if (!scriptTick(&script, now)) {
+            break;
+        }
+#if AUTONOMOUS_TIMER_LOG
+        if (script.pc != pc) {
+            vex_printf("script: step %u intended %lu actual %lu ms\r\n", script.pc, script.start, now);
+        }
+#endif
+        if (script.timed && (script.start + script.length) > now) {
+            (void)tickerWaitBounded(&ticker, ticker.epoch + MS2ST(script.start + script.length));
+        } else {
+            (void)tickerWait(&ticker);
+        }
+    } while (1);
+
+    timerSync();
+
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Start the group of steps at the program counter                */
+/*-----------------------------------------------------------------------------*/
+static void
+scriptBegin(script_t *script, uint32_t now)
+{
+    const scriptStep_t *step;
+
+    script->end = script->pc;
+    script->done = 0;
+    script->timed = true;
+    script->start = now;
+    script->length = 0;
+
+    if (script->pc >= script->count || script->steps[script->pc].op == SCRIPT_OP_END) {
+        script->ops->move(ROBOT_ALL, 0, 0);
+        script->running = false;
+        return;
+    }
+
+    do {
+        step = &script->steps[script->end++];
+        if (step->duration > script->length) {
+            script->length = step->duration;
+        }
+    } while ((step->flags & SCRIPT_FLAG_WITH_NEXT) != 0 && script->end < script->count &&
+             (script->end - script->pc) < SCRIPT_GROUP_MAX && script->steps[script->end].op != SCRIPT_OP_END);
+
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Run the steps of the current group                             */
+/** @return     true once every step of the group has finished                 */
+/*-----------------------------------------------------------------------------*/
+static bool
+scriptGroup(script_t *script, uint32_t now)
+{
+    const scriptStep_t *step;
+    uint32_t elapsed = now - script->start;
+    uint8_t all = (uint8_t)((1 << (script->end - script->pc)) - 1);
+    uint8_t bit;
+    uint16_t i;
+    int16_t a;
+    int32_t value;
+
+    for (i = script->pc; i < script->end; i++) {
+        bit = (uint8_t)(1 << (i - script->pc));
+        if ((script->done & bit) != 0) {
+            continue;
+        }
+        step = &script->steps[i];
+
+        switch (step->op) {
+        case SCRIPT_OP_MOVE:
+            a = step->a;
+            if (script->mirror && (step->flags & SCRIPT_FLAG_MIRROR) != 0) {
+                a = -a;
+            }
+            script->ops->move(step->mask, a, step->b);
+            break;
+        case SCRIPT_OP_STOP:
+            script->ops->move(step->mask, 0, 0);
+            break;
+        default:
+            break;
+        }
+
+        if (step->sensor != SCRIPT_SENSOR_NONE) {
+            value = script->ops->sensor(step->sensor);
+            if ((step->flags & SCRIPT_FLAG_BELOW) ? (value <= step->threshold) : (value >= step->threshold)) {
+                script->done |= bit;
+                script->timed = false;
+            } else if (step->duration != 0 && elapsed >= step->duration) {
+                script->done |= bit;
+            }
+        } else if (elapsed >= step->duration) {
+            script->done |= bit;
+        }
+    }
+
+    return (script->done == all);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Move the systems in mask                                       */
+/*-----------------------------------------------------------------------------*/
+static void
+scriptRobotMove(uint8_t mask, int16_t a, int16_t b)
+{
+    if (mask & ROBOT_ARM) {
+        armMove(a, true);
+    }
+    if (mask & ROBOT_DRIVE) {
+        driveMove(a, b, true);
+    }
+    if (mask & ROBOT_INTAKE) {
+        intakeMove(a, true);
+    }
+    if (mask & ROBOT_FLIPPER) {
+        flipperMove(a, true);
+    }
+    if (mask & ROBOT_LIFT) {
+        liftMove(a, true);
+    }
+    if (mask & ROBOT_SETTER) {
+        setterMove(a, true);
+    }
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Read a sensor                                                  */
+/*-----------------------------------------------------------------------------*/
+static int32_t
+scriptRobotSensor(uint8_t sensor)
+{
+    return sensorsValue(sensorsGet(), (tVexSensors)sensor);
+}
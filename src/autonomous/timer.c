@@ -0,0 +1,141 @@
+// -*- mode: c; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*-----------------------------------------------------------------------------*/
+/** @file    autonomous/timer.c                                                */
+/** @brief   Drift free step timer for the autonomous routines                 */
+/*-----------------------------------------------------------------------------*/
+
+#include "autonomous/timer.h"
+
+// storage for timer
+static autonomousTimer_t autonomousTimer = {.running = false, .intended = 0, .start = 0, .step = 0};
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Start the routine epoch                                        */
+/** @param[in]  period The period of the timerRun loop in ms                   */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Should be called right before an autonomous routine is started, all
+ *  step durations are measured from this point.
+ */
+void
+timerReset(unsigned long period)
+{
+    tickerInit(&autonomousTimer.ticker, period);
+    autonomousTimer.running = true;
+    autonomousTimer.intended = 0;
+    autonomousTimer.start = 0;
+    autonomousTimer.step = 0;
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Start a new step                                               */
+/** @param[in]  target The duration of the step in ms                         */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The step ends at the intended end of the previous step plus target, not
+ *  at the current time plus target.
+ */
+void
+timerSetTimeout(unsigned long target)
+{
+    if (!autonomousTimer.running) {
+        timerReset(AUTONOMOUS_TIMER_PERIOD);
+    }
+    autonomousTimer.start = autonomousTimer.intended;
+    autonomousTimer.intended += target;
+    autonomousTimer.step++;
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Catch the routine up after a blocking move                     */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  actionRun, scriptRun and the closed loop drive moves run on their own
+ *  ticker.  They call this when they return, so the next step starts from
+ *  the current time and is not shortened or skipped by the time they took.
+ */
+void
+timerSync(void)
+{
+    unsigned long elapsed;
+
+    if (!autonomousTimer.running) {
+        return;
+    }
+    elapsed = timerElapsed();
+    if (elapsed > autonomousTimer.intended) {
+        autonomousTimer.intended = elapsed;
+    }
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      End the current step before its timeout                        */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  For steps that wait on a sensor, the timeout is then only an upper
+ *  bound.  The next step starts from the current time.
+ */
+void
+timerEnd(void)
+{
+    unsigned long elapsed;
+
+    if (!autonomousTimer.running) {
+        return;
+    }
+    elapsed = timerElapsed();
+    if (elapsed < autonomousTimer.intended) {
+        autonomousTimer.intended = elapsed;
+    }
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Check if the current step is still running                     */
+/** @return     true until the intended end of the step has been reached       */
+/*-----------------------------------------------------------------------------*/
+bool
+timerIsActive(void)
+{
+    systime_t end = autonomousTimer.ticker.epoch + MS2ST(autonomousTimer.intended);
+
+    if ((int32_t)(end - chTimeNow()) > 0) {
+        return true;
+    }
+
+#if AUTONOMOUS_TIMER_LOG
+    vex_printf("timer: step %lu intended %lu-%lu actual %lu ms (%lu overruns, %lu ms late)\r\n", autonomousTimer.step,
+               autonomousTimer.start, autonomousTimer.intended, timerElapsed(), autonomousTimer.ticker.overruns,
+               (unsigned long)autonomousTimer.ticker.late);
+#endif
+
+    return false;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Wait for the next period of the current step                   */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The last period of a step is cut short so that the step ends exactly at
+ *  its intended time.
+ */
+void
+timerTick(void)
+{
+    (void)tickerWaitBounded(&autonomousTimer.ticker, autonomousTimer.ticker.epoch + MS2ST(autonomousTimer.intended));
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Time since the routine epoch                                   */
+/** @return     The elapsed time in ms                                         */
+/*-----------------------------------------------------------------------------*/
+unsigned long
+timerElapsed(void)
+{
+    return (unsigned long)((tickerElapsed(&autonomousTimer.ticker) * 1000) / CH_FREQUENCY);
+}
@@ -0,0 +1,50 @@
+// -*- mode: c; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*-----------------------------------------------------------------------------*/
+/** @file    curve.c                                                           */
+/** @brief   Response curves shared by all systems                             */
+/*-----------------------------------------------------------------------------*/
+
+#include "curve.h"
+
+#include <stdlib.h>
+
+// storage for curve tables, generated from the parameters in curve.h
+static const int8_t curveTables[kCurveNumber][CURVE_SIZE] = {
+    CURVE_TABLE(LINEAR),
+    CURVE_TABLE(STANDARD),
+};
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Map a command through a response curve                         */
+/** @param[in]  curve The curve to use                                         */
+/** @param[in]  command The command, limited to -127 to 127                    */
+/** @return     The motor value with the sign of the command                   */
+/*-----------------------------------------------------------------------------*/
+int
+curveApply(curveName_t curve, int command)
+{
+    if (command > 127) {
+        command = 127;
+    } else if (command < -127) {
+        command = -127;
+    }
+    if ((unsigned int)curve >= kCurveNumber) {
+        return command;
+    }
+    return (((command > 0) - (command < 0)) * curveTables[curve][abs(command)]);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the table of a response curve                              */
+/** @param[in]  curve The curve                                                */
+/** @return     A pointer to CURVE_SIZE entries, NULL for an unknown curve     */
+/*-----------------------------------------------------------------------------*/
+const int8_t *
+curveGetTable(curveName_t curve)
+{
+    if ((unsigned int)curve >= kCurveNumber) {
+        return NULL;
+    }
+    return curveTables[curve];
+}
@@ -6,53 +6,35 @@
 /*-----------------------------------------------------------------------------*/
 
 #include "drive.h"
+#include "curve.h"
+#include "joystick.h"
+#include "system.h"
+#include "ticker.h"
+#include "trig.h"
+#include "autonomous/timer.h"
 #include <math.h>
 #include <stdlib.h>
 
 // storage for drive
 static drive_t drive;
 
-// working area for drive task
-static WORKING_AREA(waDrive, 512);
-
 // private functions
-static msg_t driveThread(void *arg);
-
-// drive speed adjustment
-#define USE_DRIVE_SPEED_TABLE 1
-#ifdef USE_DRIVE_SPEED_TABLE
-
-const unsigned int driveSpeedTable[128] = {0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  21, 21, 21, 22, 22,  22,  23, 24, 24, 25, 25,
-                                           25, 25, 26, 27, 27, 28, 28, 28, 28, 29, 30, 30, 30, 31, 31, 32,  32,  32, 33, 33, 34, 34,
-                                           35, 35, 35, 36, 36, 37, 37, 37, 37, 38, 38, 39, 39, 39, 40, 40,  41,  41, 42, 42, 43, 44,
-                                           44, 45, 45, 46, 46, 47, 47, 48, 48, 49, 50, 50, 51, 52, 52, 53,  54,  55, 56, 57, 57, 58,
-                                           59, 60, 61, 62, 63, 64, 65, 66, 67, 67, 68, 70, 71, 72, 72, 73,  74,  76, 77, 78, 79, 79,
-                                           80, 81, 83, 84, 84, 86, 86, 87, 87, 88, 88, 89, 89, 90, 90, 127, 127, 127};
+static void drivePlan(profile_t *profile, int32_t ticks, int32_t heading);
+static bool driveFollow(int32_t ticks, int32_t heading);
+static void driveSet(int16_t x, int16_t y);
+static void driveCommit(const int16_t wheels[4], bool immediate);
 
-static inline int
-driveSpeed(int speed)
-{
-    if (speed > 127)
-        speed = 127;
-    else if (speed < -127)
-        speed = -127;
-    return (((speed > 0) - (speed < 0)) * driveSpeedTable[abs(speed)]);
-}
-
-#else
+// drive response curve
+#ifndef DRIVE_CURVE
+#define DRIVE_CURVE kCurveStandard
+#endif
 
 static inline int
 driveSpeed(int speed)
 {
-    if (speed > 127)
-        speed = 127;
-    else if (speed < -127)
-        speed = -127;
-    return (speed);
+    return curveApply(DRIVE_CURVE, speed);
 }
 
-#endif
-
 /*-----------------------------------------------------------------------------*/
 /** @brief      Get pointer to drive structure - not used locally              */
 /** @return     A drive_t pointer                                              */
@@ -87,18 +69,23 @@ driveSetup(tVexMotor northeast, tVexMotor northwest, tVexMotor southeast, tVexMo
 void
 driveInit(void)
 {
+    int i;
+
+    // gains in command per count, per count second and per count/s, the
+    // same loops as 0.01, 0.0005, 0.02 and 0.004, 0, 0.01 in the float
+    // controller run every DRIVE_CONTROL_PERIOD
+    PidFixedControllerInit(&drive.pids[DRIVE_PID_DISTANCE], PIDLIB_FIX(1.27), PIDLIB_FIX(6.35), PIDLIB_FIX(0.0254),
+                           DRIVE_PID_DISTANCE);
+    PidFixedControllerInit(&drive.pids[DRIVE_PID_HEADING], PIDLIB_FIX(0.508), 0, PIDLIB_FIX(0.0127), DRIVE_PID_HEADING);
     // SmartMotorLinkMotors(drive.southeast, drive.northeast);
     // SmartMotorLinkMotors(drive.southwest, drive.northwest);
-    return;
-}
-
-/*-----------------------------------------------------------------------------*/
-/** @brief      Start the drive system thread                                  */
-/*-----------------------------------------------------------------------------*/
-void
-driveStart(void)
-{
-    chThdCreateStatic(waDrive, sizeof(waDrive), NORMALPRIO - 1, driveThread, NULL);
+    drive.fieldCentric = DRIVE_FIELD_CENTRIC;
+    drive.fieldHeading = 0;
+    drive.shaping = (DRIVE_SHAPE_ACCEL > 0);
+    for (i = 0; i < 4; i++) {
+        shaperInit(&drive.shapers[i], DRIVE_SHAPE_ACCEL, DRIVE_SHAPE_DECEL, DRIVE_SHAPE_JERK);
+    }
+    drive.shaped = chTimeNow();
     return;
 }
 
@@ -109,65 +96,411 @@ maybeImmediate(void)
 }
 
 /*-----------------------------------------------------------------------------*/
-/** @brief      The drive system thread                                        */
-/** @param[in]  arg Unused                                                     */
-/** @return     (msg_t) 0                                                      */
+/** @brief      Run one control step of the drive system                      */
 /*-----------------------------------------------------------------------------*/
-static msg_t
-driveThread(void *arg)
+/** @details
+ *  The left stick drives forward and turns, the right stick strafes.  Slow
+ *  mode and the rest of the stick shaping come from the joystick profile.
+ *  7U turns field centric driving on with the robot facing the field
+ *  forward at that moment, 7D turns it off again.  The wheels are set
+ *  straight away, with shaping turned on by driveSetShaping each wheel is
+ *  shaped first.
+ */
+void
+driveStep(void)
 {
     int16_t driveX = 0;
     int16_t driveY = 0;
+    int16_t driveR = 0;
+    int32_t heading;
+    int32_t s;
+    int32_t c;
+    int32_t x;
+    int16_t wheels[4];
+    uint32_t dt;
+    int i;
 
-    // Unused
-    (void)arg;
-
-    // Register the task
-    vexTaskRegister("drive");
-
-    while (!chThdShouldTerminate()) {
-        // if (vexControllerGet(Btn5UXmtr2)) {
-        //         driveX = vexControllerGet(Ch4Xmtr2);
-        //         driveY = vexControllerGet(Ch3Xmtr2);
-        // }
-        if (drive.locked) {
-            // driveX = 0;
-            // driveY = 0;
-            driveX = vexControllerGet(Ch4);
-            driveY = vexControllerGet(Ch3);
-            if (vexControllerGet(Btn5U)) {
-                if (abs(driveX) > 64) {
-                    driveX = ((driveX >= 0) ? 1 : -1) * 64;
-                }
-                if (abs(driveY) > 64) {
-                    driveY = ((driveY >= 0) ? 1 : -1) * 64;
-                }
-            }
-            driveX = driveSpeed(driveX);
-            driveY = driveSpeed(driveY);
-            driveMove(driveX, driveY, maybeImmediate());
+    if (drive.locked) {
+        if (systemControllerGet(Btn7U) && !drive.fieldCentric) {
+            driveSetFieldCentric(true);
+        } else if (systemControllerGet(Btn7D)) {
+            driveSetFieldCentric(false);
         }
 
-        // Don't hog cpu
-        vexSleep(25);
+        driveX = joystickGet(Ch1);
+        driveY = joystickGet(Ch3);
+        driveR = joystickGet(Ch4);
+        driveX = driveSpeed(driveX);
+        driveY = driveSpeed(driveY);
+        driveR = driveSpeed(driveR);
+
+        if (drive.fieldCentric) {
+            // turn the field vector into the robot frame, heading is clockwise
+            heading = driveHeading() - drive.fieldHeading;
+            s = trigSin(heading);
+            c = trigCos(heading);
+            x = (driveX * c - driveY * s) / TRIG_ONE;
+            driveY = (int16_t)((driveX * s + driveY * c) / TRIG_ONE);
+            driveX = (int16_t)x;
+        }
+
+        dt = (uint32_t)((chTimeElapsedSince(drive.shaped) * 1000) / CH_FREQUENCY);
+        drive.shaped = chTimeNow();
+
+        // the response curve goes on each wheel after mixing as well, as
+        // driveMove does, so tank driving feels the same as before strafing
+        driveMix(driveX, driveY, driveR, wheels);
+        for (i = 0; i < 4; i++) {
+            wheels[i] = driveSpeed(wheels[i]);
+            if (drive.shaping) {
+                wheels[i] = shaperStep(&drive.shapers[i], wheels[i], dt);
+            } else {
+                shaperReset(&drive.shapers[i], wheels[i]);
+            }
+        }
+        driveCommit(wheels, maybeImmediate());
     }
 
-    return ((msg_t)0);
+    return;
 }
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      Drive forward and turn through the drive response curve        */
+/** @param[in]  x The turn command, positive turns clockwise                   */
+/** @param[in]  y The forward command                                          */
+/** @param[in]  immediate Bypass the motor slew rate                           */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Each side is clamped on its own and not scaled with the other as
+ *  driveMix does, the autonomous routines were timed with this.
+ */
 void
 driveMove(int16_t x, int16_t y, bool immediate)
 {
-    SetMotor(drive.northeast, driveSpeed(y - x), immediate);
-    SetMotor(drive.northwest, driveSpeed(y + x), immediate);
-    SetMotor(drive.southeast, driveSpeed(y - x), immediate);
-    SetMotor(drive.southwest, driveSpeed(y + x), immediate);
+    int16_t wheels[4];
+
+    wheels[0] = wheels[2] = driveSpeed(y - x);
+    wheels[1] = wheels[3] = driveSpeed(y + x);
+    driveCommit(wheels, immediate);
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Drive in any direction while turning                           */
+/** @param[in]  x The strafe command, positive moves right                     */
+/** @param[in]  y The forward command                                          */
+/** @param[in]  r The turn command, positive turns clockwise                   */
+/** @param[in]  immediate Bypass the motor slew rate                           */
+/*-----------------------------------------------------------------------------*/
+void
+driveHolonomic(int16_t x, int16_t y, int16_t r, bool immediate)
+{
+    int16_t wheels[4];
+
+    driveMix(x, y, r, wheels);
+    driveCommit(wheels, immediate);
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Mix strafe, forward and turn commands for the X-drive          */
+/** @param[in]  x The strafe command, positive moves right                     */
+/** @param[in]  y The forward command                                          */
+/** @param[in]  r The turn command, positive turns clockwise                   */
+/** @param[out] wheels Northeast, northwest, southeast and southwest wheels    */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  When a wheel would go past full power all four are scaled down by the
+ *  same amount, so the robot still moves in the direction asked for.
+ */
+void
+driveMix(int16_t x, int16_t y, int16_t r, int16_t wheels[4])
+{
+    int32_t mix[4];
+    int32_t peak = 127;
+    int i;
+
+    mix[0] = (int32_t)y - x - r;
+    mix[1] = (int32_t)y + x + r;
+    mix[2] = (int32_t)y + x - r;
+    mix[3] = (int32_t)y - x + r;
+
+    for (i = 0; i < 4; i++) {
+        if (abs(mix[i]) > peak) {
+            peak = abs(mix[i]);
+        }
+    }
+    for (i = 0; i < 4; i++) {
+        wheels[i] = (int16_t)((mix[i] * 127) / peak);
+    }
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Turn field centric driving on or off                           */
+/** @param[in]  enabled true to turn it on, the current heading is forward     */
+/*-----------------------------------------------------------------------------*/
+void
+driveSetFieldCentric(bool enabled)
+{
+    if (enabled) {
+        drive.fieldHeading = driveHeading();
+    }
+    drive.fieldCentric = enabled;
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Change the shaping of the driver commands                      */
+/** @param[in]  accel The rate in counts/s while a wheel speeds up, 0 for none */
+/** @param[in]  decel The rate in counts/s while a wheel slows or reverses     */
+/** @param[in]  jerk The change of rate in counts/s^2, 0 for no limit          */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The drive is not shaped unless this turns it on.  For example 600, 1500
+ *  and 6000 take a wheel from 0 to full in about 280 ms.
+ */
+void
+driveSetShaping(int32_t accel, int32_t decel, int32_t jerk)
+{
+    int i;
+
+    drive.shaping = (accel > 0);
+    for (i = 0; i < 4; i++) {
+        shaperSet(&drive.shapers[i], accel, decel, jerk);
+    }
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the heading of the robot                                   */
+/** @return     The clockwise heading in deg * 10                              */
+/*-----------------------------------------------------------------------------*/
+int32_t
+driveHeading(void)
+{
+#if DRIVE_GYRO_REVERSED
+    return -vexGyroGet();
+#else
+    return vexGyroGet();
+#endif
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Drive straight, holding the current heading                    */
+/** @param[in]  inches The distance to drive, negative to drive backwards      */
+/** @return     true if the move settled, false if it timed out                */
+/*-----------------------------------------------------------------------------*/
+bool
+driveDistance(int16_t inches)
+{
+    return driveFollow((int32_t)inches * DRIVE_TICKS_PER_INCH, 0);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Turn on the spot                                               */
+/** @param[in]  degrees The angle to turn, positive turns clockwise            */
+/** @return     true if the move settled, false if it timed out                */
+/*-----------------------------------------------------------------------------*/
+bool
+driveTurnDegrees(int16_t degrees)
+{
+    return driveFollow(0, (int32_t)degrees * 10);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Drive along an arc                                             */
+/** @param[in]  radius The radius of the arc in inches, negative drives back   */
+/** @param[in]  degrees The change of heading, positive turns clockwise        */
+/** @return     true if the move settled, false if it timed out                */
+/*-----------------------------------------------------------------------------*/
+bool
+driveArc(int16_t radius, int16_t degrees)
+{
+    // arc length is radius * angle in radians, 1144 / 65536 is pi / 180
+    int32_t ticks = (int32_t)(((int64_t)radius * DRIVE_TICKS_PER_INCH * abs(degrees) * 1144) >> 16);
+    return driveFollow(ticks, (int32_t)degrees * 10);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Plan the profile of a closed loop move                         */
+/** @param[out] profile The profile                                           */
+/** @param[in]  ticks The distance in encoder ticks, 0 to turn on the spot     */
+/** @param[in]  heading The change of heading in deg * 10                      */
+/*-----------------------------------------------------------------------------*/
+static void
+drivePlan(profile_t *profile, int32_t ticks, int32_t heading)
+{
+    int64_t outer;
+
+    if (ticks == 0) {
+        profileInit(profile, heading, DRIVE_TURN_RATE, DRIVE_TURN_ACCEL);
+        return;
+    }
+
+    // on an arc the outer wheels run faster than the middle of the robot,
+    // slow the profile so they stay at DRIVE_VELOCITY and within full power
+    outer = (int64_t)abs(ticks) * DRIVE_MAX_TURN_RATE;
+    outer = (outer * 1024) / (outer + (int64_t)abs(heading) * DRIVE_MAX_VELOCITY);
+    profileInit(profile, ticks, (int32_t)((DRIVE_VELOCITY * outer) / 1024), (int32_t)((DRIVE_ACCEL * outer) / 1024));
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Follow a profiled move until it settles                        */
+/** @param[in]  ticks The distance in encoder ticks                            */
+/** @param[in]  heading The change of heading in deg * 10                      */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The profile is planned on the distance, the heading target follows the
+ *  distance so arcs stay in step.  Turns on the spot are planned on the
+ *  heading.  The profile velocity DRIVE_FEED_LEAD ms ahead is fed forward
+ *  with DRIVE_FEED_STATIC to overcome friction, scaled by the battery
+ *  voltage, and the PID loops correct the remaining error.
+ */
+static bool
+driveFollow(int32_t ticks, int32_t heading)
+{
+    profile_t profile;
+    ticker_t ticker;
+    int32_t encoder = vexEncoderGet(DRIVE_ENCODER);
+    int32_t gyro = driveHeading();
+    int32_t battery;
+    int32_t position;
+    int32_t velocity;
+    int32_t distanceTarget;
+    int32_t headingTarget;
+    int32_t distanceError;
+    int32_t headingError;
+    int32_t forward;
+    int32_t turn;
+    int32_t snapshot[DRIVE_PID_NUM];
+    uint32_t t;
+    uint32_t last = 0;
+    uint32_t settled = 0;
+    bool turning = (ticks == 0);
+
+    drivePlan(&profile, ticks, heading);
+
+    // the controllers are shared by every move, start each one clean so
+    // it does not inherit the integral or the last error of the one before
+    PidFixedControllerReset(&drive.pids[DRIVE_PID_DISTANCE]);
+    PidFixedControllerReset(&drive.pids[DRIVE_PID_HEADING]);
+
+    tickerInit(&ticker, DRIVE_CONTROL_PERIOD);
+
+    do {
+        t = (uint32_t)((tickerElapsed(&ticker) * 1000) / CH_FREQUENCY);
+        profileAt(&profile, t, &position, NULL);
+        // the robot lags the command, so feed forward the velocity it needs a little ahead
+        profileAt(&profile, t + DRIVE_FEED_LEAD, NULL, &velocity);
+
+        if (turning) {
+            distanceTarget = 0;
+            headingTarget = position;
+            forward = 0;
+            turn = (velocity * 127) / DRIVE_MAX_TURN_RATE;
+        } else {
+            distanceTarget = position;
+            headingTarget = (int32_t)(((int64_t)heading * position) / ticks);
+            forward = (velocity * 127) / DRIVE_MAX_VELOCITY;
+            turn = (int32_t)(((int64_t)heading * velocity * 127) / ((int64_t)ticks * DRIVE_MAX_TURN_RATE));
+        }
+        if (velocity != 0) {
+            if (turning) {
+                turn += (velocity > 0) ? DRIVE_FEED_STATIC : -DRIVE_FEED_STATIC;
+            } else {
+                forward += (velocity > 0) ? DRIVE_FEED_STATIC : -DRIVE_FEED_STATIC;
+            }
+        }
+
+        // motors slow down with the battery, 7.2V is nominal
+        battery = (int32_t)vexSpiGetMainBattery();
+        if (battery > 5000) {
+            forward = (forward * 7200) / battery;
+            turn = (turn * 7200) / battery;
+        }
+
+        distanceError = distanceTarget - (vexEncoderGet(DRIVE_ENCODER) - encoder);
+        headingError = headingTarget - (driveHeading() - gyro);
+
+        // the loops hold the tracking error at 0, so the derivative acts on
+        // the error and not on the profile velocity the feed forward covers
+        snapshot[DRIVE_PID_DISTANCE] = -distanceError;
+        snapshot[DRIVE_PID_HEADING] = -headingError;
+        PidFixedBankUpdate(drive.pids, DRIVE_PID_NUM, snapshot, (int32_t)(t - last));
+        last = t;
+        forward += drive.pids[DRIVE_PID_DISTANCE].drive_cmd;
+        turn += drive.pids[DRIVE_PID_HEADING].drive_cmd;
+
+        driveSet((int16_t)turn, (int16_t)forward);
+
+        if (t >= profile.total && abs(distanceError) <= DRIVE_SETTLE_TICKS && abs(headingError) <= DRIVE_SETTLE_HEADING) {
+            settled += DRIVE_CONTROL_PERIOD;
+        } else {
+            settled = 0;
+        }
+        if (settled >= DRIVE_SETTLE_TIME || t >= (profile.total + DRIVE_SETTLE_TIMEOUT)) {
+            break;
+        }
+
+        (void)tickerWait(&ticker);
+    } while (!chThdShouldTerminate());
+
+    driveSet(0, 0);
+    timerSync();
+
+    return (settled >= DRIVE_SETTLE_TIME);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Set the drive motors without the driver speed table            */
+/*-----------------------------------------------------------------------------*/
+static void
+driveSet(int16_t x, int16_t y)
+{
+    int16_t wheels[4];
+    int16_t left = y + x;
+    int16_t right = y - x;
+
+    left = (left > 127) ? 127 : ((left < -127) ? -127 : left);
+    right = (right > 127) ? 127 : ((right < -127) ? -127 : right);
+
+    wheels[0] = right;
+    wheels[1] = left;
+    wheels[2] = right;
+    wheels[3] = left;
+    driveCommit(wheels, true);
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Set all four drive motors together                             */
+/** @param[in]  wheels Northeast, northwest, southeast and southwest wheels    */
+/** @param[in]  immediate Bypass the motor slew rate                           */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The wheels are committed as a group so they all change in the same SPI
+ *  frame, a wheel that is a frame behind the others makes the robot twitch.
+ */
+static void
+driveCommit(const int16_t wheels[4], bool immediate)
+{
+    const int16_t motors[4] = {drive.northeast, drive.northwest, drive.southeast, drive.southwest};
+
+    SetMotorGroup(4, motors, wheels, immediate);
     return;
 }
 
 void
 driveLock(void)
 {
+    // pick up from whatever autonomous left the wheels at
+    shaperReset(&drive.shapers[0], vexMotorGet(drive.northeast));
+    shaperReset(&drive.shapers[1], vexMotorGet(drive.northwest));
+    shaperReset(&drive.shapers[2], vexMotorGet(drive.southeast));
+    shaperReset(&drive.shapers[3], vexMotorGet(drive.southwest));
+    drive.shaped = chTimeNow();
     drive.locked = true;
 }
 
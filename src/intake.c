@@ -6,6 +6,8 @@
 /*-----------------------------------------------------------------------------*/
 
 #include "intake.h"
+#include "curve.h"
+#include "system.h"
 
 #include <math.h>
 #include <stdlib.h>
@@ -13,47 +15,15 @@
 // storage for intake
 static intake_t intake;
 
-// working area for intake task
-static WORKING_AREA(waIntake, 512);
-
-// private functions
-static msg_t intakeThread(void *arg);
-
-// intake speed adjustment
-#define USE_INTAKE_SPEED_TABLE 1
-#ifdef USE_INTAKE_SPEED_TABLE
-
-const unsigned int intakeSpeedTable[128] = {
-    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  21, 21, 21, 22, 22, 22, 23, 24, 24, 25, 25,  25,  25, 26, 27,
-    27, 28, 28, 28, 28, 29, 30, 30, 30, 31, 31, 32, 32, 32, 33, 33, 34, 34, 35, 35, 35, 36,  36,  37, 37, 37,
-    37, 38, 38, 39, 39, 39, 40, 40, 41, 41, 42, 42, 43, 44, 44, 45, 45, 46, 46, 47, 47, 48,  48,  49, 50, 50,
-    51, 52, 52, 53, 54, 55, 56, 57, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 67, 68, 70,  71,  72, 72, 73,
-    74, 76, 77, 78, 79, 79, 80, 81, 83, 84, 84, 86, 86, 87, 87, 88, 88, 89, 89, 90, 90, 127, 127, 127};
-
-static inline int
-intakeSpeed(int speed)
-{
-    if (speed > 127)
-        speed = 127;
-    else if (speed < -127)
-        speed = -127;
-    return (((speed > 0) - (speed < 0)) * intakeSpeedTable[abs(speed)]);
-}
-
-#else
+// intake response curve
+#define INTAKE_CURVE kCurveStandard
 
 static inline int
 intakeSpeed(int speed)
 {
-    if (speed > 127)
-        speed = 127;
-    else if (speed < -127)
-        speed = -127;
-    return (speed);
+    return curveApply(INTAKE_CURVE, speed);
 }
 
-#endif
-
 /*-----------------------------------------------------------------------------*/
 /** @brief      Get pointer to intake structure - not used locally             */
 /** @return     A intake_t pointer                                             */
@@ -85,16 +55,6 @@ intakeInit(void)
     return;
 }
 
-/*-----------------------------------------------------------------------------*/
-/** @brief      Start the intake system thread                                 */
-/*-----------------------------------------------------------------------------*/
-void
-intakeStart(void)
-{
-    chThdCreateStatic(waIntake, sizeof(waIntake), NORMALPRIO - 1, intakeThread, NULL);
-    return;
-}
-
 static inline int
 limitSpeed(int speed, int limit)
 {
@@ -105,48 +65,35 @@ limitSpeed(int speed, int limit)
 }
 
 /*-----------------------------------------------------------------------------*/
-/** @brief      The intake system thread                                       */
-/** @param[in]  arg Unused                                                     */
-/** @return     (msg_t) 0                                                      */
+/** @brief      Run one control step of the intake system                     */
 /*-----------------------------------------------------------------------------*/
-static msg_t
-intakeThread(void *arg)
+void
+intakeStep(void)
 {
     bool buttonIn = false;
     bool buttonOut = false;
     int16_t intakeCmd = 0;
     bool immediate = false;
 
-    // Unused
-    (void)arg;
-
-    // Register the task
-    vexTaskRegister("intake");
-
-    while (!chThdShouldTerminate()) {
-        if (intake.locked) {
-            buttonIn = (bool)vexControllerGet(Btn6U);
-            buttonOut = (bool)vexControllerGet(Btn6D);
-            if (vexControllerGet(Btn5UXmtr2)) {
-                buttonIn = (bool)vexControllerGet(Btn6UXmtr2);
-                buttonOut = (bool)vexControllerGet(Btn6DXmtr2);
-            }
-            if (buttonIn == true) {
-                intakeCmd = 127;
-            } else if (buttonOut == true) {
-                intakeCmd = -127;
-            } else {
-                intakeCmd = 0;
-            }
-            intakeCmd = intakeSpeed(intakeCmd);
-            intakeMove(intakeCmd, immediate);
+    if (intake.locked) {
+        buttonIn = (bool)systemControllerGet(Btn6U);
+        buttonOut = (bool)systemControllerGet(Btn6D);
+        if (systemControllerGet(Btn5UXmtr2)) {
+            buttonIn = (bool)systemControllerGet(Btn6UXmtr2);
+            buttonOut = (bool)systemControllerGet(Btn6DXmtr2);
         }
-
-        // Don't hog cpu
-        vexSleep(25);
+        if (buttonIn == true) {
+            intakeCmd = 127;
+        } else if (buttonOut == true) {
+            intakeCmd = -127;
+        } else {
+            intakeCmd = 0;
+        }
+        intakeCmd = intakeSpeed(intakeCmd);
+        intakeMove(intakeCmd, immediate);
     }
 
-    return ((msg_t)0);
+    return;
 }
 
 void
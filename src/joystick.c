@@ -0,0 +1,274 @@
+// -*- mode: c; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*-----------------------------------------------------------------------------*/
+/** @file    joystick.c                                                        */
+/** @brief   Joystick shaping with per driver profiles                         */
+/*-----------------------------------------------------------------------------*/
+
+#include "joystick.h"
+#include "system.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// storage for joystick
+static joystick_t joystick;
+
+// private functions
+static void joystickDefaults(void);
+static void joystickBuild(void);
+static int16_t joystickSave(void);
+
+// the axes in the order they are kept in a profile
+static const tCtlIndex joystickAxes[JOYSTICK_AXES] = {Ch1, Ch2, Ch3, Ch4, Ch1Xmtr2, Ch2Xmtr2, Ch3Xmtr2, Ch4Xmtr2};
+
+// profiles used until some are saved, "default" matches the old hard coded behaviour
+#define JOYSTICK_LINEAR {0, 0, 127, 0, 0}
+#define JOYSTICK_SLOWED {0, 0, 127, 64, 0}
+static const joystickProfile_t joystickDefault[JOYSTICK_PROFILES] = {
+    {"default",
+     {JOYSTICK_SLOWED, JOYSTICK_LINEAR, JOYSTICK_SLOWED, JOYSTICK_SLOWED, JOYSTICK_LINEAR, JOYSTICK_LINEAR, JOYSTICK_LINEAR,
+      JOYSTICK_LINEAR}},
+    {"smooth",
+     {{8, 40, 127, 64, 1200}, JOYSTICK_LINEAR, {8, 40, 127, 64, 1200}, {8, 50, 127, 64, 1800}, JOYSTICK_LINEAR,
+      JOYSTICK_LINEAR, {10, 30, 127, 0, 0}, JOYSTICK_LINEAR}},
+    {"precise",
+     {{5, 60, 127, 40, 0}, JOYSTICK_LINEAR, {5, 60, 127, 40, 0}, {5, 70, 100, 40, 0}, JOYSTICK_LINEAR, JOYSTICK_LINEAR,
+      {10, 50, 127, 0, 0}, JOYSTICK_LINEAR}},
+    {"custom",
+     {JOYSTICK_SLOWED, JOYSTICK_LINEAR, JOYSTICK_SLOWED, JOYSTICK_SLOWED, JOYSTICK_LINEAR, JOYSTICK_LINEAR, JOYSTICK_LINEAR,
+      JOYSTICK_LINEAR}},
+};
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get pointer to joystick structure - not used locally           */
+/** @return     A joystick_t pointer                                           */
+/*-----------------------------------------------------------------------------*/
+joystick_t *
+joystickGetPtr(void)
+{
+    return (&joystick);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Initialize the joystick system from the profiles in flash      */
+/*-----------------------------------------------------------------------------*/
+void
+joystickInit(void)
+{
+    const joystickStore_t *saved = (const joystickStore_t *)storageAddress(kStoragePageJoystick);
+    int i;
+
+    if (saved != NULL && saved->magic == JOYSTICK_MAGIC && saved->version == JOYSTICK_VERSION &&
+        saved->count == JOYSTICK_PROFILES && saved->selected < JOYSTICK_PROFILES) {
+        (void)memcpy(&joystick.store, saved, sizeof(joystickStore_t));
+    } else {
+        joystickDefaults();
+    }
+    for (i = 0; i < JOYSTICK_PROFILES; i++) {
+        joystick.store.profiles[i].name[JOYSTICK_NAME - 1] = '\0';
+    }
+    for (i = 0; i < JOYSTICK_AXES; i++) {
+        shaperInit(&joystick.shapers[i], 1, 1, 0);
+        joystick.values[i] = 0;
+    }
+    joystick.revision++;
+    joystick.sequence = vexSpiGetFrameSequence();
+    joystick.shaped = chTimeNow();
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Shape all axes, once for each new SPI frame                    */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  All axes are shaped together in one pass over the profile, the other
+ *  systems read the results with joystickGet during the same cycle.
+ */
+void
+joystickStep(void)
+{
+    const joystickAxis_t *axis;
+    uint32_t sequence = systemGetPtr()->frame.sequence;
+    uint32_t dt;
+    bool slow;
+    int16_t value;
+    int i;
+
+    if (joystick.built != joystick.revision) {
+        joystickBuild();
+    }
+    if (sequence == joystick.sequence) {
+        return;
+    }
+    joystick.sequence = sequence;
+
+    dt = (uint32_t)((chTimeElapsedSince(joystick.shaped) * 1000) / CH_FREQUENCY);
+    joystick.shaped = chTimeNow();
+    slow = (systemControllerGet(JOYSTICK_SLOW) != 0);
+
+    axis = joystick.store.profiles[joystick.store.selected].axes;
+    for (i = 0; i < JOYSTICK_AXES; i++, axis++) {
+        value = systemControllerGet(joystickAxes[i]);
+        value = (value > 127) ? 127 : ((value < -127) ? -127 : value);
+        value = ((value > 0) - (value < 0)) * joystick.tables[i][abs(value)];
+        if (slow && axis->slow != 0 && abs(value) > axis->slow) {
+            value = ((value > 0) ? 1 : -1) * axis->slow;
+        }
+        if (axis->rate != 0) {
+            value = shaperStep(&joystick.shapers[i], value, dt);
+        } else {
+            shaperReset(&joystick.shapers[i], value);
+        }
+        joystick.values[i] = value;
+    }
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get a shaped joystick value                                    */
+/** @param[in]  index The controller index, as for systemControllerGet         */
+/** @return     The shaped value, buttons are passed through                   */
+/*-----------------------------------------------------------------------------*/
+int16_t
+joystickGet(tCtlIndex index)
+{
+    if (index >= Ch1 && index <= Ch4) {
+        return joystick.values[index - Ch1];
+    }
+    if (index >= Ch1Xmtr2 && index <= Ch4Xmtr2) {
+        return joystick.values[4 + index - Ch1Xmtr2];
+    }
+    return systemControllerGet(index);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Select a profile and save the selection                        */
+/** @param[in]  profile The profile                                            */
+/** @return     FLASH_SUCCESS or an error code                                 */
+/*-----------------------------------------------------------------------------*/
+int16_t
+joystickSelect(uint8_t profile)
+{
+    if (profile >= JOYSTICK_PROFILES) {
+        return FLASH_ERROR;
+    }
+    if (profile == joystick.store.selected) {
+        return FLASH_SUCCESS;
+    }
+    joystick.store.selected = profile;
+    joystick.revision++;
+    return joystickSave();
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the selected profile                                       */
+/** @return     The profile number                                             */
+/*-----------------------------------------------------------------------------*/
+uint8_t
+joystickSelected(void)
+{
+    return joystick.store.selected;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get a profile                                                  */
+/** @param[in]  profile The profile number                                     */
+/** @return     The profile or NULL                                            */
+/*-----------------------------------------------------------------------------*/
+const joystickProfile_t *
+joystickGetProfile(uint8_t profile)
+{
+    if (profile >= JOYSTICK_PROFILES) {
+        return NULL;
+    }
+    return &joystick.store.profiles[profile];
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Replace a profile and save the profiles                        */
+/** @param[in]  profile The profile number                                     */
+/** @param[in]  value The new profile                                          */
+/** @return     FLASH_SUCCESS or an error code                                 */
+/*-----------------------------------------------------------------------------*/
+int16_t
+joystickSetProfile(uint8_t profile, const joystickProfile_t *value)
+{
+    if (profile >= JOYSTICK_PROFILES || value == NULL) {
+        return FLASH_ERROR;
+    }
+    (void)memcpy(&joystick.store.profiles[profile], value, sizeof(joystickProfile_t));
+    joystick.store.profiles[profile].name[JOYSTICK_NAME - 1] = '\0';
+    joystick.revision++;
+    return joystickSave();
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Load the built in profiles                                     */
+/*-----------------------------------------------------------------------------*/
+static void
+joystickDefaults(void)
+{
+    joystick.store.magic = JOYSTICK_MAGIC;
+    joystick.store.version = JOYSTICK_VERSION;
+    joystick.store.selected = 0;
+    joystick.store.count = JOYSTICK_PROFILES;
+    (void)memcpy(joystick.store.profiles, joystickDefault, sizeof(joystickDefault));
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Build the lookup tables of the selected profile                */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Only called from joystickStep, so a profile changed from the LCD or RPC
+ *  threads never leaves the tables half built during a shaping pass.
+ */
+static void
+joystickBuild(void)
+{
+    const joystickAxis_t *axis = joystick.store.profiles[joystick.store.selected].axes;
+    int32_t span;
+    int32_t expo;
+    int32_t scale;
+    int32_t x;
+    int32_t curve;
+    int i;
+
+    joystick.built = joystick.revision;
+    for (i = 0; i < JOYSTICK_AXES; i++, axis++) {
+        span = 127 - (axis->deadband < 126 ? axis->deadband : 126);
+        expo = (axis->expo < 100) ? axis->expo : 100;
+        scale = (axis->scale < 127) ? axis->scale : 127;
+        for (x = 0; x < 128; x++) {
+            if (x <= 127 - span) {
+                joystick.tables[i][x] = 0;
+                continue;
+            }
+            // curve runs from 0 to 100 * span, linear blended with cubic
+            curve = x - (127 - span);
+            curve = ((100 - expo) * curve * span * span + expo * curve * curve * curve) / (span * span);
+            joystick.tables[i][x] = (int8_t)((scale * curve) / (100 * span));
+        }
+        shaperSet(&joystick.shapers[i], axis->rate, axis->rate, 0);
+    }
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Write the profiles to flash                                    */
+/** @return     FLASH_SUCCESS or an error code                                 */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The CPU stalls while the page is erased, like it does for the LCD mode.
+ */
+static int16_t
+joystickSave(void)
+{
+    int16_t status = storageErase(kStoragePageJoystick);
+
+    if (status != FLASH_SUCCESS) {
+        return status;
+    }
+    return storageWrite(kStoragePageJoystick, 0, &joystick.store, sizeof(joystickStore_t));
+}
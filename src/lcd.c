@@ -6,6 +6,8 @@
 /*-----------------------------------------------------------------------------*/
 
 #include "lcd.h"
+#include "joystick.h"
+#include "smartmotor.h"
 
 #include <math.h>
 #include <stdlib.h>
@@ -19,6 +21,9 @@ user_param *userp;
 // magic number used for flash storage
 #define MAGIC_NUMBER 13
 
+// warn the driver when a PTC is predicted to trip within this many ms
+#define LCD_TRIP_WARNING 30000
+
 // working area for lcd task
 static WORKING_AREA(waLcd, 512);
 
@@ -29,6 +34,8 @@ static long lcdThreadDeadTimer = 0;
 static msg_t lcdThread(void *arg);
 static void lcdRead(void);
 static void lcdWrite(void);
+static void lcdSelectDriver(void);
+static void lcdWriteStatus(void);
 
 /*-----------------------------------------------------------------------------*/
 /** @brief      Get pointer to lcd structure - not used locally                */
@@ -192,7 +199,61 @@ lcdRead(void)
         vexFlashUserParamWrite(userp);
 
         vexSleep(250);
+    } else if (lcd.buttons == kLcdButtonCenter) {
+        lcdSelectDriver();
+    }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Step to the next driver joystick profile                       */
+/*-----------------------------------------------------------------------------*/
+static void
+lcdSelectDriver(void)
+{
+    const joystickProfile_t *profile;
+    uint8_t next = joystickSelected() + 1;
+
+    if (next >= JOYSTICK_PROFILES) {
+        next = 0;
+    }
+
+    do {
+        lcdThreadDeadTimer = chTimeNow();
+        lcd.buttons = vexLcdButtonGet(lcd.display);
+        vexSleep(10);
+    } while (lcd.buttons != kLcdButtonNone);
+
+    (void)joystickSelect(next);
+    profile = joystickGetProfile(next);
+
+    vexLcdClearLine(lcd.display, VEX_LCD_LINE_2);
+    vexLcdPrintf(lcd.display, VEX_LCD_LINE_2, "Driver %d %s", next, profile->name);
+
+    lcdThreadDeadTimer = chTimeNow();
+    vexSleep(250);
+    lcdThreadDeadTimer = chTimeNow();
+    vexSleep(250);
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Show the battery and either the time or a PTC warning          */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The time left before the first motor or bank PTC trips at the present
+ *  current replaces the clock while it is short enough to matter.
+ */
+static void
+lcdWriteStatus(void)
+{
+    long trip = SmartMotorGetTripTimeMin();
+
+    if (trip < LCD_TRIP_WARNING) {
+        vexLcdPrintf(lcd.display, VEX_LCD_LINE_1, "%4.2fV PTC %4.1fs", vexSpiGetMainBattery() / 1000.0, trip / 1000.0);
+    } else {
+        vexLcdPrintf(lcd.display, VEX_LCD_LINE_1, "%4.2fV   %8.1f", vexSpiGetMainBattery() / 1000.0, chTimeNow() / 1000.0);
     }
+    return;
 }
 
 static void
@@ -200,47 +261,47 @@ lcdWrite(void)
 {
     switch (lcd.mode) {
     case kLcdMode0:
-        vexLcdPrintf(lcd.display, VEX_LCD_LINE_1, "%4.2fV   %8.1f", vexSpiGetMainBattery() / 1000.0, chTimeNow() / 1000.0);
+        lcdWriteStatus();
         vexLcdPrintf(lcd.display, VEX_LCD_LINE_2, "left 3 Point");
         break;
     case kLcdMode1:
-        vexLcdPrintf(lcd.display, VEX_LCD_LINE_1, "%4.2fV   %8.1f", vexSpiGetMainBattery() / 1000.0, chTimeNow() / 1000.0);
+        lcdWriteStatus();
         vexLcdPrintf(lcd.display, VEX_LCD_LINE_2, "Right 3 Point");
         break;
     case kLcdMode2:
-        vexLcdPrintf(lcd.display, VEX_LCD_LINE_1, "%4.2fV   %8.1f", vexSpiGetMainBattery() / 1000.0, chTimeNow() / 1000.0);
+        lcdWriteStatus();
         vexLcdPrintf(lcd.display, VEX_LCD_LINE_2, "Right 6pt");
         break;
     case kLcdMode3:
-        vexLcdPrintf(lcd.display, VEX_LCD_LINE_1, "%4.2fV   %8.1f", vexSpiGetMainBattery() / 1000.0, chTimeNow() / 1000.0);
+        lcdWriteStatus();
         vexLcdPrintf(lcd.display, VEX_LCD_LINE_2, "Not Me!");
         break;
     case kLcdMode4:
-        vexLcdPrintf(lcd.display, VEX_LCD_LINE_1, "%4.2fV   %8.1f", vexSpiGetMainBattery() / 1000.0, chTimeNow() / 1000.0);
+        lcdWriteStatus();
         vexLcdPrintf(lcd.display, VEX_LCD_LINE_2, "Blue Rt Shot Prk");
         break;
     case kLcdMode5:
-        vexLcdPrintf(lcd.display, VEX_LCD_LINE_1, "%4.2fV   %8.1f", vexSpiGetMainBattery() / 1000.0, chTimeNow() / 1000.0);
+        lcdWriteStatus();
         vexLcdPrintf(lcd.display, VEX_LCD_LINE_2, "Red lt Shot Prk");
         break;
     case kLcdMode6:
-        vexLcdPrintf(lcd.display, VEX_LCD_LINE_1, "%4.2fV   %8.1f", vexSpiGetMainBattery() / 1000.0, chTimeNow() / 1000.0);
+        lcdWriteStatus();
         vexLcdPrintf(lcd.display, VEX_LCD_LINE_2, "Blue Right Flag");
         break;
     case kLcdMode7:
-        vexLcdPrintf(lcd.display, VEX_LCD_LINE_1, "%4.2fV   %8.1f", vexSpiGetMainBattery() / 1000.0, chTimeNow() / 1000.0);
+        lcdWriteStatus();
         vexLcdPrintf(lcd.display, VEX_LCD_LINE_2, "Red Left Flag");
         break;
     case kLcdMode8:
-        vexLcdPrintf(lcd.display, VEX_LCD_LINE_1, "%4.2fV   %8.1f", vexSpiGetMainBattery() / 1000.0, chTimeNow() / 1000.0);
+        lcdWriteStatus();
         vexLcdPrintf(lcd.display, VEX_LCD_LINE_2, "Skills Blue 6pt?"); /*Check this*/
         break;
     case kLcdMode9:
-        vexLcdPrintf(lcd.display, VEX_LCD_LINE_1, "%4.2fV   %8.1f", vexSpiGetMainBattery() / 1000.0, chTimeNow() / 1000.0);
+        lcdWriteStatus();
         vexLcdPrintf(lcd.display, VEX_LCD_LINE_2, "Skills Red 6pt");
         break;
     default:
-        vexLcdPrintf(lcd.display, VEX_LCD_LINE_1, "%4.2fV   %8.1f", vexSpiGetMainBattery() / 1000.0, chTimeNow() / 1000.0);
+        lcdWriteStatus();
         vexLcdPrintf(lcd.display, VEX_LCD_LINE_2, "E Top Secret ERR");
         break;
     }
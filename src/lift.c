@@ -6,6 +6,11 @@
 /*-----------------------------------------------------------------------------*/
 
 #include "lift.h"
+#include "curve.h"
+#include "joystick.h"
+#include "sensors.h"
+#include "system.h"
+#include "tune.h"
 
 #include <math.h>
 #include <stdlib.h>
@@ -13,47 +18,20 @@
 // storage for lift
 static lift_t lift;
 
-// working area for lift task
-static WORKING_AREA(waLift, 512);
-
 // private functions
-static msg_t liftThread(void *arg);
-
-// lift speed adjustment
-#define USE_LIFT_SPEED_TABLE 1
-#ifdef USE_LIFT_SPEED_TABLE
+static void liftStartProfile(void);
+static void liftSet(int32_t cmd, bool immediate);
+static void liftSetMode(liftMode_t mode);
 
-const unsigned int liftSpeedTable[128] = {0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  21, 21, 21, 22, 22,  22,  23, 24, 24, 25, 25,
-                                          25, 25, 26, 27, 27, 28, 28, 28, 28, 29, 30, 30, 30, 31, 31, 32,  32,  32, 33, 33, 34, 34,
-                                          35, 35, 35, 36, 36, 37, 37, 37, 37, 38, 38, 39, 39, 39, 40, 40,  41,  41, 42, 42, 43, 44,
-                                          44, 45, 45, 46, 46, 47, 47, 48, 48, 49, 50, 50, 51, 52, 52, 53,  54,  55, 56, 57, 57, 58,
-                                          59, 60, 61, 62, 63, 64, 65, 66, 67, 67, 68, 70, 71, 72, 72, 73,  74,  76, 77, 78, 79, 79,
-                                          80, 81, 83, 84, 84, 86, 86, 87, 87, 88, 88, 89, 89, 90, 90, 127, 127, 127};
+// lift response curve
+#define LIFT_CURVE kCurveStandard
 
 static inline int
 liftSpeed(int speed)
 {
-    if (speed > 127)
-        speed = 127;
-    else if (speed < -127)
-        speed = -127;
-    return (((speed > 0) - (speed < 0)) * liftSpeedTable[abs(speed)]);
+    return curveApply(LIFT_CURVE, speed);
 }
 
-#else
-
-static inline int
-liftSpeed(int speed)
-{
-    if (speed > 127)
-        speed = 127;
-    else if (speed < -127)
-        speed = -127;
-    return (speed);
-}
-
-#endif
-
 /*-----------------------------------------------------------------------------*/
 /** @brief      Get pointer to lift structure - not used locally               */
 /** @return     A lift_t pointer                                               */
@@ -65,15 +43,17 @@ liftGetPtr(void)
 }
 
 /*-----------------------------------------------------------------------------*/
-/** @brief      Assign motor and limit sensor to the lift system.              */
+/** @brief      Assign motor and sensors to the lift system.                   */
 /** @param[in]  motor The lift motor                                           */
 /** @param[in]  limit The lift limit sensor                                    */
+/** @param[in]  pot The lift potentiometer                                     */
 /*-----------------------------------------------------------------------------*/
 void
-liftSetup(tVexMotor motor, tVexDigitalPin limit)
+liftSetup(tVexMotor motor, tVexDigitalPin limit, tVexAnalogPin pot)
 {
     lift.motor = motor;
     lift.limit = limit;
+    lift.pot = pot;
     lift.locked = true;
     return;
 }
@@ -81,85 +61,252 @@ liftSetup(tVexMotor motor, tVexDigitalPin limit)
 /*-----------------------------------------------------------------------------*/
 /** @brief      Initialize the lift system.                                    */
 /*-----------------------------------------------------------------------------*/
+/** @details
+ *  The pot is only zeroed by the limit switch, so the lift starts out
+ *  homing to the floor like it always did.
+ */
 void
 liftInit(void)
 {
+    // error is calculated from the profile setpoint
+    if (lift.pid == NULL) {
+        lift.pid = PidControllerInitWithBias(0.003, 0.0002, 0.01, LIFT_BIAS, kVexSensorUndefined, 0);
+    }
+    lift.homed = false;
+    lift.target = LIFT_FLOOR;
+    lift.mode = kLiftHoming;
+    shaperInit(&lift.shaper, LIFT_SHAPE_ACCEL, LIFT_SHAPE_DECEL, LIFT_SHAPE_JERK);
+    lift.command = 0;
+    lift.stepped = chTimeNow();
     return;
 }
 
 /*-----------------------------------------------------------------------------*/
-/** @brief      Start the lift system thread                                   */
+/** @brief      Run one control step of the lift system                       */
 /*-----------------------------------------------------------------------------*/
+/** @details
+ *  Commands are worked out with up as positive and flipped for the motor
+ *  in liftSet.  The joystick takes over whenever it is moved, letting go
+ *  holds the lift where it is.  Joystick commands go through the shaper
+ *  rather than the motor slew rate, the closed loop modes keep the shaper
+ *  at their last command so taking over again is smooth.
+ */
 void
-liftStart(void)
+liftStep(void)
 {
-    chThdCreateStatic(waLift, sizeof(waLift), NORMALPRIO - 1, liftThread, NULL);
+    int32_t position;
+    int32_t setpoint;
+    int32_t velocity;
+    int32_t cmd = 0;
+    uint32_t t;
+    int16_t stick = 0;
+    int16_t relay;
+    bool atFloor = (sensorsDigital(lift.limit) == kVexDigitalLow);
+    uint32_t dt = (uint32_t)((chTimeElapsedSince(lift.stepped) * 1000) / CH_FREQUENCY);
+
+    lift.stepped = chTimeNow();
+
+    // the limit switch zeroes the pot whenever the lift is on the floor
+    if (atFloor) {
+        lift.zero = sensorsAnalog(lift.pot);
+        lift.homed = true;
+    }
+    position = liftPosition();
+
+    if (lift.locked) {
+        stick = joystickGet(Ch3Xmtr2);
+        if (abs(stick) > LIFT_DEADBAND) {
+            liftSetMode(kLiftManual);
+        } else if (lift.mode == kLiftManual) {
+            lift.target = position;
+            liftSetMode(kLiftHold);
+        }
+        if (systemControllerGet(Btn7DXmtr2)) {
+            liftMoveTo(LIFT_FLOOR);
+        } else if (systemControllerGet(Btn7LXmtr2)) {
+            liftMoveTo(LIFT_CARRY);
+        } else if (systemControllerGet(Btn7UXmtr2)) {
+            liftMoveTo(LIFT_CEILING);
+        }
+    }
+
+    switch (lift.mode) {
+    case kLiftManual:
+        // liftMove owns the motor when unlocked
+        if (lift.locked) {
+            liftSet(shaperStep(&lift.shaper, liftSpeed(stick), dt), true);
+        }
+        break;
+
+    case kLiftHoming:
+        if (atFloor) {
+            liftStartProfile();
+        } else {
+            liftSet(-LIFT_HOME_POWER, true);
+        }
+        break;
+
+    case kLiftProfile:
+        t = (uint32_t)((chTimeElapsedSince(lift.start) * 1000) / CH_FREQUENCY);
+        profileAt(&lift.profile, t, &setpoint, NULL);
+        // the lift lags the command, so feed forward the velocity it needs a little ahead
+        profileAt(&lift.profile, t + LIFT_FEED_LEAD, NULL, &velocity);
+        lift.pid->error = (float)(lift.origin + setpoint - position);
+        cmd = (velocity * 127) / LIFT_MAX_VELOCITY + PidControllerUpdate(lift.pid);
+        liftSet(cmd, true);
+        if (t >= lift.profile.total) {
+            liftSetMode(kLiftHold);
+        }
+        break;
+
+    case kLiftHold:
+        if (lift.target <= LIFT_FLOOR && atFloor) {
+            // rest on the limit switch rather than servo against it
+            liftSet(-LIFT_REST_POWER, true);
+        } else {
+            lift.pid->error = (float)(lift.target - position);
+            liftSet(PidControllerUpdate(lift.pid), true);
+        }
+        break;
+
+    case kLiftTune:
+        // the autotune relay owns the motor until it finishes
+        if (tuneStep(kTuneLift, position, &relay)) {
+            liftSet(relay + (int32_t)(LIFT_BIAS * 127), true);
+        } else {
+            lift.target = position;
+            lift.pid->integral = 0;
+            liftSetMode(kLiftHold);
+        }
+        break;
+    }
+
+    if (lift.mode != kLiftManual) {
+        shaperReset(&lift.shaper, (int16_t)lift.command);
+    }
+
     return;
 }
 
-static inline int
-limitSpeed(int speed, int limit)
+/*-----------------------------------------------------------------------------*/
+/** @brief      Drive the lift motor open loop                                 */
+/** @param[in]  cmd The motor command                                          */
+/** @param[in]  immediate Bypass the motor slew rate                           */
+/*-----------------------------------------------------------------------------*/
+void
+liftMove(int16_t cmd, bool immediate)
+{
+    liftSetMode(kLiftManual);
+    SetMotor(lift.motor, cmd, immediate);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Move the lift to a position with a motion profile              */
+/** @param[in]  position The position in pot counts above the floor            */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  An unhomed lift finds the floor first and then moves to the position.
+ *  The move is carried out by liftStep, also while the lift is unlocked.
+ */
+void
+liftMoveTo(int32_t position)
 {
-    if (abs(speed) <= limit) {
-        return 0;
+    // the same position still ends manual control or an autotune
+    if (lift.target == position && lift.mode != kLiftManual && lift.mode != kLiftTune) {
+        return;
     }
-    return speed;
+    lift.target = position;
+    if (lift.homed) {
+        liftStartProfile();
+    } else {
+        liftSetMode(kLiftHoming);
+    }
+    return;
 }
 
 /*-----------------------------------------------------------------------------*/
-/** @brief      The lift system thread                                         */
-/** @param[in]  arg Unused                                                     */
-/** @return     (msg_t) 0                                                      */
+/** @brief      Find the floor again and zero the pot                          */
 /*-----------------------------------------------------------------------------*/
-static msg_t
-liftThread(void *arg)
+void
+liftHome(void)
 {
-    bool buttonHold = false;
-    bool buttonOff = false;
-    int16_t liftCmd = 0;
-    bool immediate = false;
+    lift.homed = false;
+    lift.target = LIFT_FLOOR;
+    liftSetMode(kLiftHoming);
+    return;
+}
 
-    // Unused
-    (void)arg;
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the lift position                                          */
+/** @return     The position in pot counts above the floor                     */
+/*-----------------------------------------------------------------------------*/
+int32_t
+liftPosition(void)
+{
+    int32_t position = sensorsAnalog(lift.pot) - lift.zero;
+    return (LIFT_POT_REVERSED ? -position : position);
+}
 
-    // Register the task
-    vexTaskRegister("lift");
+/*-----------------------------------------------------------------------------*/
+/** @brief      Check if the lift has reached its target                       */
+/** @return     true once the move is done and the lift is close enough        */
+/*-----------------------------------------------------------------------------*/
+bool
+liftAtTarget(void)
+{
+    return (lift.mode == kLiftHold && abs(lift.target - liftPosition()) <= LIFT_SETTLE);
+}
 
-    while (!chThdShouldTerminate()) {
-        if (lift.locked) {
-            buttonHold = vexControllerGet(Btn7DXmtr2);
-            buttonOff = vexControllerGet(Btn7UXmtr2);
-            if (buttonOff == true) {
-                liftCmd = 0;
-                immediate = true;
-            } else {
-                if (buttonHold == true) {
-                    liftCmd = 127;
-                    immediate = true;
-                } else if (vexDigitalPinGet(lift.limit) == kVexDigitalLow) {
-                    liftCmd = 15;
-                    immediate = true;
-                    vexSleep(25);
-                } else {
-                    liftCmd = 127;
-                    immediate = false;
-                }
-            }
-            liftCmd = liftSpeed(liftCmd);
-            liftMove(liftCmd, immediate);
-        }
+/*-----------------------------------------------------------------------------*/
+/** @brief      Change the shaping of the joystick commands                    */
+/** @param[in]  accel The rate in counts/s while the lift speeds up            */
+/** @param[in]  decel The rate in counts/s while the lift slows or reverses    */
+/** @param[in]  jerk The change of rate in counts/s^2, 0 for no limit          */
+/*-----------------------------------------------------------------------------*/
+void
+liftSetShaping(int32_t accel, int32_t decel, int32_t jerk)
+{
+    shaperSet(&lift.shaper, accel, decel, jerk);
+    return;
+}
 
-        // Don't hog cpu
-        vexSleep(25);
-    }
+/*-----------------------------------------------------------------------------*/
+/** @brief      Plan a move from the current position to the target            */
+/*-----------------------------------------------------------------------------*/
+static void
+liftStartProfile(void)
+{
+    lift.origin = liftPosition();
+    profileInit(&lift.profile, lift.target - lift.origin, LIFT_VELOCITY, LIFT_ACCEL);
+    lift.pid->integral = 0;
+    lift.start = chTimeNow();
+    liftSetMode(kLiftProfile);
+    return;
+}
 
-    return ((msg_t)0);
+/*-----------------------------------------------------------------------------*/
+/** @brief      Set the lift motor from a command with up as positive          */
+/*-----------------------------------------------------------------------------*/
+static void
+liftSet(int32_t cmd, bool immediate)
+{
+    cmd = (cmd > 127) ? 127 : ((cmd < -127) ? -127 : cmd);
+    lift.command = cmd;
+    SetMotor(lift.motor, LIFT_REVERSED ? -cmd : cmd, immediate);
+    return;
 }
 
-void
-liftMove(int16_t cmd, bool immediate)
+/*-----------------------------------------------------------------------------*/
+/** @brief      Change the mode of the lift, cancelling a running relay        */
+/*-----------------------------------------------------------------------------*/
+static void
+liftSetMode(liftMode_t mode)
 {
-    SetMotor(lift.motor, cmd, immediate);
+    if (lift.mode == kLiftTune && mode != kLiftTune) {
+        tuneCancel(kTuneLift);
+    }
+    lift.mode = mode;
+    return;
 }
 
 void
@@ -171,5 +318,23 @@ liftLock(void)
 void
 liftUnlock(void)
 {
+    liftSetMode(kLiftManual);
     lift.locked = false;
 }
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Hand the lift motor to the autotune relay                      */
+/** @return     false if the lift has not been homed yet                       */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Started by tuneStart, the joystick or a preset cancels the relay.
+ */
+bool
+liftTune(void)
+{
+    if (!lift.homed) {
+        return false;
+    }
+    liftSetMode(kLiftTune);
+    return true;
+}
@@ -53,6 +53,10 @@
 #include "apollo.h"
 #include "pidlib.h"
 
+#include "sensors.h"
+#include "system.h"
+#include "tune.h"
+
 /*-----------------------------------------------------------------------------*/
 /* Command line related.                                                       */
 /*-----------------------------------------------------------------------------*/
@@ -102,7 +106,9 @@ cmd_bat(vexStream *chp, int argc, char *argv[])
 static const ShellCommand commands[] = {{"adc", vexAdcDebug},   {"spi", vexSpiDebug},     {"motor", vexMotorDebug},
                                         {"lcd", vexLcdDebug},   {"enc", vexEncoderDebug}, {"son", vexSonarDebug},
                                         {"ime", vexIMEDebug},   {"test", vexTestDebug},   {"sm", cmd_sm},
-                                        {"apollo", cmd_apollo}, {"bat", cmd_bat},         {NULL, NULL}};
+                                        {"apollo", cmd_apollo}, {"bat", cmd_bat},         {"sys", systemDebug},
+                                        {"trace", vexTraceDebug}, {"smh", SmartMotorHistoryDebug}, {"tune", tuneDebug},
+                                        {"sens", sensorsDebug},   {NULL, NULL}};
 
 // configuration for the shell
 static const ShellConfig shell_cfg1 = {(vexStream *)SD_CONSOLE, commands};
@@ -0,0 +1,169 @@
+// -*- mode: c; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*-----------------------------------------------------------------------------*/
+/** @file    odometry.c                                                        */
+/** @brief   The pose estimator for the robot                                  */
+/*-----------------------------------------------------------------------------*/
+
+#include "odometry.h"
+#include "trig.h"
+
+// storage for odometry
+static odometry_t odometry;
+
+// working area for odometry task
+static WORKING_AREA(waOdometry, 512);
+
+static Thread *odometryThreadPointer = NULL;
+
+// private functions
+static msg_t odometryThread(void *arg);
+static void odometryUpdate(void);
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get pointer to odometry structure - not used locally           */
+/** @return     A odometry_t pointer                                           */
+/*-----------------------------------------------------------------------------*/
+odometry_t *
+odometryGetPtr(void)
+{
+    return (&odometry);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Start the pose estimator thread                                */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The thread is not registered with vexTaskRegister, it keeps running
+ *  across competition mode changes.
+ */
+void
+odometryStart(void)
+{
+    if (odometryThreadPointer != NULL) {
+        return;
+    }
+    odometryReset(NULL);
+    odometryThreadPointer = chThdCreateStatic(waOdometry, sizeof(waOdometry), NORMALPRIO, odometryThread, NULL);
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Set the pose of the robot                                      */
+/** @param[in]  pose The new pose, NULL for the origin                         */
+/*-----------------------------------------------------------------------------*/
+void
+odometryReset(const pose_t *pose)
+{
+    int32_t x = 0;
+    int32_t y = 0;
+    int32_t heading = 0;
+    int32_t gyro = driveHeading();
+    int32_t encoder = vexEncoderGet(DRIVE_ENCODER);
+#if ODOMETRY_LATERAL
+    int32_t lateral = vexEncoderGet(ODOMETRY_LATERAL_ENCODER);
+#else
+    int32_t lateral = 0;
+#endif
+
+    if (pose != NULL) {
+        x = (int32_t)(((int64_t)pose->x * DRIVE_TICKS_PER_INCH * 65536) / 100);
+        y = (int32_t)(((int64_t)pose->y * DRIVE_TICKS_PER_INCH * 65536) / 100);
+        heading = pose->heading;
+    }
+
+    chSysLock();
+    odometry.x = x;
+    odometry.y = y;
+    odometry.heading = heading;
+    odometry.offset = gyro - heading;
+    odometry.encoder = encoder;
+    odometry.lateral = lateral;
+    chSysUnlock();
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the pose of the robot                                      */
+/** @param[out] pose The current pose                                          */
+/*-----------------------------------------------------------------------------*/
+void
+odometryGet(pose_t *pose)
+{
+    int32_t x;
+    int32_t y;
+
+    chSysLock();
+    x = odometry.x;
+    y = odometry.y;
+    pose->heading = odometry.heading;
+    chSysUnlock();
+
+    pose->x = (int32_t)(((int64_t)x * 100) / ((int64_t)DRIVE_TICKS_PER_INCH * 65536));
+    pose->y = (int32_t)(((int64_t)y * 100) / ((int64_t)DRIVE_TICKS_PER_INCH * 65536));
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      The pose estimator thread                                      */
+/** @param[in]  arg Unused                                                     */
+/** @return     (msg_t) 0                                                      */
+/*-----------------------------------------------------------------------------*/
+static msg_t
+odometryThread(void *arg)
+{
+    // Unused
+    (void)arg;
+
+    chRegSetThreadName("odometry");
+
+    tickerInit(&odometry.ticker, ODOMETRY_PERIOD);
+
+    while (!chThdShouldTerminate()) {
+        odometryUpdate();
+        (void)tickerWait(&odometry.ticker);
+    }
+
+    return ((msg_t)0);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Integrate the encoder travel along the gyro heading            */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The travel since the last update is applied along the mean of the old
+ *  and new heading, which keeps arcs from cutting the corner.  Lateral
+ *  travel is only known with ODOMETRY_LATERAL, see odometry.h.
+ */
+static void
+odometryUpdate(void)
+{
+    int32_t encoder = vexEncoderGet(DRIVE_ENCODER);
+    int32_t gyro = driveHeading();
+#if ODOMETRY_LATERAL
+    int32_t lateral = vexEncoderGet(ODOMETRY_LATERAL_ENCODER);
+#else
+    int32_t lateral = 0;
+#endif
+    int32_t distance;
+    int32_t strafe;
+    int32_t heading;
+    int32_t mean;
+
+    chSysLock();
+    distance = encoder - odometry.encoder;
+    heading = gyro - odometry.offset;
+    mean = odometry.heading + ((heading - odometry.heading) / 2);
+    strafe = (lateral - odometry.lateral) - (((heading - odometry.heading) * ODOMETRY_LATERAL_TURN) / 3600);
+
+    // Q14 sin/cos times ticks, shifted up to Q16, right of the robot is
+    // (cos, -sin) as the heading is clockwise
+    odometry.x += (distance * trigSin(mean) + strafe * trigCos(mean)) * (1 << (16 - TRIG_SHIFT));
+    odometry.y += (distance * trigCos(mean) - strafe * trigSin(mean)) * (1 << (16 - TRIG_SHIFT));
+    odometry.heading = heading;
+    odometry.encoder = encoder;
+    odometry.lateral = lateral;
+    odometry.count++;
+    chSysUnlock();
+    return;
+}
@@ -0,0 +1,231 @@
+// -*- mode: c; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*-----------------------------------------------------------------------------*/
+/** @file    profile.c                                                         */
+/** @brief   Trapezoidal velocity profiles and command shapers                 */
+/*-----------------------------------------------------------------------------*/
+
+#include "profile.h"
+
+#include <stdlib.h>
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Plan a move                                                    */
+/** @param[in]  profile The profile                                            */
+/** @param[in]  distance The signed distance of the move                       */
+/** @param[in]  velocity The cruise velocity in units/s                        */
+/** @param[in]  accel The acceleration in units/s^2                            */
+/*-----------------------------------------------------------------------------*/
+void
+profileInit(profile_t *profile, int32_t distance, int32_t velocity, int32_t accel)
+{
+    uint32_t d = (uint32_t)abs(distance);
+    uint32_t cruise;
+
+    if (velocity < 1) {
+        velocity = 1;
+    }
+    if (accel < 1) {
+        accel = 1;
+    }
+
+    // too short to reach velocity, peak where both ramps meet
+    if (((uint64_t)d * (uint32_t)accel) < ((uint64_t)velocity * (uint32_t)velocity)) {
+        velocity = (int32_t)profileSqrt(d * (uint32_t)accel);
+        if (velocity < 1) {
+            velocity = 1;
+        }
+    }
+
+    profile->distance = distance;
+    profile->velocity = velocity;
+    profile->accel = accel;
+    if (d == 0) {
+        profile->ramp = 0;
+        profile->total = 0;
+        return;
+    }
+    profile->ramp = (uint32_t)(((uint64_t)velocity * 1000) / (uint32_t)accel);
+
+    // distance covered at cruise velocity after both ramps
+    cruise = (uint32_t)(((uint64_t)accel * profile->ramp * profile->ramp) / 1000000);
+    cruise = (cruise < d) ? (d - cruise) : 0;
+    profile->total = (2 * profile->ramp) + (uint32_t)(((uint64_t)cruise * 1000) / (uint32_t)velocity);
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Sample a profile                                               */
+/** @param[in]  profile The profile                                            */
+/** @param[in]  t The time since the start of the move in ms                   */
+/** @param[out] position The signed position at t, may be NULL                */
+/** @param[out] velocity The signed velocity at t, may be NULL                */
+/*-----------------------------------------------------------------------------*/
+void
+profileAt(const profile_t *profile, uint32_t t, int32_t *position, int32_t *velocity)
+{
+    uint32_t d = (uint32_t)abs(profile->distance);
+    uint32_t left;
+    int32_t pos;
+    int32_t vel;
+
+    if (t >= profile->total) {
+        pos = (int32_t)d;
+        vel = 0;
+    } else if (t < profile->ramp && t < (profile->total - profile->ramp)) {
+        pos = (int32_t)(((uint64_t)profile->accel * t * t) / 2000000);
+        vel = (int32_t)(((uint64_t)profile->accel * t) / 1000);
+    } else if (t < (profile->total - profile->ramp)) {
+        pos = (int32_t)(((uint64_t)profile->accel * profile->ramp * profile->ramp) / 2000000);
+        pos += (int32_t)(((uint64_t)profile->velocity * (t - profile->ramp)) / 1000);
+        vel = profile->velocity;
+    } else {
+        left = profile->total - t;
+        pos = (int32_t)d - (int32_t)(((uint64_t)profile->accel * left * left) / 2000000);
+        vel = (int32_t)(((uint64_t)profile->accel * left) / 1000);
+    }
+
+    if (profile->distance < 0) {
+        pos = -pos;
+        vel = -vel;
+    }
+    if (position != NULL) {
+        *position = pos;
+    }
+    if (velocity != NULL) {
+        *velocity = vel;
+    }
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Integer square root                                            */
+/** @param[in]  value The value                                                */
+/** @return     The largest integer whose square is not above value            */
+/*-----------------------------------------------------------------------------*/
+uint32_t
+profileSqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Initialize a command shaper at rest                            */
+/** @param[in]  shaper The shaper                                              */
+/** @param[in]  accel The rate in counts/s while the command grows             */
+/** @param[in]  decel The rate in counts/s while the command shrinks           */
+/** @param[in]  jerk The change of rate in counts/s^2, 0 for no limit          */
+/*-----------------------------------------------------------------------------*/
+void
+shaperInit(shaper_t *shaper, int32_t accel, int32_t decel, int32_t jerk)
+{
+    shaperSet(shaper, accel, decel, jerk);
+    shaperReset(shaper, 0);
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Change the limits of a command shaper, keeping its state       */
+/** @param[in]  shaper The shaper                                              */
+/** @param[in]  accel The rate in counts/s while the command grows             */
+/** @param[in]  decel The rate in counts/s while the command shrinks           */
+/** @param[in]  jerk The change of rate in counts/s^2, 0 for no limit          */
+/*-----------------------------------------------------------------------------*/
+void
+shaperSet(shaper_t *shaper, int32_t accel, int32_t decel, int32_t jerk)
+{
+    shaper->accel = (accel < 1) ? 1 : accel;
+    shaper->decel = (decel < 1) ? 1 : decel;
+    shaper->jerk = (jerk < 0) ? 0 : jerk;
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Set the command of a shaper without limiting                   */
+/** @param[in]  shaper The shaper                                              */
+/** @param[in]  value The command                                              */
+/*-----------------------------------------------------------------------------*/
+void
+shaperReset(shaper_t *shaper, int16_t value)
+{
+    shaper->value = (int32_t)value * 256;
+    shaper->rate = 0;
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Move the command of a shaper toward a target                   */
+/** @param[in]  shaper The shaper                                              */
+/** @param[in]  target The command asked for                                   */
+/** @param[in]  dt The time since the last step in ms                          */
+/** @return     The limited command                                            */
+/*-----------------------------------------------------------------------------*/
+int16_t
+shaperStep(shaper_t *shaper, int16_t target, uint32_t dt)
+{
+    int32_t error = (int32_t)target * 256 - shaper->value;
+    int32_t limit;
+    int32_t cap;
+    int32_t desired;
+    int32_t change;
+    int32_t step;
+
+    if (error == 0) {
+        shaper->rate = 0;
+        return target;
+    }
+    if (dt > 100) {
+        dt = 100;
+    }
+
+    // growing away from zero uses accel, toward or through zero decel
+    if (shaper->value == 0 || (error > 0) == (shaper->value > 0)) {
+        limit = shaper->accel * 256;
+    } else {
+        limit = shaper->decel * 256;
+    }
+
+    // with a jerk limit the rate must be able to ramp down before the target
+    if (shaper->jerk > 0) {
+        cap = (int32_t)profileSqrt(2 * (uint32_t)shaper->jerk * (uint32_t)(abs(error) / 256 + 1)) * 256;
+        if (cap < limit) {
+            limit = cap;
+        }
+    }
+    desired = (error > 0) ? limit : -limit;
+
+    if (shaper->jerk > 0) {
+        change = (int32_t)(((int64_t)shaper->jerk * 256 * dt) / 1000);
+        if (desired > shaper->rate + change) {
+            desired = shaper->rate + change;
+        } else if (desired < shaper->rate - change) {
+            desired = shaper->rate - change;
+        }
+    }
+    shaper->rate = desired;
+
+    step = (int32_t)(((int64_t)shaper->rate * dt) / 1000);
+    if ((error > 0 && step >= error) || (error < 0 && step <= error)) {
+        shaper->value = (int32_t)target * 256;
+        shaper->rate = 0;
+    } else {
+        shaper->value += step;
+    }
+
+    return (int16_t)(shaper->value / 256);
+}
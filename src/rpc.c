@@ -7,6 +7,10 @@
 
 #include "rpc.h"
 #include "cassette.h"
+#include "joystick.h"
+#include "odometry.h"
+#include "tune.h"
+#include "autonomous/script.h"
 #include "portable_endian.h"
 
 #include <stdlib.h>
@@ -15,6 +19,9 @@
 static void rpcPublish(rpc_t *rpc, rpcSubscription_t *sub);
 static void rpcPublishClock(rpc_t *rpc, rpcSubscription_t *sub);
 static void rpcPublishMotor(rpc_t *rpc, rpcSubscription_t *sub);
+static void rpcPublishPose(rpc_t *rpc, rpcSubscription_t *sub);
+static void rpcPublishSmartmotor(rpc_t *rpc, rpcSubscription_t *sub);
+static void rpcPublishTrace(rpc_t *rpc, rpcSubscription_t *sub);
 static void rpcPublishAll(rpc_t *rpc, rpcSubscription_t *sub);
 static void rpcRecvPing(rpc_t *rpc, const message_ping_t *ping);
 static void rpcRecvInfo(rpc_t *rpc, const message_info_t *info);
@@ -23,10 +30,19 @@ static void rpcRecvRead(rpc_t *rpc, const message_read_t *read);
 static void rpcRecvReadPubsub(rpc_t *rpc, const message_read_t *read);
 static void rpcRecvReadClock(rpc_t *rpc, const message_read_t *read);
 static void rpcRecvReadMotor(rpc_t *rpc, const message_read_t *read);
+static void rpcRecvReadPose(rpc_t *rpc, const message_read_t *read);
+static void rpcRecvReadSmartmotor(rpc_t *rpc, const message_read_t *read);
+static void rpcRecvReadTrace(rpc_t *rpc, const message_read_t *read);
+static void rpcRecvReadJoystick(rpc_t *rpc, const message_read_t *read);
+static void rpcRecvReadTune(rpc_t *rpc, const message_read_t *read);
 static void rpcRecvReadCassette(rpc_t *rpc, const message_read_t *read);
+static void rpcRecvReadScript(rpc_t *rpc, const message_read_t *read);
 static void rpcRecvWrite(rpc_t *rpc, const message_write_t *write);
 static void rpcRecvWriteMotor(rpc_t *rpc, const message_write_t *write);
 static void rpcRecvWriteCassette(rpc_t *rpc, const message_write_t *write);
+static void rpcRecvWriteScript(rpc_t *rpc, const message_write_t *write);
+static void rpcRecvWriteJoystick(rpc_t *rpc, const message_write_t *write);
+static void rpcRecvWriteTune(rpc_t *rpc, const message_write_t *write);
 static void rpcRecvSubscribe(rpc_t *rpc, const message_subscribe_t *subscribe);
 static void rpcRecvUnsubscribe(rpc_t *rpc, const message_unsubscribe_t *unsubscribe);
 static int rpcSendData(rpc_t *rpc, uint16_t req_id, uint8_t topic, uint8_t subtopic, uint8_t flag, uint8_t len, uint8_t *value);
@@ -37,6 +53,13 @@ static int rpcSendRepError(rpc_t *rpc, uint16_t req_id, uint8_t topic, uint8_t s
 static int rpcSubFind(rpc_t *rpc, uint16_t req_id, rpcSubscription_t **subp);
 static int rpcSubFree(rpc_t *rpc, rpcSubscription_t **subp);
 static void rpcSubReset(rpcSubscription_t *sub);
+static uint8_t rpcPoseValue(rpc_t *rpc);
+static bool rpcSmartmotorValid(uint8_t subtopic);
+static uint8_t rpcSmartmotorValue(rpc_t *rpc, uint8_t subtopic);
+static uint8_t rpcSmartmotorTripValue(rpc_t *rpc);
+static uint8_t rpcTraceValue(rpc_t *rpc, uint8_t stage);
+static uint8_t rpcJoystickValue(rpc_t *rpc, uint8_t profile);
+static uint8_t rpcTuneValue(rpc_t *rpc, uint8_t system);
 
 void
 rpcLoop(rpc_t *rpc)
@@ -91,6 +114,15 @@ rpcPublish(rpc_t *rpc, rpcSubscription_t *sub)
     case MESSAGES_TOPIC_MOTOR:
         (void)rpcPublishMotor(rpc, sub);
         break;
+    case MESSAGES_TOPIC_POSE:
+        (void)rpcPublishPose(rpc, sub);
+        break;
+    case MESSAGES_TOPIC_SMARTMOTOR:
+        (void)rpcPublishSmartmotor(rpc, sub);
+        break;
+    case MESSAGES_TOPIC_TRACE:
+        (void)rpcPublishTrace(rpc, sub);
+        break;
     case MESSAGES_TOPIC_ALL:
         (void)rpcPublishAll(rpc, sub);
         break;
@@ -167,6 +199,54 @@ rpcPublishMotor(rpc_t *rpc, rpcSubscription_t *sub)
     return;
 }
 
+static void
+rpcPublishPose(rpc_t *rpc, rpcSubscription_t *sub)
+{
+    uint8_t tlen = 0;
+    switch (sub->subtopic) {
+    case MESSAGES_TOPIC_POSE_SUBTOPIC_FIELD:
+        tlen = rpcPoseValue(rpc);
+        (void)rpcSendPub(rpc, sub, tlen, (void *)rpc->tmp);
+        break;
+    default:
+        (void)rpcSendPubError(rpc, sub, MESSAGES_ERROR_BAD_SUBTOPIC);
+        (void)rpcSubReset(sub);
+        break;
+    }
+    return;
+}
+
+static void
+rpcPublishSmartmotor(rpc_t *rpc, rpcSubscription_t *sub)
+{
+    uint8_t tlen = 0;
+    if (sub->subtopic == MESSAGES_TOPIC_SMARTMOTOR_SUBTOPIC_TRIP) {
+        tlen = rpcSmartmotorTripValue(rpc);
+        (void)rpcSendPub(rpc, sub, tlen, (void *)rpc->tmp);
+    } else if (rpcSmartmotorValid(sub->subtopic)) {
+        tlen = rpcSmartmotorValue(rpc, sub->subtopic);
+        (void)rpcSendPub(rpc, sub, tlen, (void *)rpc->tmp);
+    } else {
+        (void)rpcSendPubError(rpc, sub, MESSAGES_ERROR_BAD_SUBTOPIC);
+        (void)rpcSubReset(sub);
+    }
+    return;
+}
+
+static void
+rpcPublishTrace(rpc_t *rpc, rpcSubscription_t *sub)
+{
+    uint8_t tlen = 0;
+    if (sub->subtopic < kVexTraceNum) {
+        tlen = rpcTraceValue(rpc, sub->subtopic);
+        (void)rpcSendPub(rpc, sub, tlen, (void *)rpc->tmp);
+    } else {
+        (void)rpcSendPubError(rpc, sub, MESSAGES_ERROR_BAD_SUBTOPIC);
+        (void)rpcSubReset(sub);
+    }
+    return;
+}
+
 static void
 rpcPublishAll(rpc_t *rpc, rpcSubscription_t *sub)
 {
@@ -283,9 +363,27 @@ rpcRecvRead(rpc_t *rpc, const message_read_t *read)
     case MESSAGES_TOPIC_MOTOR:
         (void)rpcRecvReadMotor(rpc, read);
         break;
+    case MESSAGES_TOPIC_POSE:
+        (void)rpcRecvReadPose(rpc, read);
+        break;
+    case MESSAGES_TOPIC_SMARTMOTOR:
+        (void)rpcRecvReadSmartmotor(rpc, read);
+        break;
+    case MESSAGES_TOPIC_TRACE:
+        (void)rpcRecvReadTrace(rpc, read);
+        break;
+    case MESSAGES_TOPIC_JOYSTICK:
+        (void)rpcRecvReadJoystick(rpc, read);
+        break;
+    case MESSAGES_TOPIC_TUNE:
+        (void)rpcRecvReadTune(rpc, read);
+        break;
     case MESSAGES_TOPIC_CASSETTE:
         (void)rpcRecvReadCassette(rpc, read);
         break;
+    case MESSAGES_TOPIC_SCRIPT:
+        (void)rpcRecvReadScript(rpc, read);
+        break;
     default:
         (void)rpcSendRepError(rpc, read->req_id, read->topic, read->subtopic, MESSAGES_ERROR_BAD_TOPIC);
         break;
@@ -452,6 +550,87 @@ rpcRecvReadMotor(rpc_t *rpc, const message_read_t *read)
     return;
 }
 
+static void
+rpcRecvReadPose(rpc_t *rpc, const message_read_t *read)
+{
+    uint8_t tlen = 0;
+    switch (read->subtopic) {
+    case MESSAGES_TOPIC_POSE_SUBTOPIC_FIELD:
+        tlen = rpcPoseValue(rpc);
+        (void)rpcSendRep(rpc, read, tlen, (void *)rpc->tmp);
+        break;
+    default:
+        (void)rpcSendRepError(rpc, read->req_id, read->topic, read->subtopic, MESSAGES_ERROR_BAD_SUBTOPIC);
+        break;
+    }
+    return;
+}
+
+static void
+rpcRecvReadSmartmotor(rpc_t *rpc, const message_read_t *read)
+{
+    uint8_t tlen = 0;
+    if (read->subtopic == MESSAGES_TOPIC_SMARTMOTOR_SUBTOPIC_RESET) {
+        (void)SmartMotorHistoryReset();
+        (void)rpcSendRep(rpc, read, 0, NULL);
+    } else if (read->subtopic == MESSAGES_TOPIC_SMARTMOTOR_SUBTOPIC_TRIP) {
+        tlen = rpcSmartmotorTripValue(rpc);
+        (void)rpcSendRep(rpc, read, tlen, (void *)rpc->tmp);
+    } else if (rpcSmartmotorValid(read->subtopic)) {
+        tlen = rpcSmartmotorValue(rpc, read->subtopic);
+        (void)rpcSendRep(rpc, read, tlen, (void *)rpc->tmp);
+    } else {
+        (void)rpcSendRepError(rpc, read->req_id, read->topic, read->subtopic, MESSAGES_ERROR_BAD_SUBTOPIC);
+    }
+    return;
+}
+
+static void
+rpcRecvReadTrace(rpc_t *rpc, const message_read_t *read)
+{
+    uint8_t tlen = 0;
+    if (read->subtopic == MESSAGES_TOPIC_TRACE_SUBTOPIC_RESET) {
+        (void)vexTraceReset();
+        (void)rpcSendRep(rpc, read, 0, NULL);
+    } else if (read->subtopic < kVexTraceNum) {
+        tlen = rpcTraceValue(rpc, read->subtopic);
+        (void)rpcSendRep(rpc, read, tlen, (void *)rpc->tmp);
+    } else {
+        (void)rpcSendRepError(rpc, read->req_id, read->topic, read->subtopic, MESSAGES_ERROR_BAD_SUBTOPIC);
+    }
+    return;
+}
+
+static void
+rpcRecvReadJoystick(rpc_t *rpc, const message_read_t *read)
+{
+    uint8_t value;
+    uint8_t tlen = 0;
+    if (read->subtopic == MESSAGES_TOPIC_JOYSTICK_SUBTOPIC_SELECT) {
+        value = joystickSelected();
+        (void)rpcSendRep(rpc, read, 1, (void *)&value);
+    } else if (read->subtopic < JOYSTICK_PROFILES) {
+        tlen = rpcJoystickValue(rpc, read->subtopic);
+        (void)rpcSendRep(rpc, read, tlen, (void *)rpc->tmp);
+    } else {
+        (void)rpcSendRepError(rpc, read->req_id, read->topic, read->subtopic, MESSAGES_ERROR_BAD_SUBTOPIC);
+    }
+    return;
+}
+
+static void
+rpcRecvReadTune(rpc_t *rpc, const message_read_t *read)
+{
+    uint8_t tlen = 0;
+    if (read->subtopic < kTuneSystemNumber) {
+        tlen = rpcTuneValue(rpc, read->subtopic);
+        (void)rpcSendRep(rpc, read, tlen, (void *)rpc->tmp);
+    } else {
+        (void)rpcSendRepError(rpc, read->req_id, read->topic, read->subtopic, MESSAGES_ERROR_BAD_SUBTOPIC);
+    }
+    return;
+}
+
 static void
 rpcRecvReadCassette(rpc_t *rpc, const message_read_t *read)
 {
@@ -526,6 +705,68 @@ rpcRecvReadCassette(rpc_t *rpc, const message_read_t *read)
     return;
 }
 
+static void
+rpcRecvReadScript(rpc_t *rpc, const message_read_t *read)
+{
+    uint8_t i;
+    uint8_t value;
+    uint16_t value16;
+    uint8_t *tbuf = (void *)rpc->tmp;
+    uint8_t tlen = 0;
+    const scriptHeader_t *header = NULL;
+    if (read->subtopic < SCRIPT_SLOTS) {
+        header = scriptLoad(read->subtopic);
+        if (header == NULL) {
+            (void)rpcSendRep(rpc, read, 0, NULL);
+            return;
+        }
+        value16 = (uint16_t)(htons(header->count));
+        (void)memcpy(tbuf, &value16, 2);
+        tbuf += 2;
+        tlen += 2;
+        value16 = (uint16_t)(htons(header->modes));
+        (void)memcpy(tbuf, &value16, 2);
+        tbuf += 2;
+        tlen += 2;
+        value16 = (uint16_t)(htons(header->mirror));
+        (void)memcpy(tbuf, &value16, 2);
+        tbuf += 2;
+        tlen += 2;
+        (void)rpcSendRep(rpc, read, tlen, (void *)rpc->tmp);
+        return;
+    }
+    switch (read->subtopic) {
+    case MESSAGES_TOPIC_SCRIPT_SUBTOPIC_OPEN:
+        value = rpc->script;
+        (void)memcpy(tbuf, &value, 1);
+        tbuf += 1;
+        tlen += 1;
+        value16 = (uint16_t)(htons(rpc->scriptOffset));
+        (void)memcpy(tbuf, &value16, 2);
+        tbuf += 2;
+        tlen += 2;
+        (void)rpcSendRep(rpc, read, tlen, (void *)rpc->tmp);
+        break;
+    case MESSAGES_TOPIC_SCRIPT_SUBTOPIC_COUNT:
+        value = 0;
+        for (i = 0; i < SCRIPT_SLOTS; i++) {
+            if (scriptLoad(i) != NULL) {
+                value++;
+            }
+        }
+        (void)rpcSendRep(rpc, read, 1, (void *)&value);
+        break;
+    case MESSAGES_TOPIC_SCRIPT_SUBTOPIC_MAX:
+        value = SCRIPT_SLOTS;
+        (void)rpcSendRep(rpc, read, 1, (void *)&value);
+        break;
+    default:
+        (void)rpcSendRepError(rpc, read->req_id, read->topic, read->subtopic, MESSAGES_ERROR_BAD_SUBTOPIC);
+        break;
+    }
+    return;
+}
+
 static void
 rpcRecvWrite(rpc_t *rpc, const message_write_t *write)
 {
@@ -536,6 +777,15 @@ rpcRecvWrite(rpc_t *rpc, const message_write_t *write)
     case MESSAGES_TOPIC_CASSETTE:
         (void)rpcRecvWriteCassette(rpc, write);
         break;
+    case MESSAGES_TOPIC_SCRIPT:
+        (void)rpcRecvWriteScript(rpc, write);
+        break;
+    case MESSAGES_TOPIC_JOYSTICK:
+        (void)rpcRecvWriteJoystick(rpc, write);
+        break;
+    case MESSAGES_TOPIC_TUNE:
+        (void)rpcRecvWriteTune(rpc, write);
+        break;
     default:
         (void)rpcSendRepError(rpc, write->req_id, write->topic, write->subtopic, MESSAGES_ERROR_BAD_TOPIC);
         break;
@@ -654,6 +904,116 @@ rpcRecvWriteCassette(rpc_t *rpc, const message_write_t *write)
     return;
 }
 
+/** @details
+ *  A script is uploaded by an OPEN of the slot, which erases its flash page,
+ *  followed by WRITEs of the slot number and an even number of image bytes
+ *  that are appended to the page, and a CLOSE of the slot.  The image is
+ *  only used once its header and checksum are valid.
+ */
+static void
+rpcRecvWriteScript(rpc_t *rpc, const message_write_t *write)
+{
+    uint8_t *wbuf = write->value;
+    uint8_t wlen = 0;
+    switch (write->subtopic) {
+    case MESSAGES_TOPIC_SCRIPT_SUBTOPIC_OPEN:
+        if (write->len != 1) {
+            return;
+        }
+        if (*wbuf >= SCRIPT_SLOTS) {
+            return;
+        }
+        if (rpc->script != 0xff) {
+            return;
+        }
+        if (storageErase((kStoragePageType)(kStoragePageScript0 + *wbuf)) != FLASH_SUCCESS) {
+            return;
+        }
+        rpc->script = *wbuf;
+        rpc->scriptOffset = 0;
+        return;
+    case MESSAGES_TOPIC_SCRIPT_SUBTOPIC_CLOSE:
+        if (write->len != 1) {
+            return;
+        }
+        if (rpc->script == 0xff || rpc->script != *wbuf) {
+            return;
+        }
+        rpc->script = 0xff;
+        rpc->scriptOffset = 0;
+        return;
+    case MESSAGES_TOPIC_SCRIPT_SUBTOPIC_WRITE:
+        if (write->len < 3 || (write->len % 2) != 1) {
+            return;
+        }
+        if (rpc->script == 0xff || rpc->script != *wbuf) {
+            return;
+        }
+        wbuf += 1;
+        wlen = write->len - 1;
+        if (storageWrite((kStoragePageType)(kStoragePageScript0 + rpc->script), rpc->scriptOffset, wbuf, wlen) != FLASH_SUCCESS) {
+            rpc->script = 0xff;
+            rpc->scriptOffset = 0;
+            return;
+        }
+        rpc->scriptOffset += wlen;
+        return;
+    default:
+        break;
+    }
+    return;
+}
+
+static void
+rpcRecvWriteJoystick(rpc_t *rpc, const message_write_t *write)
+{
+    (void)rpc;
+    joystickProfile_t profile;
+    uint16_t value16;
+    uint8_t *wbuf = write->value;
+    uint8_t i;
+    if (write->subtopic == MESSAGES_TOPIC_JOYSTICK_SUBTOPIC_SELECT) {
+        if (write->len != 1) {
+            return;
+        }
+        (void)joystickSelect(*wbuf);
+        return;
+    }
+    if (write->subtopic >= JOYSTICK_PROFILES || write->len != (JOYSTICK_NAME + JOYSTICK_AXES * 6)) {
+        return;
+    }
+    (void)memcpy(profile.name, wbuf, JOYSTICK_NAME);
+    wbuf += JOYSTICK_NAME;
+    for (i = 0; i < JOYSTICK_AXES; i++) {
+        profile.axes[i].deadband = wbuf[0];
+        profile.axes[i].expo = wbuf[1];
+        profile.axes[i].scale = wbuf[2];
+        profile.axes[i].slow = wbuf[3];
+        (void)memcpy(&value16, &wbuf[4], 2);
+        profile.axes[i].rate = (uint16_t)(ntohs(value16));
+        wbuf += 6;
+    }
+    (void)joystickSetProfile(write->subtopic, &profile);
+    return;
+}
+
+// writing a rule to a system starts its autotune, the gains are saved with
+// a write to the save subtopic once the read shows it is done
+static void
+rpcRecvWriteTune(rpc_t *rpc, const message_write_t *write)
+{
+    (void)rpc;
+    if (write->subtopic == MESSAGES_TOPIC_TUNE_SUBTOPIC_SAVE) {
+        (void)tuneSave();
+        return;
+    }
+    if (write->subtopic >= kTuneSystemNumber || write->len != 1) {
+        return;
+    }
+    (void)tuneStart((tuneSystem_t)write->subtopic, (tPidTuneRule)(*write->value));
+    return;
+}
+
 static void
 rpcRecvSubscribe(rpc_t *rpc, const message_subscribe_t *subscribe)
 {
@@ -785,3 +1145,167 @@ rpcSubReset(rpcSubscription_t *sub)
     sub->topic = 0;
     sub->subtopic = 0;
 }
+
+static uint8_t
+rpcPoseValue(rpc_t *rpc)
+{
+    pose_t pose;
+    uint32_t value32;
+    uint8_t *tbuf = (void *)rpc->tmp;
+    uint8_t tlen = 0;
+    (void)odometryGet(&pose);
+    value32 = (uint32_t)(htonl((uint32_t)pose.x));
+    (void)memcpy(tbuf, &value32, 4);
+    tbuf += 4;
+    tlen += 4;
+    value32 = (uint32_t)(htonl((uint32_t)pose.y));
+    (void)memcpy(tbuf, &value32, 4);
+    tbuf += 4;
+    tlen += 4;
+    value32 = (uint32_t)(htonl((uint32_t)pose.heading));
+    (void)memcpy(tbuf, &value32, 4);
+    tbuf += 4;
+    tlen += 4;
+    return tlen;
+}
+
+// smartmotor subtopics are the history window in the high nibble and the
+// source, a motor or SMLIB_HISTORY_BANK(bank), in the low nibble
+static bool
+rpcSmartmotorValid(uint8_t subtopic)
+{
+    return ((subtopic >> 4) < kSmartHistoryWindows && (subtopic & 0x0f) < SMLIB_HISTORY_SOURCES);
+}
+
+static uint8_t
+rpcSmartmotorValue(rpc_t *rpc, uint8_t subtopic)
+{
+    smartHistoryStats stats;
+    uint32_t value32;
+    uint16_t value16;
+    uint8_t *tbuf = (void *)rpc->tmp;
+    uint8_t tlen = 0;
+    uint8_t i;
+    (void)SmartMotorHistoryGet(subtopic & 0x0f, (tSmartHistoryWindow)(subtopic >> 4), &stats);
+    value32 = (uint32_t)(htonl(stats.samples));
+    (void)memcpy(tbuf, &value32, 4);
+    tbuf += 4;
+    tlen += 4;
+    for (i = 0; i < kSmartHistoryNum; i++) {
+        value16 = (uint16_t)(htons(stats.min[i]));
+        (void)memcpy(&tbuf[0], &value16, 2);
+        value16 = (uint16_t)(htons(stats.max[i]));
+        (void)memcpy(&tbuf[2], &value16, 2);
+        value16 = (uint16_t)(htons(stats.mean[i]));
+        (void)memcpy(&tbuf[4], &value16, 2);
+        tbuf += 6;
+        tlen += 6;
+    }
+    return tlen;
+}
+
+// predicted mS until each motor and then each bank PTC trips
+static uint8_t
+rpcSmartmotorTripValue(rpc_t *rpc)
+{
+    uint32_t value32;
+    uint8_t *tbuf = (void *)rpc->tmp;
+    uint8_t tlen = 0;
+    int16_t i;
+    for (i = 0; i < SMLIB_HISTORY_SOURCES; i++) {
+        if (i < kVexMotorNum) {
+            value32 = (uint32_t)(htonl(SmartMotorGetTripTime(i)));
+        } else {
+            value32 = (uint32_t)(htonl(SmartMotorGetControllerTripTime(i - kVexMotorNum)));
+        }
+        (void)memcpy(tbuf, &value32, 4);
+        tbuf += 4;
+        tlen += 4;
+    }
+    return tlen;
+}
+
+static uint8_t
+rpcTraceValue(rpc_t *rpc, uint8_t stage)
+{
+    vexTraceStats stats;
+    uint32_t value32;
+    uint16_t value16;
+    uint8_t *tbuf = (void *)rpc->tmp;
+    uint8_t tlen = 0;
+    (void)vexTraceGetStats((tVexTraceStage)stage, &stats);
+    value32 = (uint32_t)(htonl(stats.count));
+    (void)memcpy(tbuf, &value32, 4);
+    tbuf += 4;
+    tlen += 4;
+    value16 = (uint16_t)(htons(stats.p50));
+    (void)memcpy(tbuf, &value16, 2);
+    tbuf += 2;
+    tlen += 2;
+    value16 = (uint16_t)(htons(stats.p90));
+    (void)memcpy(tbuf, &value16, 2);
+    tbuf += 2;
+    tlen += 2;
+    value16 = (uint16_t)(htons(stats.p99));
+    (void)memcpy(tbuf, &value16, 2);
+    tbuf += 2;
+    tlen += 2;
+    value16 = (uint16_t)(htons(stats.max));
+    (void)memcpy(tbuf, &value16, 2);
+    tbuf += 2;
+    tlen += 2;
+    return tlen;
+}
+
+static uint8_t
+rpcJoystickValue(rpc_t *rpc, uint8_t profile)
+{
+    const joystickProfile_t *value = joystickGetProfile(profile);
+    uint16_t value16;
+    uint8_t *tbuf = (void *)rpc->tmp;
+    uint8_t tlen = 0;
+    uint8_t i;
+    (void)memcpy(tbuf, value->name, JOYSTICK_NAME);
+    tbuf += JOYSTICK_NAME;
+    tlen += JOYSTICK_NAME;
+    for (i = 0; i < JOYSTICK_AXES; i++) {
+        tbuf[0] = value->axes[i].deadband;
+        tbuf[1] = value->axes[i].expo;
+        tbuf[2] = value->axes[i].scale;
+        tbuf[3] = value->axes[i].slow;
+        value16 = (uint16_t)(htons(value->axes[i].rate));
+        (void)memcpy(&tbuf[4], &value16, 2);
+        tbuf += 6;
+        tlen += 6;
+    }
+    return tlen;
+}
+
+// tune values are the state and rule, Ku in 1/1000 command per count, Pu
+// in ms, then Kp, Ki and Kd in millionths
+static uint8_t
+rpcTuneValue(rpc_t *rpc, uint8_t system)
+{
+    const tuneGains_t *gains = tuneGetGains((tuneSystem_t)system);
+    int32_t values[5];
+    uint32_t value32;
+    uint8_t *tbuf = (void *)rpc->tmp;
+    uint8_t tlen = 0;
+    uint8_t i;
+    tbuf[0] = (uint8_t)tuneState((tuneSystem_t)system);
+    tbuf[1] = gains->valid ? gains->rule : 0xff;
+    tbuf += 2;
+    tlen += 2;
+    values[0] = (int32_t)(gains->Ku * 1000.0f);
+    values[1] = (int32_t)(gains->Pu * 1000.0f);
+    values[2] = (int32_t)(gains->Kp * 1000000.0f);
+    values[3] = (int32_t)(gains->Ki * 1000000.0f);
+    values[4] = (int32_t)(gains->Kd * 1000000.0f);
+    for (i = 0; i < 5; i++) {
+        value32 = (uint32_t)(htonl((uint32_t)values[i]));
+        (void)memcpy(tbuf, &value32, 4);
+        tbuf += 4;
+        tlen += 4;
+    }
+    return tlen;
+}
@@ -0,0 +1,210 @@
+// -*- mode: c; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*-----------------------------------------------------------------------------*/
+/** @file    sensors.c                                                         */
+/** @brief   Coherent snapshot of all sensors, taken once per control cycle    */
+/*-----------------------------------------------------------------------------*/
+
+#include "sensors.h"
+
+#include <string.h>
+
+// storage for sensors
+static sensors_t sensors;
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get pointer to sensors structure                               */
+/** @return     A sensors_t pointer                                            */
+/*-----------------------------------------------------------------------------*/
+sensors_t *
+sensorsGetPtr(void)
+{
+    return (&sensors);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Map each sensor to where its value is kept in a snapshot       */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The digital pins are configured in vexUserSetup, before any system is
+ *  initialized, so the type of each pin is only looked up once.
+ */
+void
+sensorsInit(void)
+{
+    sensorsMap_t *map;
+    int i;
+
+    (void)memset(&sensors, 0, sizeof(sensors_t));
+
+    for (i = 0; i < SENSORS_NUM; i++) {
+        map = &sensors.map[i];
+        if (i <= kVexSensorAnalog_8) {
+            map->kind = kSensorsAnalog;
+            map->channel = (uint8_t)(i - kVexSensorAnalog_1);
+        } else if (i <= kVexSensorDigital_12) {
+            tVexDigitalPin pin = (tVexDigitalPin)(i - kVexSensorDigital_1);
+            switch (vexDigitalTypeGet(pin)) {
+            case kVexSensorDigitalInput:
+            case kVexSensorDigitalOutput:
+            case kVexSensorInterrupt:
+                map->kind = kSensorsDigital;
+                map->channel = (uint8_t)pin;
+                break;
+            case kVexSensorQuadEncoder:
+                map->kind = kSensorsEncoder;
+                map->channel = (uint8_t)vexDigitalChannelGet(pin);
+                break;
+            case kVexSensorSonarCm:
+                map->kind = kSensorsSonarCm;
+                map->channel = (uint8_t)vexDigitalChannelGet(pin);
+                break;
+            case kVexSensorSonarInch:
+                map->kind = kSensorsSonarInch;
+                map->channel = (uint8_t)vexDigitalChannelGet(pin);
+                break;
+            default:
+                map->kind = kSensorsNone;
+                break;
+            }
+        } else {
+            map->kind = kSensorsIme;
+            map->channel = (uint8_t)(i - kVexSensorIme_1);
+        }
+    }
+
+    sensorsStep();
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Take the snapshot for this control cycle                       */
+/*-----------------------------------------------------------------------------*/
+void
+sensorsStep(void)
+{
+    sensorsTake(&sensors.snapshot);
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Take a snapshot of all sensors                                 */
+/** @param[out] snapshot The snapshot to fill in                               */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The values are copied with the system locked so no encoder or sonar
+ *  interrupt lands part way through, they are all plain reads of values
+ *  kept up to date by the interrupts and the ADC DMA.  Loops that run at
+ *  their own rate, rather than from the control executive, can take their
+ *  own snapshot.
+ */
+void
+sensorsTake(sensorsSnapshot_t *snapshot)
+{
+    uint16_t digital = 0;
+    int i;
+
+    chSysLock();
+    snapshot->time = chTimeNow();
+    snapshot->counter = halGetCounterValue();
+    for (i = kVexDigital_1; i <= kVexDigital_12; i++) {
+        if (vexDigitalPinGet((tVexDigitalPin)i) == kVexDigitalHigh) {
+            digital |= (uint16_t)(1 << i);
+        }
+    }
+    snapshot->digital = digital;
+    for (i = kVexAnalog_1; i <= kVexAnalog_8; i++) {
+        snapshot->analog[i] = vexAdcGet(i);
+    }
+    for (i = 0; i < kVexQuadEncoder_Num; i++) {
+        snapshot->encoder[i] = vexEncoderGet(i);
+    }
+    for (i = 0; i < kVexSonar_Num; i++) {
+        snapshot->sonar[i] = vexSonarGetCm((tVexSonarChannel)i);
+    }
+    for (i = 0; i < SENSORS_IME_NUM; i++) {
+        snapshot->ime[i] = vexImeGetCount(i);
+    }
+    snapshot->gyro = vexGyroGet();
+    snapshot->sequence++;
+    chSysUnlock();
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the snapshot of the current control cycle                  */
+/** @return     A pointer to the snapshot                                      */
+/*-----------------------------------------------------------------------------*/
+const sensorsSnapshot_t *
+sensorsGet(void)
+{
+    return &sensors.snapshot;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get a value from a snapshot as vexSensorValueGet would         */
+/** @param[in]  snapshot The snapshot                                          */
+/** @param[in]  sensor A sensor of type tVexSensors                            */
+/** @return     The value of the sensor                                        */
+/*-----------------------------------------------------------------------------*/
+int32_t
+sensorsValue(const sensorsSnapshot_t *snapshot, tVexSensors sensor)
+{
+    const sensorsMap_t *map;
+
+    if ((unsigned int)sensor >= SENSORS_NUM) {
+        return 0;
+    }
+    map = &sensors.map[sensor];
+    switch (map->kind) {
+    case kSensorsAnalog:
+        return snapshot->analog[map->channel];
+    case kSensorsDigital:
+        return (snapshot->digital >> map->channel) & 1;
+    case kSensorsEncoder:
+        return snapshot->encoder[map->channel];
+    case kSensorsSonarCm:
+        return snapshot->sonar[map->channel];
+    case kSensorsSonarInch:
+        // worked out from the distance in cm
+        return (snapshot->sonar[map->channel] < 0) ? -1 : (snapshot->sonar[map->channel] * 100) / 254;
+    case kSensorsIme:
+        return snapshot->ime[map->channel];
+    default:
+        return 0;
+    }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Shell command to show the snapshot of the current cycle        */
+/*-----------------------------------------------------------------------------*/
+void
+sensorsDebug(vexStream *chp, int argc, char *argv[])
+{
+    const sensorsSnapshot_t *snapshot = &sensors.snapshot;
+    int i;
+
+    (void)argc;
+    (void)argv;
+
+    vex_chprintf(chp, "snapshot %lu at %lu ms, gyro %ld\r\n", snapshot->sequence,
+                 (uint32_t)((snapshot->time * 1000) / CH_FREQUENCY), snapshot->gyro);
+    vex_chprintf(chp, "digital %03x\r\nanalog ", snapshot->digital);
+    for (i = kVexAnalog_1; i <= kVexAnalog_8; i++) {
+        vex_chprintf(chp, " %4d", snapshot->analog[i]);
+    }
+    vex_chprintf(chp, "\r\nencoder");
+    for (i = 0; i < kVexQuadEncoder_Num; i++) {
+        vex_chprintf(chp, " %ld", snapshot->encoder[i]);
+    }
+    vex_chprintf(chp, "\r\nsonar  ");
+    for (i = 0; i < kVexSonar_Num; i++) {
+        vex_chprintf(chp, " %d", snapshot->sonar[i]);
+    }
+    vex_chprintf(chp, "\r\nime    ");
+    for (i = 0; i < SENSORS_IME_NUM; i++) {
+        vex_chprintf(chp, " %ld", snapshot->ime[i]);
+    }
+    vex_chprintf(chp, "\r\n");
+    return;
+}
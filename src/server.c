@@ -230,6 +230,8 @@ serverCheckConnection(server_t *srv)
             }
             srv->rpc.cassette = 0xff;
             srv->rpc.fp = NULL;
+            srv->rpc.script = 0xff;
+            srv->rpc.scriptOffset = 0;
             srv->state = serverStateConnected;
         }
     } else if (srv->state == serverStateConnected) {
@@ -6,6 +6,9 @@
 /*-----------------------------------------------------------------------------*/
 
 #include "setter.h"
+#include "curve.h"
+#include "joystick.h"
+#include "system.h"
 
 #include <math.h>
 #include <stdlib.h>
@@ -13,47 +16,15 @@
 // storage for setter
 static setter_t setter;
 
-// working area for setter task
-static WORKING_AREA(waSetter, 512);
-
-// private functions
-static msg_t setterThread(void *arg);
-
-// setter speed adjustment
-#define USE_SETTER_SPEED_TABLE 1
-#ifdef USE_SETTER_SPEED_TABLE
-
-const unsigned int setterSpeedTable[128] = {
-    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  21, 21, 21, 22, 22, 22, 23, 24, 24, 25, 25,  25,  25, 26, 27,
-    27, 28, 28, 28, 28, 29, 30, 30, 30, 31, 31, 32, 32, 32, 33, 33, 34, 34, 35, 35, 35, 36,  36,  37, 37, 37,
-    37, 38, 38, 39, 39, 39, 40, 40, 41, 41, 42, 42, 43, 44, 44, 45, 45, 46, 46, 47, 47, 48,  48,  49, 50, 50,
-    51, 52, 52, 53, 54, 55, 56, 57, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 67, 68, 70,  71,  72, 72, 73,
-    74, 76, 77, 78, 79, 79, 80, 81, 83, 84, 84, 86, 86, 87, 87, 88, 88, 89, 89, 90, 90, 127, 127, 127};
+// setter response curve
+#define SETTER_CURVE kCurveStandard
 
 static inline int
 setterSpeed(int speed)
 {
-    if (speed > 50)
-        speed = 50;
-    else if (speed < -50)
-        speed = -50;
-    return (((speed > 0) - (speed < 0)) * setterSpeedTable[abs(speed)]);
+    return curveApply(SETTER_CURVE, speed);
 }
 
-#else
-
-static inline int
-setterSpeed(int speed)
-{
-    if (speed > 50)
-        speed = 50;
-    else if (speed < -50)
-        speed = -50;
-    return (speed);
-}
-
-#endif
-
 /*-----------------------------------------------------------------------------*/
 /** @brief      Get pointer to setter structure - not used locally             */
 /** @return     A setter_t pointer                                             */
@@ -85,16 +56,6 @@ setterInit(void)
     return;
 }
 
-/*-----------------------------------------------------------------------------*/
-/** @brief      Start the setter system thread                                 */
-/*-----------------------------------------------------------------------------*/
-void
-setterStart(void)
-{
-    chThdCreateStatic(waSetter, sizeof(waSetter), NORMALPRIO - 1, setterThread, NULL);
-    return;
-}
-
 static inline int
 limitSpeed(int speed, int limit)
 {
@@ -105,38 +66,25 @@ limitSpeed(int speed, int limit)
 }
 
 /*-----------------------------------------------------------------------------*/
-/** @brief      The setter system thread                                       */
-/** @param[in]  arg Unused                                                     */
-/** @return     (msg_t) 0                                                      */
+/** @brief      Run one control step of the setter system                     */
 /*-----------------------------------------------------------------------------*/
-static msg_t
-setterThread(void *arg)
+void
+setterStep(void)
 {
     int16_t setterCmd = 0;
     bool immediate = true;
 
-    // Unused
-    (void)arg;
-
-    // Register the task
-    vexTaskRegister("setter");
-
-    while (!chThdShouldTerminate()) {
-        if (setter.locked) {
-            setterCmd = 20;
+    if (setter.locked) {
+        setterCmd = 20;
 
-            if (!vexControllerGet(Btn7RXmtr2)) {
-                setterCmd = vexControllerGet(Ch2Xmtr2);
-            }
-            setterCmd = setterSpeed(limitSpeed(setterCmd, 20));
-            setterMove(setterCmd, immediate);
+        if (!systemControllerGet(Btn7RXmtr2)) {
+            setterCmd = joystickGet(Ch2Xmtr2);
         }
-
-        // Don't hog cpu
-        vexSleep(25);
+        setterCmd = setterSpeed(limitSpeed(setterCmd, 20));
+        setterMove(setterCmd, immediate);
     }
 
-    return ((msg_t)0);
+    return;
 }
 
 void
@@ -0,0 +1,99 @@
+// -*- mode: c; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*-----------------------------------------------------------------------------*/
+/** @file    storage.c                                                         */
+/** @brief   Whole page flash storage for the robot                            */
+/*-----------------------------------------------------------------------------*/
+
+#include "storage.h"
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the address of a storage page                              */
+/** @param[in]  page The storage page                                          */
+/** @return     A pointer to the start of the page or NULL                     */
+/*-----------------------------------------------------------------------------*/
+const void *
+storageAddress(kStoragePageType page)
+{
+    if ((unsigned int)page >= kStoragePageNumber) {
+        return NULL;
+    }
+    return (const void *)(STORAGE_PAGE_TOP - ((uint32_t)(page + 1) * STORAGE_PAGE_SIZE));
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Erase a storage page                                           */
+/** @param[in]  page The storage page                                          */
+/** @return     FLASH_SUCCESS or an error code                                 */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The CPU stalls while the page is erased (about 20ms), do not call this
+ *  while the robot is moving.
+ */
+int16_t
+storageErase(kStoragePageType page)
+{
+    const void *addr = storageAddress(page);
+    FLASH_Status status;
+
+    if (addr == NULL) {
+        return FLASH_ERROR;
+    }
+
+    FLASH_UnlockBank1();
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
+    status = FLASH_ErasePage((uint32_t)addr);
+    FLASH_LockBank1();
+
+    if (status != FLASH_COMPLETE) {
+        return FLASH_ERROR_ERASE;
+    }
+    return FLASH_SUCCESS;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Write data to an erased area of a storage page                 */
+/** @param[in]  page The storage page                                          */
+/** @param[in]  offset Byte offset into the page, must be even                 */
+/** @param[in]  data The data to write                                         */
+/** @param[in]  len The number of bytes to write                               */
+/** @return     FLASH_SUCCESS or an error code                                 */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Flash is programmed a half word at a time, an odd trailing byte is
+ *  padded with 0xff.
+ */
+int16_t
+storageWrite(kStoragePageType page, uint16_t offset, const void *data, uint16_t len)
+{
+    const void *addr = storageAddress(page);
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t dst;
+    uint16_t half;
+    uint16_t i;
+    FLASH_Status status = FLASH_COMPLETE;
+
+    if (addr == NULL || data == NULL || (offset & 1) != 0) {
+        return FLASH_ERROR;
+    }
+    if (((uint32_t)offset + len) > STORAGE_PAGE_SIZE) {
+        return FLASH_ERROR_WRITE_LIMIT;
+    }
+
+    FLASH_UnlockBank1();
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
+
+    dst = (uint32_t)addr + offset;
+    for (i = 0; i < len && status == FLASH_COMPLETE; i += 2) {
+        half = p[i];
+        half |= (uint16_t)(((i + 1) < len) ? p[i + 1] : 0xff) << 8;
+        status = FLASH_ProgramHalfWord(dst + i, half);
+    }
+
+    FLASH_LockBank1();
+
+    if (status != FLASH_COMPLETE) {
+        return FLASH_ERROR_WRITE;
+    }
+    return FLASH_SUCCESS;
+}
@@ -13,22 +13,34 @@
 #include "drive.h"
 #include "intake.h"
 #include "flipper.h"
+#include "joystick.h"
 #include "lift.h"
+#include "sensors.h"
 #include "setter.h"
 
-// storage for system manager
+// storage for system manager, steps run in this order
 static const system_t systems[] = {
-    {true, lcdInit, lcdStart, NULL, NULL},
-    {true, armInit, armStart, armLock, armUnlock},
-    {true, driveInit, driveStart, driveLock, driveUnlock},
-    {true, intakeInit, intakeStart, intakeLock, intakeUnlock},
-    {true, flipperInit, flipperStart, flipperLock, flipperUnlock},
-    {true, liftInit, liftStart, liftLock, liftUnlock},
-    {true, setterInit, setterStart, setterLock, setterUnlock},
-    {false, NULL, NULL, NULL, NULL},
+    {true, lcdInit, lcdStart, NULL, NULL, NULL, "lcd"},
+    {true, sensorsInit, NULL, NULL, NULL, sensorsStep, "sensors"},
+    {true, joystickInit, NULL, NULL, NULL, joystickStep, "joystick"},
+    {true, armInit, NULL, armLock, armUnlock, armStep, "arm"},
+    {true, driveInit, NULL, driveLock, driveUnlock, driveStep, "drive"},
+    {true, intakeInit, NULL, intakeLock, intakeUnlock, intakeStep, "intake"},
+    {true, flipperInit, NULL, flipperLock, flipperUnlock, flipperStep, "flipper"},
+    {true, liftInit, NULL, liftLock, liftUnlock, liftStep, "lift"},
+    {true, setterInit, NULL, setterLock, setterUnlock, setterStep, "setter"},
+    {false, NULL, NULL, NULL, NULL, NULL, NULL},
 };
 
+// storage for control executive
+static systemExecutive_t executive;
+
+// working area for control executive task
+static WORKING_AREA(waSystem, 512);
+
 static bool systemIsEmpty(const system_t *system);
+static msg_t systemThread(void *arg);
+static void systemReport(int index, uint32_t cycle);
 
 /*-----------------------------------------------------------------------------*/
 /** @brief      Initialize all enabled systems                                 */
@@ -47,7 +59,7 @@ systemInitAll(void)
 }
 
 /*-----------------------------------------------------------------------------*/
-/** @brief      Start all enabled systems                                      */
+/** @brief      Start all enabled systems and the control executive            */
 /*-----------------------------------------------------------------------------*/
 void
 systemStartAll(void)
@@ -59,6 +71,7 @@ systemStartAll(void)
         }
         system++;
     }
+    chThdCreateStatic(waSystem, sizeof(waSystem), NORMALPRIO - 1, systemThread, NULL);
     return;
 }
 
@@ -94,12 +107,186 @@ systemUnlockAll(void)
     return;
 }
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get pointer to control executive structure                     */
+/** @return     A systemExecutive_t pointer                                    */
+/*-----------------------------------------------------------------------------*/
+systemExecutive_t *
+systemGetPtr(void)
+{
+    return (&executive);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get controller data from the frame of the current cycle        */
+/** @param[in]  index The required controller variable eg. Btn8U               */
+/** @return     The requested controller data                                  */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  System steps read the controls with this instead of vexControllerGet so
+ *  every step in a cycle sees the same frame, even if the SPI exchange
+ *  delivers a new one while the steps are running.
+ */
+int16_t
+systemControllerGet(tCtlIndex index)
+{
+    return vexControllerFrameGet(&executive.frame, index);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Shell command to show the control executive timing             */
+/*-----------------------------------------------------------------------------*/
+void
+systemDebug(vexStream *chp, int argc, char *argv[])
+{
+    const system_t *system = systems;
+    int i = 0;
+
+    (void)argc;
+    (void)argv;
+
+    vex_chprintf(chp, "frame %lu, %lu cycles, %lu timeouts, %lu missed, %lu overruns\r\n", executive.frame.sequence,
+                 executive.cycles, executive.timeouts, executive.missed, executive.overruns);
+    while (!systemIsEmpty(system) && i < SYSTEM_MAX) {
+        if (system->step != NULL) {
+            vex_chprintf(chp, "%-8s %6lu us %6lu us\r\n", system->name, executive.timing[i].last, executive.timing[i].worst);
+        }
+        system++;
+        i++;
+    }
+    vex_chprintf(chp, "%-8s %6lu us %6lu us\r\n", "total", executive.cycle.last, executive.cycle.worst);
+    vex_chprintf(chp, "%-8s %6lu us %6lu us\r\n", "latency", executive.latency.last, executive.latency.worst);
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      The control executive thread                                   */
+/** @param[in]  arg Unused                                                     */
+/** @return     (msg_t) 0                                                      */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Replaces a thread per system, the thread wakes on the frame event from
+ *  the SPI exchange so each system step sees a new controller frame and
+ *  sets its motors once per frame.  Without frames, for example while the
+ *  master processor is offline, the steps run every SYSTEM_PERIOD instead.
+ */
+static msg_t
+systemThread(void *arg)
+{
+    const system_t *system;
+    EventListener frameListener;
+    eventmask_t events;
+    uint32_t cyclesPerUs = halGetCounterFrequency() / 1000000;
+    uint32_t sequence;
+    uint32_t start;
+    uint32_t begin;
+    uint32_t elapsed;
+    bool fresh;
+    int slowest;
+    int i;
+
+    // Unused
+    (void)arg;
+
+    // Register the task
+    vexTaskRegister("control");
+
+    chEvtRegisterMask(vexSpiGetFrameEventSource(), &frameListener, SYSTEM_EVENT_FRAME);
+    sequence = vexSpiGetFrameSequence();
+
+    while (!chThdShouldTerminate()) {
+        events = chEvtWaitAnyTimeout(SYSTEM_EVENT_FRAME | SYSTEM_EVENT_TERMINATE, MS2ST(SYSTEM_PERIOD));
+        if ((events & SYSTEM_EVENT_TERMINATE) != 0 || chThdShouldTerminate()) {
+            // hand the terminate request back to vexSleep so the task is
+            // unregistered the same way as every other task
+            chEvtUnregister(vexSpiGetFrameEventSource(), &frameListener);
+            chEvtAddEvents(SYSTEM_EVENT_TERMINATE);
+            vexSleep(0);
+            chEvtRegisterMask(vexSpiGetFrameEventSource(), &frameListener, SYSTEM_EVENT_FRAME);
+        }
+        if (events == 0) {
+            executive.timeouts++;
+        }
+
+        // every step in this cycle works from the same frame
+        vexSpiGetFrame(&executive.frame);
+        vexTracePoint(kVexTraceControl);
+        fresh = (executive.frame.sequence != sequence);
+        if (fresh && (executive.frame.sequence - sequence) > 1) {
+            executive.missed += executive.frame.sequence - sequence - 1;
+        }
+
+        system = systems;
+        slowest = -1;
+        i = 0;
+        begin = halGetCounterValue();
+        while (!systemIsEmpty(system) && i < SYSTEM_MAX) {
+            if (system->enabled == true && system->step != NULL) {
+                start = halGetCounterValue();
+                system->step();
+                elapsed = (halGetCounterValue() - start) / cyclesPerUs;
+                executive.timing[i].last = elapsed;
+                if (elapsed > executive.timing[i].worst) {
+                    executive.timing[i].worst = elapsed;
+                }
+                if (slowest < 0 || elapsed > executive.timing[slowest].last) {
+                    slowest = i;
+                }
+            }
+            system++;
+            i++;
+        }
+        elapsed = (halGetCounterValue() - begin) / cyclesPerUs;
+        executive.cycle.last = elapsed;
+        if (elapsed > executive.cycle.worst) {
+            executive.cycle.worst = elapsed;
+        }
+        executive.cycles++;
+
+        if (fresh) {
+            // time from the frame arriving to the last motor being set
+            elapsed = (halGetCounterValue() - executive.frame.counter) / cyclesPerUs;
+            executive.latency.last = elapsed;
+            if (elapsed > executive.latency.worst) {
+                executive.latency.worst = elapsed;
+            }
+        }
+
+        // a fresh frame cycle overran if the next frame is already waiting
+        if ((fresh && vexSpiGetFrameSequence() != executive.frame.sequence) || executive.cycle.last > (SYSTEM_PERIOD * 1000)) {
+            executive.overruns++;
+            systemReport(slowest, executive.cycle.last);
+        }
+        sequence = executive.frame.sequence;
+    }
+
+    chEvtUnregister(vexSpiGetFrameEventSource(), &frameListener);
+
+    return ((msg_t)0);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Report an overrun, at most once a second                       */
+/*-----------------------------------------------------------------------------*/
+static void
+systemReport(int index, uint32_t cycle)
+{
+    if (executive.reported != 0 && chTimeElapsedSince(executive.reported) < MS2ST(1000)) {
+        return;
+    }
+    executive.reported = chTimeNow();
+    vex_printf("system: overrun %lu, cycle %lu us, slowest %s %lu us\r\n", executive.overruns, cycle,
+               (index >= 0) ? systems[index].name : "none", (index >= 0) ? executive.timing[index].last : 0);
+    return;
+}
+
 // Inline functions
 
 inline bool
 systemIsEmpty(const system_t *system)
 {
-    if (system == NULL || (system->init == NULL && system->start == NULL && system->lock == NULL && system->unlock == NULL)) {
+    if (system == NULL || (system->init == NULL && system->start == NULL && system->lock == NULL && system->unlock == NULL &&
+                           system->step == NULL)) {
         return true;
     } else {
         return false;
@@ -0,0 +1,114 @@
+// -*- mode: c; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*-----------------------------------------------------------------------------*/
+/** @file    ticker.c                                                          */
+/** @brief   Absolute deadline periodic ticker                                 */
+/*-----------------------------------------------------------------------------*/
+
+#include "ticker.h"
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Start a ticker, the first deadline is one period from now      */
+/** @param[in]  ticker The ticker to start                                     */
+/** @param[in]  periodMs The period of the ticker in ms                        */
+/*-----------------------------------------------------------------------------*/
+void
+tickerInit(ticker_t *ticker, uint32_t periodMs)
+{
+    ticker->period = MS2ST(periodMs);
+    if (ticker->period == 0) {
+        ticker->period = 1;
+    }
+    ticker->epoch = chTimeNow();
+    ticker->deadline = ticker->epoch;
+    ticker->count = 0;
+    ticker->overruns = 0;
+    ticker->late = 0;
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Sleep until the next deadline of the ticker                    */
+/** @param[in]  ticker The ticker                                              */
+/** @return     false if the deadline had already been missed                  */
+/*-----------------------------------------------------------------------------*/
+bool
+tickerWait(ticker_t *ticker)
+{
+    return tickerWaitBounded(ticker, ticker->deadline + ticker->period);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Sleep until the next deadline, but never beyond limit          */
+/** @param[in]  ticker The ticker                                              */
+/** @param[in]  limit An absolute time the next deadline is clamped to         */
+/** @return     false if the deadline had already been missed                  */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  When the deadline is clamped to limit the following deadlines are one
+ *  period apart from limit, this lets a caller align the ticker with the
+ *  end of a step without waiting for the rest of the period.
+ */
+bool
+tickerWaitBounded(ticker_t *ticker, systime_t limit)
+{
+    systime_t next = ticker->deadline + ticker->period;
+    systime_t now;
+    systime_t late;
+    bool onTime = true;
+
+    if ((int32_t)(limit - ticker->deadline) < (int32_t)ticker->period) {
+        next = limit;
+    }
+
+    now = chTimeNow();
+    if ((int32_t)(next - now) < 0) {
+        // we missed the deadline, skip any whole periods that were lost
+        // rather than running back to back to catch up
+        late = now - next;
+        if (late > ticker->late) {
+            ticker->late = late;
+        }
+        ticker->overruns++;
+        next += (late / ticker->period) * ticker->period;
+        onTime = false;
+    }
+
+    tickerSleepUntil(next);
+    ticker->deadline = next;
+    ticker->count++;
+
+    return onTime;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Time since the ticker was started                              */
+/** @param[in]  ticker The ticker                                              */
+/** @return     The elapsed time in system ticks                               */
+/*-----------------------------------------------------------------------------*/
+systime_t
+tickerElapsed(const ticker_t *ticker)
+{
+    return chTimeElapsedSince(ticker->epoch);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Sleep until an absolute system time                            */
+/** @param[in]  deadline The absolute system time to wake up at                */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  chThdSleepUntil would sleep for almost a full wrap of the system timer if
+ *  the deadline had already passed, and it does not notice the terminate
+ *  event used by the competition monitor.  Sleep on vexSleep for whatever is
+ *  left until the deadline instead, the deadline itself stays absolute.
+ */
+void
+tickerSleepUntil(systime_t deadline)
+{
+    int32_t remaining = (int32_t)(deadline - chTimeNow());
+    if (remaining < 0) {
+        remaining = 0;
+    }
+    vexSleep((remaining * 1000) / CH_FREQUENCY);
+    return;
+}
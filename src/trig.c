@@ -0,0 +1,64 @@
+// -*- mode: c; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*-----------------------------------------------------------------------------*/
+/** @file    trig.c                                                            */
+/** @brief   Fixed point sin and cos                                           */
+/*-----------------------------------------------------------------------------*/
+
+#include "trig.h"
+
+// sin of 0 to 90 degrees in Q14
+static const int16_t trigSinTable[91] = {
+    0,     286,   572,   857,   1143,  1428,  1713,  1997,  2280,  2563,  2845,  3126,  3406,  3686,  3964,  4240,
+    4516,  4790,  5063,  5334,  5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,  8192,  8438,
+    8682,  8923,  9162,  9397,  9630,  9860,  10087, 10311, 10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982,
+    12176, 12365, 12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044, 14189, 14330, 14466, 14598,
+    14726, 14849, 14968, 15082, 15191, 15296, 15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+    16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382, 16384};
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Sine of an angle                                               */
+/** @param[in]  angle The angle in deg * 10                                    */
+/** @return     The sine in Q14                                                */
+/*-----------------------------------------------------------------------------*/
+int32_t
+trigSin(int32_t angle)
+{
+    int32_t index;
+    int32_t frac;
+    int32_t value;
+    bool negative = false;
+
+    angle %= 3600;
+    if (angle < 0) {
+        angle += 3600;
+    }
+    if (angle >= 1800) {
+        angle -= 1800;
+        negative = true;
+    }
+    if (angle > 900) {
+        angle = 1800 - angle;
+    }
+
+    // interpolate between whole degrees
+    index = angle / 10;
+    frac = angle % 10;
+    value = trigSinTable[index];
+    if (frac != 0) {
+        value += ((trigSinTable[index + 1] - value) * frac) / 10;
+    }
+
+    return negative ? -value : value;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Cosine of an angle                                             */
+/** @param[in]  angle The angle in deg * 10                                    */
+/** @return     The cosine in Q14                                              */
+/*-----------------------------------------------------------------------------*/
+int32_t
+trigCos(int32_t angle)
+{
+    return trigSin(angle + 900);
+}
@@ -0,0 +1,292 @@
+// -*- mode: c; tab-width: 4; indent-tabs-mode: nil; st-rulers: [132] -*-
+// vim: ts=4 sw=4 ft=c++ et
+/*-----------------------------------------------------------------------------*/
+/** @file    tune.c                                                            */
+/** @brief   Relay feedback autotuning of the position loops                   */
+/*-----------------------------------------------------------------------------*/
+
+#include "tune.h"
+#include "arm.h"
+#include "lift.h"
+
+#include <string.h>
+
+// storage for tune
+static tune_t tune;
+
+// private functions
+static pidController *tunePid(tuneSystem_t system);
+static void tuneApply(tuneSystem_t system);
+
+// names used by the shell, indexed by tuneSystem_t and tPidTuneRule
+static const char *const tuneSystemNames[kTuneSystemNumber] = {"arm", "lift"};
+static const char *const tuneRuleNames[kPidTuneRuleNum] = {"zn", "tl"};
+static const char *const tuneStateNames[] = {"idle", "running", "done", "failed"};
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get pointer to tune structure - not used locally               */
+/** @return     A tune_t pointer                                               */
+/*-----------------------------------------------------------------------------*/
+tune_t *
+tuneGetPtr(void)
+{
+    return (&tune);
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Load the saved gains and apply them to the position loops      */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Called after the systems are initialized, so their controllers exist.
+ */
+void
+tuneInit(void)
+{
+    const tuneStore_t *saved = (const tuneStore_t *)storageAddress(kStoragePageTune);
+    int i;
+
+    if (saved != NULL && saved->magic == TUNE_MAGIC && saved->version == TUNE_VERSION &&
+        saved->count == kTuneSystemNumber) {
+        (void)memcpy(&tune.store, saved, sizeof(tuneStore_t));
+    } else {
+        (void)memset(&tune.store, 0, sizeof(tuneStore_t));
+        tune.store.magic = TUNE_MAGIC;
+        tune.store.version = TUNE_VERSION;
+        tune.store.count = kTuneSystemNumber;
+    }
+    for (i = 0; i < kTuneSystemNumber; i++) {
+        tune.relay[i].state = kPidTuneIdle;
+        tuneApply((tuneSystem_t)i);
+    }
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Start a relay experiment around the current position           */
+/** @param[in]  system The system to tune                                      */
+/** @param[in]  rule The rule the gains are worked out with                    */
+/** @return     true if the system is now in its tune mode                     */
+/*-----------------------------------------------------------------------------*/
+bool
+tuneStart(tuneSystem_t system, tPidTuneRule rule)
+{
+    if ((unsigned int)system >= kTuneSystemNumber || (unsigned int)rule >= kPidTuneRuleNum) {
+        return false;
+    }
+    tune.rule[system] = rule;
+    tune.start[system] = chTimeNow();
+
+    // the relay is ready before the system hands it the motor
+    switch (system) {
+    case kTuneArm:
+        PidAutotuneInit(&tune.relay[system], armPosition(), TUNE_ARM_RELAY, TUNE_HYSTERESIS, TUNE_CYCLES);
+        armTune();
+        break;
+    case kTuneLift:
+        PidAutotuneInit(&tune.relay[system], liftPosition(), TUNE_LIFT_RELAY, TUNE_HYSTERESIS, TUNE_CYCLES);
+        if (!liftTune()) {
+            tune.relay[system].state = kPidTuneFailed;
+            return false;
+        }
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Run the relay, called from the step of the system              */
+/** @param[in]  system The system being tuned                                  */
+/** @param[in]  position The position of the system                           */
+/** @param[out] cmd The relay command while the relay is running              */
+/** @return     false once the relay has finished and the system is free       */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The new gains go to the controller of the system as soon as the relay
+ *  finishes, they are only written to flash by tuneSave.
+ */
+bool
+tuneStep(tuneSystem_t system, int32_t position, int16_t *cmd)
+{
+    pidAutotune *a = &tune.relay[system];
+    uint32_t t = (uint32_t)((chTimeElapsedSince(tune.start[system]) * 1000) / CH_FREQUENCY);
+    tuneGains_t *gains = &tune.store.gains[system];
+    pidController *pid = tunePid(system);
+
+    *cmd = PidAutotuneUpdate(a, position, t);
+    if (a->state == kPidTuneRunning) {
+        return true;
+    }
+    if (a->state == kPidTuneDone && PidAutotuneApply(a, tune.rule[system], pid)) {
+        gains->valid = 1;
+        gains->rule = (uint8_t)tune.rule[system];
+        gains->Kp = pid->Kp;
+        gains->Ki = pid->Ki;
+        gains->Kd = pid->Kd;
+        gains->Ku = a->Ku;
+        gains->Pu = a->Pu;
+    }
+    return false;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the state of the relay experiment of a system              */
+/** @param[in]  system The system                                              */
+/** @return     The state                                                      */
+/*-----------------------------------------------------------------------------*/
+tPidTuneState
+tuneState(tuneSystem_t system)
+{
+    if ((unsigned int)system >= kTuneSystemNumber) {
+        return kPidTuneIdle;
+    }
+    return (tPidTuneState)tune.relay[system].state;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Cancel the relay experiment of a system                        */
+/** @param[in]  system The system                                              */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Called by the system when it leaves its tune mode before the relay has
+ *  finished, for example when the driver moves it.  A cancelled relay reads
+ *  as failed and the gains are not changed.
+ */
+void
+tuneCancel(tuneSystem_t system)
+{
+    if ((unsigned int)system >= kTuneSystemNumber) {
+        return;
+    }
+    if (tune.relay[system].state == kPidTuneRunning) {
+        tune.relay[system].state = kPidTuneFailed;
+    }
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the gains of a system                                      */
+/** @param[in]  system The system                                              */
+/** @return     The gains or NULL                                              */
+/*-----------------------------------------------------------------------------*/
+const tuneGains_t *
+tuneGetGains(tuneSystem_t system)
+{
+    if ((unsigned int)system >= kTuneSystemNumber) {
+        return NULL;
+    }
+    return &tune.store.gains[system];
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Write the gains to flash                                       */
+/** @return     FLASH_SUCCESS or an error code                                 */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The CPU stalls while the page is erased, like it does for the LCD mode.
+ */
+int16_t
+tuneSave(void)
+{
+    int16_t status = storageErase(kStoragePageTune);
+
+    if (status != FLASH_SUCCESS) {
+        return status;
+    }
+    return storageWrite(kStoragePageTune, 0, &tune.store, sizeof(tuneStore_t));
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Shell command to show, run and save the autotune               */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  "tune" shows the gains, "tune arm zn" tunes the arm with the
+ *  Ziegler-Nichols rule and saves the gains once it has finished, "tune
+ *  save" saves the gains as they are.  A key stops the waiting.
+ */
+void
+tuneDebug(vexStream *chp, int argc, char *argv[])
+{
+    const tuneGains_t *gains;
+    tPidTuneRule rule = kPidTuneZieglerNichols;
+    int system;
+    int i;
+
+    if (argc > 0 && strcmp(argv[0], "save") == 0) {
+        vex_chprintf(chp, "save %s\r\n", (tuneSave() == FLASH_SUCCESS) ? "ok" : "failed");
+        return;
+    }
+
+    if (argc > 0) {
+        for (system = 0; system < kTuneSystemNumber; system++) {
+            if (strcmp(argv[0], tuneSystemNames[system]) == 0) {
+                break;
+            }
+        }
+        if (argc > 1) {
+            for (i = 0; i < kPidTuneRuleNum; i++) {
+                if (strcmp(argv[1], tuneRuleNames[i]) == 0) {
+                    rule = (tPidTuneRule)i;
+                }
+            }
+        }
+        if (system == kTuneSystemNumber || !tuneStart((tuneSystem_t)system, rule)) {
+            vex_chprintf(chp, "usage: tune [arm|lift [zn|tl]] | save\r\n");
+            return;
+        }
+        while (tuneState((tuneSystem_t)system) == kPidTuneRunning && sdGetWouldBlock((SerialDriver *)chp)) {
+            vexSleep(100);
+        }
+        if (tuneState((tuneSystem_t)system) == kPidTuneDone) {
+            (void)tuneSave();
+        }
+    }
+
+    for (i = 0; i < kTuneSystemNumber; i++) {
+        gains = &tune.store.gains[i];
+        vex_chprintf(chp, "%-4s %-7s", tuneSystemNames[i], tuneStateNames[tune.relay[i].state]);
+        if (gains->valid) {
+            vex_chprintf(chp, " %s Ku %.4f Pu %.3f Kp %.6f Ki %.6f Kd %.6f", tuneRuleNames[gains->rule], gains->Ku,
+                         gains->Pu, gains->Kp, gains->Ki, gains->Kd);
+        }
+        vex_chprintf(chp, "\r\n");
+    }
+    return;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the position loop of a system                              */
+/*-----------------------------------------------------------------------------*/
+static pidController *
+tunePid(tuneSystem_t system)
+{
+    switch (system) {
+    case kTuneArm:
+        return armGetPtr()->pid;
+    case kTuneLift:
+        return liftGetPtr()->pid;
+    default:
+        return NULL;
+    }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Apply saved gains to the position loop of a system             */
+/*-----------------------------------------------------------------------------*/
+static void
+tuneApply(tuneSystem_t system)
+{
+    const tuneGains_t *gains = &tune.store.gains[system];
+    pidController *pid = tunePid(system);
+
+    if (!gains->valid || pid == NULL) {
+        return;
+    }
+    pid->Kp = gains->Kp;
+    pid->Ki = gains->Ki;
+    pid->Kd = gains->Kd;
+    pid->integral = 0;
+    pid->integral_limit = (gains->Ki != 0) ? (PIDLIB_INTEGRAL_DRIVE_MAX / gains->Ki) : 0;
+    return;
+}
@@ -61,10 +61,14 @@
 #include "lift.h"
 #include "setter.h"
 #include "flipper.h"
+#include "tune.h"
 
+#include "odometry.h"
 #include "system.h"
 
 #include "autonomous.h"
+#include "autonomous/script.h"
+#include "autonomous/timer.h"
 
 // #include "server.h"
 
@@ -80,7 +84,7 @@ static vexDigiCfg dConfig[kVexDigital_Num] = {{kVexDigital_1, kVexSensorDigitalO
                                               {kVexDigital_9, kVexSensorDigitalInput, kVexConfigInput, 0},
                                               {kVexDigital_10, kVexSensorDigitalInput, kVexConfigInput, 0},
                                               {kVexDigital_11, kVexSensorQuadEncoder, kVexConfigQuadEnc1, kVexQuadEncoder_1},
-                                              {kVexDigital_12, kVexSensorQuadEncoder, kVexConfigQuadEnc2, kVexQuadEncoder_2}};
+                                              {kVexDigital_12, kVexSensorQuadEncoder, kVexConfigQuadEnc2, kVexQuadEncoder_1}};
 
 // Port 1 has no power expander
 // port 9 SW
@@ -110,7 +114,8 @@ vexUserSetup()
     vexMotorConfigure(mConfig, MOT_CONFIG_SIZE(mConfig));
     lcdSetup(VEX_LCD_DISPLAY_1);
     // serverSetup(&SD3);
-    armSetup(kVexMotor_3 // arm motor
+    armSetup(kVexMotor_3, // arm motor
+             kVexAnalog_3 // arm potentiometer
     );
     driveSetup(kVexMotor_2, // drive northeast or front-right motor
                kVexMotor_9, // drive northwest or front-left motor
@@ -121,8 +126,9 @@ vexUserSetup()
     );
     intakeSetup(kVexMotor_7 // intake motor
     );
-    liftSetup(kVexMotor_6,  // lift motor
-              kVexDigital_3 // lift limit sensor
+    liftSetup(kVexMotor_6,   // lift motor
+              kVexDigital_3, // lift limit sensor
+              kVexAnalog_2   // lift potentiometer
     );
     setterSetup(kVexMotor_5 // setter motor
     );
@@ -144,7 +150,10 @@ vexUserInit()
     // SmartMotorPtcMonitorEnable();
     SmartMotorSetPowerExpanderStatusPort(kVexAnalog_1);
     SmartMotorsAddPowerExtender(kVexMotor_6, kVexMotor_7, kVexMotor_8, kVexMotor_9);
+    vexGyroInit(kVexAnalog_6);
     systemInitAll();
+    tuneInit();
+    odometryStart();
     SmartMotorRun();
     // serverInit();
     // serverStart();
@@ -161,6 +170,8 @@ msg_t
 vexAutonomous(void *arg)
 {
     (void)arg;
+    const scriptHeader_t *script = NULL;
+    bool mirror = false;
 
     // Must call this
     vexTaskRegister("auton");
@@ -174,7 +185,21 @@ vexAutonomous(void *arg)
     systemStartAll();
     systemLockAll();
 
+    // all autonomous steps are timed from here
+    timerReset(AUTONOMOUS_TIMER_PERIOD);
+    // the match window of the motor telemetry starts with autonomous
+    SmartMotorHistoryReset();
+    odometryReset(NULL);
+
     while (1) {
+        // an uploaded script takes the place of the built in routine
+        if (lcdGetMode() != kLcdModeSetup) {
+            script = scriptFind((uint8_t)lcdGetMode(), &mirror);
+        }
+        if (script != NULL) {
+            scriptRun(script, mirror);
+            break;
+        }
         switch (lcdGetMode()) {
         case kLcdMode0:
             autonomousMode0();
@@ -234,8 +259,6 @@ vexOperator(void *arg)
     // Must call this
     vexTaskRegister("operator");
 
-    // vexGyroInit(kVexAnalog_6);
-
     vexLcdClearLine(VEX_LCD_DISPLAY_1, VEX_LCD_LINE_1);
     vexLcdClearLine(VEX_LCD_DISPLAY_1, VEX_LCD_LINE_2);
 
@@ -0,0 +1,160 @@
+/*
+ * check.c - check the shape of the response curves
+ *
+ * Every table in curve.c is checked against its parameters in curve.h:
+ * 0 up to the deadband, MIN just past it, MAX just below SATURATE and 127
+ * from there, never falling as the command grows and never above the
+ * straight line from MIN to MAX, which it follows when EXPO is 0.  The
+ * linear curve must be the identity and the standard curve must stay
+ * within STANDARD_LIMIT of the hand typed table it replaced.  curveApply
+ * must keep the sign of the command and clamp it.
+ *
+ * The generator itself is swept over deadbands, saturation points, expo
+ * and output ranges so a new curve can not break the shape.  Every failed
+ * check is printed and the harness then fails.
+ */
+
+#include "curve.c"
+
+#include <stdio.h>
+
+#define STANDARD_LIMIT 5
+
+// the drive, lift, arm, intake, flipper and setter speed table before curve.h
+static const int8_t standardTable[CURVE_SIZE] = {
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  21, 21, 21, 22, 22, 22, 23, 24, 24, 25, 25, 25, 25, 26, 27,
+    27, 28, 28, 28, 28, 29, 30, 30, 30, 31, 31, 32, 32, 32, 33, 33, 34, 34, 35, 35, 35, 36, 36, 37, 37, 37,
+    37, 38, 38, 39, 39, 39, 40, 40, 41, 41, 42, 42, 43, 44, 44, 45, 45, 46, 46, 47, 47, 48, 48, 49, 50, 50,
+    51, 52, 52, 53, 54, 55, 56, 57, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 67, 68, 70, 71, 72, 72, 73,
+    74, 76, 77, 78, 79, 79, 80, 81, 83, 84, 84, 86, 86, 87, 87, 88, 88, 89, 89, 90, 90, 127, 127, 127};
+
+static int failures;
+
+static void
+expect(bool ok, const char *what, const char *curve, int x)
+{
+    if (!ok) {
+        if (failures < 20) {
+            printf("FAILED: %s, %s at %d\n", what, curve, x);
+        }
+        failures++;
+    }
+    return;
+}
+
+/* check one table against the parameters it was generated from */
+static void
+checkShape(const char *name, const int8_t *table, int d, int lo, int hi, int s, int e)
+{
+    int64_t span = CURVE_SPAN(d, s);
+    int x;
+
+    for (x = 0; x < CURVE_SIZE; x++) {
+        expect(table[x] >= 0 && table[x] <= 127, "out of range", name, x);
+        if (x > 0) {
+            expect(table[x] >= table[x - 1], "falls", name, x);
+        }
+        if (x <= d) {
+            expect(table[x] == 0, "not 0 in the deadband", name, x);
+        } else if (x >= s) {
+            expect(table[x] == 127, "not 127 past saturation", name, x);
+        } else {
+            // on or below the straight line from MIN to MAX, on it without expo
+            expect(table[x] * span <= lo * span + (hi - lo) * (x - d - 1), "above the line", name, x);
+            if (e == 0) {
+                expect(table[x] == lo + ((hi - lo) * (x - d - 1)) / span, "off the line without expo", name, x);
+            }
+        }
+    }
+    if (d + 1 < CURVE_SIZE && d + 1 < s) {
+        expect(table[d + 1] == lo, "not MIN past the deadband", name, d + 1);
+    }
+    if (s - 1 < CURVE_SIZE && s - 1 > d) {
+        expect(table[s - 1] == hi, "not MAX below saturation", name, s - 1);
+    }
+    return;
+}
+
+static void
+checkTables(void)
+{
+    const int8_t *linear = curveGetTable(kCurveLinear);
+    const int8_t *standard = curveGetTable(kCurveStandard);
+    int worst = 0;
+    int x;
+
+    checkShape("linear", linear, CURVE_LINEAR_DEADBAND, CURVE_LINEAR_MIN, CURVE_LINEAR_MAX, CURVE_LINEAR_SATURATE,
+               CURVE_LINEAR_EXPO);
+    checkShape("standard", standard, CURVE_STANDARD_DEADBAND, CURVE_STANDARD_MIN, CURVE_STANDARD_MAX,
+               CURVE_STANDARD_SATURATE, CURVE_STANDARD_EXPO);
+
+    for (x = 0; x < CURVE_SIZE; x++) {
+        expect(linear[x] == x, "not the identity", "linear", x);
+        if (abs(standard[x] - standardTable[x]) > worst) {
+            worst = abs(standard[x] - standardTable[x]);
+        }
+        expect(abs(standard[x] - standardTable[x]) <= STANDARD_LIMIT, "away from the old table", "standard", x);
+        expect((standard[x] == 0) == (standardTable[x] == 0), "deadband moved from the old table", "standard", x);
+    }
+    expect(curveGetTable(kCurveNumber) == NULL, "a table for an unknown curve", "none", kCurveNumber);
+    printf("tables        linear is the identity, standard within %d of the old table\n", worst);
+    return;
+}
+
+static void
+checkApply(void)
+{
+    int c;
+    int x;
+
+    for (c = 0; c < kCurveNumber; c++) {
+        for (x = -200; x <= 200; x++) {
+            int clamped = (x > 127) ? 127 : ((x < -127) ? -127 : x);
+            int expected = (clamped < 0) ? -curveGetTable(c)[-clamped] : curveGetTable(c)[clamped];
+            expect(curveApply(c, x) == expected, "curveApply does not mirror and clamp", c ? "standard" : "linear", x);
+        }
+    }
+    expect(curveApply(kCurveNumber, 60) == 60 && curveApply(kCurveNumber, 300) == 127, "an unknown curve is not linear", "none",
+           60);
+    printf("curveApply    sign and clamping checked from -200 to 200\n");
+    return;
+}
+
+static void
+checkGenerator(void)
+{
+    static const int ranges[][2] = {{1, 127}, {15, 90}, {30, 60}, {60, 61}};
+    int8_t table[CURVE_SIZE];
+    char name[64];
+    int before = failures;
+    long curves = 0;
+    int d, s, e, r, x;
+
+    for (d = 0; d <= 40; d++) {
+        for (s = d + 3; s <= CURVE_SIZE; s++) {
+            for (e = 0; e <= 100; e += 10) {
+                for (r = 0; r < (int)(sizeof(ranges) / sizeof(ranges[0])); r++) {
+                    for (x = 0; x < CURVE_SIZE; x++) {
+                        table[x] = (int8_t)CURVE_VALUE(x, d, ranges[r][0], ranges[r][1], s, e);
+                    }
+                    snprintf(name, sizeof(name), "deadband %d saturate %d expo %d range %d-%d", d, s, e, ranges[r][0],
+                             ranges[r][1]);
+                    checkShape(name, table, d, ranges[r][0], ranges[r][1], s, e);
+                    curves++;
+                }
+            }
+        }
+    }
+    printf("generator     %s over %ld parameter sets\n", (failures == before) ? "passed" : "FAILED", curves);
+    return;
+}
+
+int
+main(void)
+{
+    checkTables();
+    checkApply();
+    checkGenerator();
+    printf("curve checks %s\n", failures ? "failed" : "passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,12 @@
+/*
+ * ch.h - curve.c needs nothing from ChibiOS on the host, only the types
+ */
+
+#ifndef MOCK_CH_H_
+
+#define MOCK_CH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#endif
@@ -0,0 +1,11 @@
+/*
+ * vex.h - curve.c needs nothing from ConVEX on the host
+ */
+
+#ifndef MOCK_VEX_H_
+
+#define MOCK_VEX_H_
+
+#include "ch.h"
+
+#endif
@@ -0,0 +1,182 @@
+/*
+ * follow.c - run the closed loop drive moves against a simulated robot
+ *
+ * Each side of the drive is two 393 motors modelled with the SmartMotor
+ * constants: the current is (V - Ke * rpm) / R and the torque follows the
+ * current above the free current.  Full power at 7.2V is taken to be
+ * DRIVE_MAX_VELOCITY and DRIVE_MAX_TURN_RATE, as drive.h assumes.  The robot
+ * needs SIM_TAU ms to reach 63% of full speed from rest and SIM_FRICTION of
+ * the stall torque to start moving.  The encoder and gyro read the simulated
+ * robot in whole counts.
+ *
+ * Straight moves, turns on the spot and arcs are run at three battery
+ * voltages.  For each the worst distance between the robot and the profile,
+ * the final error and the time to settle are printed.  The harness fails if
+ * a move does not settle, ends outside the settle band, settles more than
+ * SIM_LATE ms after its profile or strays more than SIM_TRACK_TICKS or
+ * SIM_TRACK_HEADING from the profile.
+ */
+
+#include "drive.c"
+
+#include <math.h>
+#include <stdio.h>
+
+#define NE kVexMotor_1
+#define NW kVexMotor_2
+#define SE kVexMotor_3
+#define SW kVexMotor_4
+
+#define SIM_TAU 150
+#define SIM_FRICTION 0.08
+
+#define SIM_LATE 700
+#define SIM_TRACK_TICKS 40
+#define SIM_TRACK_HEADING 50
+
+typedef struct {
+    const char *name;
+    int kind; // 0 distance, 1 turn, 2 arc
+    int16_t a;
+    int16_t b;
+} move_t;
+
+static const move_t moves[] = {
+    {"forward 24in", 0, 24, 0},    {"back 48in", 0, -48, 0},     {"forward 6in", 0, 6, 0},
+    {"turn 90deg", 1, 90, 0},      {"turn -180deg", 1, -180, 0}, {"turn 15deg", 1, 15, 0},
+    {"arc 24in 90deg", 2, 24, 90}, {"arc -30in -45deg", 2, -30, -45},
+};
+
+static const uint16_t batteries[] = {6800, 7200, 8200};
+
+// simulated robot
+static double speed[2];   // left and right side at the wheel, as a fraction of free speed
+static double position;   // forward travel in ticks
+static double heading;    // clockwise in deg * 10
+static int32_t origin[2]; // encoder and heading at the start of the move
+static profile_t profile;
+static bool turning;
+static double arcRatio;
+static systime_t start;
+static double worstTicks;
+static double worstHeading;
+
+static double
+sideTorque(int16_t cmd, double s)
+{
+    double volts = (mockBattery / 1000.0) * cmd / 127.0;
+    double current = (volts - SMLIB_Ke_393 * s * SMLIB_RPM_FREE_393) / SMLIB_R_393;
+    double torque;
+
+    // torque above the free current, as a fraction of the stall torque at 7.2V
+    torque = (current - ((current > 0) ? SMLIB_I_FREE_393 : -SMLIB_I_FREE_393)) / (SMLIB_I_STALL_393 - SMLIB_I_FREE_393);
+    if (fabs(s) < 1e-6 && fabs(torque) <= SIM_FRICTION) {
+        return 0;
+    }
+    return torque - ((s > 0 || (s == 0 && torque > 0)) ? SIM_FRICTION : -SIM_FRICTION);
+}
+
+static void
+robotStep(void)
+{
+    int16_t cmd[2] = {mockMotors[NW], mockMotors[NE]};
+    int32_t target;
+    int32_t velocity;
+    double next;
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        next = speed[i] + sideTorque(cmd[i], speed[i]) / SIM_TAU;
+        // friction stops a side, it does not push it back
+        speed[i] = (speed[i] != 0 && (next > 0) != (speed[i] > 0)) ? 0 : next;
+    }
+    position += (speed[0] + speed[1]) / 2 * DRIVE_MAX_VELOCITY / 1000;
+    heading += (speed[0] - speed[1]) / 2 * DRIVE_MAX_TURN_RATE / 1000;
+    mockEncoders[DRIVE_ENCODER] = (int32_t)lround(position);
+    mockGyro = -(int32_t)lround(heading);
+
+    // distance from the profile the move is following
+    profileAt(&profile, mockNow - start, &target, &velocity);
+    if (turning) {
+        if (fabs(heading - origin[1] - target) > worstHeading) {
+            worstHeading = fabs(heading - origin[1] - target);
+        }
+    } else {
+        if (fabs(position - origin[0] - target) > worstTicks) {
+            worstTicks = fabs(position - origin[0] - target);
+        }
+        if (fabs(heading - origin[1] - target * arcRatio) > worstHeading) {
+            worstHeading = fabs(heading - origin[1] - target * arcRatio);
+        }
+    }
+    return;
+}
+
+static int
+runMove(const move_t *m, uint16_t battery)
+{
+    int32_t ticks = 0;
+    int32_t turn = 0;
+    bool settled;
+    double ticksError;
+    double headingError;
+    uint32_t took;
+    int failed;
+
+    if (m->kind == 0) {
+        ticks = (int32_t)m->a * DRIVE_TICKS_PER_INCH;
+    } else if (m->kind == 1) {
+        turn = (int32_t)m->a * 10;
+    } else {
+        ticks = (int32_t)(((int64_t)m->a * DRIVE_TICKS_PER_INCH * abs(m->b) * 1144) >> 16);
+        turn = (int32_t)m->b * 10;
+    }
+    turning = (ticks == 0);
+    arcRatio = turning ? 0 : (double)turn / ticks;
+    drivePlan(&profile, ticks, turn);
+
+    mockBattery = battery;
+    origin[0] = mockEncoders[DRIVE_ENCODER];
+    origin[1] = (int32_t)lround(heading);
+    worstTicks = worstHeading = 0;
+    start = mockNow;
+
+    if (m->kind == 0) {
+        settled = driveDistance(m->a);
+    } else if (m->kind == 1) {
+        settled = driveTurnDegrees(m->a);
+    } else {
+        settled = driveArc(m->a, m->b);
+    }
+    took = mockNow - start;
+    ticksError = position - origin[0] - ticks;
+    headingError = heading - origin[1] - turn;
+
+    failed = (!settled || fabs(ticksError) > DRIVE_SETTLE_TICKS || fabs(headingError) > DRIVE_SETTLE_HEADING ||
+              took > profile.total + SIM_LATE || worstTicks > SIM_TRACK_TICKS || worstHeading > SIM_TRACK_HEADING);
+    printf("%-17s %4.1fV  tracking %5.1f ticks %5.1f deg  end %5.1f ticks %4.1f deg  settled %4u ms after %4u ms%s\n", m->name,
+           battery / 1000.0, worstTicks, worstHeading / 10, ticksError, headingError / 10, took - profile.total, profile.total,
+           failed ? "  FAILED" : "");
+
+    // let the robot come to rest before the next move
+    vexSleep(500);
+    return failed;
+}
+
+int
+main(void)
+{
+    int failed = 0;
+    unsigned int i, j;
+
+    driveSetup(NE, NW, SE, SW);
+    driveInit();
+    mockStep = robotStep;
+
+    for (j = 0; j < sizeof(batteries) / sizeof(batteries[0]); j++) {
+        for (i = 0; i < sizeof(moves) / sizeof(moves[0]); i++) {
+            failed |= runMove(&moves[i], batteries[j]);
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,169 @@
+/*
+ * mix.c - sweep the drive mixing across the input space
+ *
+ * Three checks, with the drive curve made linear so the wheels show the
+ * mixing itself:
+ * - driveMix over every strafe, forward and turn command keeps each wheel
+ *   within 127 and scales all four by the same amount, so the direction
+ *   asked for is kept
+ * - driveMove over every turn and forward command clamps each side on its
+ *   own, as the autonomous routines were timed with
+ * - driveStep with field centric driving on turns the stick into the robot
+ *   frame, the direction the wheels drive in is compared with the stick
+ *   direction less the robot heading
+ * driveMove is also swept with the real drive curve.  The harness fails if
+ * any check is off by more than the rounding of the integer maths.
+ */
+
+#include "curve.h"
+
+// the curve drive.c uses, linear unless a check switches it
+static curveName_t driveCurve = kCurveLinear;
+#define DRIVE_CURVE driveCurve
+
+#include "drive.c"
+
+#include <math.h>
+#include <stdio.h>
+
+#define NE kVexMotor_1
+#define NW kVexMotor_2
+#define SE kVexMotor_3
+#define SW kVexMotor_4
+
+static int
+clamp(int value)
+{
+    return (value > 127) ? 127 : ((value < -127) ? -127 : value);
+}
+
+static int
+checkMix(void)
+{
+    int16_t wheels[4];
+    int32_t mix[4];
+    int32_t peak;
+    int failed = 0;
+    int x, y, r, i;
+
+    for (x = -127; x <= 127; x++) {
+        for (y = -127; y <= 127; y++) {
+            for (r = -127; r <= 127; r++) {
+                driveMix(x, y, r, wheels);
+                mix[0] = y - x - r;
+                mix[1] = y + x + r;
+                mix[2] = y + x - r;
+                mix[3] = y - x + r;
+                peak = 127;
+                for (i = 0; i < 4; i++) {
+                    if (abs(mix[i]) > peak) {
+                        peak = abs(mix[i]);
+                    }
+                }
+                for (i = 0; i < 4; i++) {
+                    // every wheel is mix * 127 / peak, truncated
+                    if (abs(wheels[i]) > 127 || abs(wheels[i] * peak - mix[i] * 127) >= peak) {
+                        if (failed++ < 5) {
+                            printf("FAILED: driveMix(%d, %d, %d) wheel %d is %d\n", x, y, r, i, wheels[i]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    printf("driveMix      %s over 255^3 commands\n", failed ? "FAILED" : "passed");
+    return failed != 0;
+}
+
+static int
+checkMove(curveName_t curve, const char *name)
+{
+    int failed = 0;
+    int x, y;
+
+    driveCurve = curve;
+    for (x = -127; x <= 127; x++) {
+        for (y = -127; y <= 127; y++) {
+            driveMove(x, y, true);
+            if (mockMotors[NE] != curveApply(curve, clamp(y - x)) || mockMotors[SE] != mockMotors[NE] ||
+                mockMotors[NW] != curveApply(curve, clamp(y + x)) || mockMotors[SW] != mockMotors[NW]) {
+                if (failed++ < 5) {
+                    printf("FAILED: driveMove(%d, %d) gives %d %d %d %d\n", x, y, mockMotors[NE], mockMotors[NW],
+                           mockMotors[SE], mockMotors[SW]);
+                }
+            }
+        }
+    }
+    driveCurve = kCurveLinear;
+    printf("driveMove     %s with the %s curve\n", failed ? "FAILED" : "passed", name);
+    return failed != 0;
+}
+
+static int
+checkFieldCentric(void)
+{
+    double worst = 0;
+    double robotX, robotY, turn, error;
+    int heading, bearing;
+    int failed = 0;
+
+    // field forward is set while the robot faces 30 deg
+    mockGyro = -300;
+    mockControls[Btn7U] = 1;
+    driveStep();
+    mockControls[Btn7U] = 0;
+
+    for (heading = 0; heading < 3600; heading += 50) {
+        mockGyro = -(300 + heading);
+        for (bearing = 0; bearing < 3600; bearing += 100) {
+            mockControls[Ch1] = (int16_t)lround(100 * sin(bearing * M_PI / 1800));
+            mockControls[Ch3] = (int16_t)lround(100 * cos(bearing * M_PI / 1800));
+            mockControls[Ch4] = 0;
+            driveStep();
+
+            // the robot frame motion the wheels give, see driveMix
+            robotX = (mockMotors[NW] + mockMotors[SE] - mockMotors[NE] - mockMotors[SW]) / 4.0;
+            robotY = (mockMotors[NE] + mockMotors[NW] + mockMotors[SE] + mockMotors[SW]) / 4.0;
+            turn = (mockMotors[NW] + mockMotors[SW] - mockMotors[NE] - mockMotors[SE]) / 4.0;
+            error = remainder(atan2(robotX, robotY) * 1800 / M_PI - (bearing - heading), 3600) / 10;
+            if (fabs(error) > worst) {
+                worst = fabs(error);
+            }
+            if (fabs(error) > 1.5 || fabs(turn) > 1 || hypot(robotX, robotY) < 60) {
+                if (failed++ < 5) {
+                    printf("FAILED: heading %d bearing %d drives at %.1f deg, turning %.1f\n", heading / 10, bearing / 10,
+                           atan2(robotX, robotY) * 180 / M_PI, turn);
+                }
+            }
+        }
+    }
+
+    // 7D hands the stick back to the robot frame
+    mockControls[Btn7D] = 1;
+    mockControls[Ch1] = 0;
+    mockControls[Ch3] = 100;
+    driveStep();
+    mockControls[Btn7D] = 0;
+    if (mockMotors[NE] != 100 || mockMotors[NW] != 100 || mockMotors[SE] != 100 || mockMotors[SW] != 100) {
+        printf("FAILED: field centric driving stays on after 7D\n");
+        failed++;
+    }
+
+    printf("field centric %s, worst direction error %.2f deg\n", failed ? "FAILED" : "passed", worst);
+    return failed != 0;
+}
+
+int
+main(void)
+{
+    int failed = 0;
+
+    driveSetup(NE, NW, SE, SW);
+    driveInit();
+
+    failed |= checkMix();
+    failed |= checkMove(kCurveLinear, "linear");
+    failed |= checkMove(kCurveStandard, "standard");
+    failed |= checkFieldCentric();
+    return failed;
+}
@@ -0,0 +1,12 @@
+/*
+ * autonomous/timer.h - the routine timer call made by drive.c, for host
+ * builds
+ */
+
+#ifndef MOCK_AUTONOMOUS_TIMER_H_
+
+#define MOCK_AUTONOMOUS_TIMER_H_
+
+static inline void timerSync(void) {}
+
+#endif
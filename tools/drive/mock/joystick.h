@@ -0,0 +1,19 @@
+/*
+ * joystick.h - the joystick call used by drive.c, for host builds
+ */
+
+#ifndef MOCK_JOYSTICK_H_
+
+#define MOCK_JOYSTICK_H_
+
+#include "vex.h"
+
+extern int16_t mockControls[kMockControls];
+
+static inline int16_t
+joystickGet(tCtlIndex index)
+{
+    return mockControls[index];
+}
+
+#endif
@@ -0,0 +1,17 @@
+/*
+ * system.h - the controller call used by drive.c, for host builds
+ */
+
+#ifndef MOCK_SYSTEM_H_
+
+#define MOCK_SYSTEM_H_
+
+#include "joystick.h"
+
+static inline int16_t
+systemControllerGet(tCtlIndex index)
+{
+    return mockControls[index];
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * vex.c - host stand-ins for the ConVEX calls made by drive.c, and the
+ * joystick and buttons it reads
+ *
+ * vexSleep moves the clock on 1 ms at a time and calls mockStep, if the
+ * harness set one, so a plant model can follow the motors.
+ */
+
+#include "vex.h"
+#include "smartmotor.h"
+
+systime_t mockNow;
+int16_t mockMotors[kVexMotorNum];
+int16_t mockControls[kMockControls];
+int32_t mockEncoders[kVexQuadEncoder_Num];
+int32_t mockGyro;
+uint16_t mockBattery = 7200;
+void (*mockStep)(void);
+
+int16_t vexMotorGet(int16_t index) { return mockMotors[index]; }
+void vexMotorSet(int16_t index, int16_t value) { mockMotors[index] = value; }
+int32_t vexEncoderGet(int16_t channel) { return mockEncoders[channel]; }
+int32_t vexGyroGet(void) { return mockGyro; }
+uint16_t vexSpiGetMainBattery(void) { return mockBattery; }
+
+void
+vexSleep(int32_t ms)
+{
+    while (ms-- > 0) {
+        mockNow++;
+        if (mockStep != NULL) {
+            mockStep();
+        }
+    }
+    return;
+}
+
+void
+_SetMotor(int index, int value, bool_t immediate, ...)
+{
+    (void)immediate;
+    mockMotors[index] = (int16_t)value;
+    return;
+}
+
+void
+SetMotorGroup(int16_t count, const int16_t *index, const int16_t *value, bool_t immediate)
+{
+    int16_t i;
+
+    (void)immediate;
+    for (i = 0; i < count; i++) {
+        mockMotors[index[i]] = value[i];
+    }
+    return;
+}
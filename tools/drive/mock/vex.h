@@ -0,0 +1,89 @@
+/*
+ * vex.h - the parts of ConVEX used by drive.c, for host builds
+ */
+
+#ifndef MOCK_VEX_H_
+
+#define MOCK_VEX_H_
+
+#include "ch.h"
+#include <stdio.h>
+
+typedef enum {
+    kVexMotorUndefined = 0,
+    kVexMotor269,
+    kVexMotor393T,
+    kVexMotor393S,
+    kVexMotor393R
+} tVexMotorType;
+
+typedef enum {
+    kVexMotor_1 = 0,
+    kVexMotor_2,
+    kVexMotor_3,
+    kVexMotor_4,
+    kVexMotor_5,
+    kVexMotor_6,
+    kVexMotor_7,
+    kVexMotor_8,
+    kVexMotor_9,
+    kVexMotor_10,
+    kVexMotorNum
+} tVexMotor;
+
+typedef enum {
+    kVexAnalog_1 = 0,
+    kVexAnalog_2,
+    kVexAnalog_3,
+    kVexAnalog_4,
+    kVexAnalog_5,
+    kVexAnalog_6,
+    kVexAnalog_7,
+    kVexAnalog_8,
+    kVexAnalog_None = -1
+} tVexAnalogPin;
+
+typedef enum { kVexDigital_1 = 0, kVexDigital_12 = 11, kVexDigital_None = -1 } tVexDigitalPin;
+
+typedef enum { kVexQuadEncoder_1 = 0, kVexQuadEncoder_2, kVexQuadEncoder_Num } tVexQuadEncoderChannel;
+
+typedef enum { kVexSensorUndefined = -1 } tVexSensors;
+
+typedef enum { Ch1 = 0, Ch2, Ch3, Ch4, Btn5U, Btn5D, Btn7U, Btn7D, kMockControls } tCtlIndex;
+
+typedef enum { kVexTraceControl, kVexTraceSetMotor, kVexTraceMotor, kVexTracePwm, kVexTraceSpi, kVexTraceNum } tVexTraceStage;
+
+typedef void vexStream;
+
+extern int16_t mockMotors[kVexMotorNum];
+extern int32_t mockEncoders[kVexQuadEncoder_Num];
+extern int32_t mockGyro;
+extern uint16_t mockBattery;
+extern void (*mockStep)(void);
+
+int16_t vexMotorGet(int16_t index);
+void vexMotorSet(int16_t index, int16_t value);
+int32_t vexEncoderGet(int16_t channel);
+int32_t vexGyroGet(void);
+uint16_t vexSpiGetMainBattery(void);
+void vexSleep(int32_t ms);
+
+static inline int32_t
+vexSensorValueGet(tVexSensors sensor)
+{
+    (void)sensor;
+    return 0;
+}
+
+static inline int
+vexSensorIsAnalog(tVexSensors sensor)
+{
+    (void)sensor;
+    return 0;
+}
+
+// the debug output is not needed, and the formats are for the cortex
+#define vex_printf(...) ((void)0)
+#define vex_chprintf(chp, ...) ((void)(chp))
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ * ch.h - the parts of ChibiOS used by lift.c, for host builds
+ */
+
+#ifndef MOCK_CH_H_
+
+#define MOCK_CH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef int bool_t;
+typedef int32_t msg_t;
+typedef uint32_t systime_t;
+typedef int tprio_t;
+typedef uint32_t eventmask_t;
+typedef msg_t (*tfunc_t)(void *);
+typedef struct {
+    int dummy;
+} Thread;
+
+#define TRUE 1
+#define FALSE 0
+#define NORMALPRIO 64
+#define CH_FREQUENCY 1000
+#define MS2ST(x) (x)
+#define EVENT_MASK(x) (1u << (x))
+#define TIME_INFINITE ((systime_t)-1)
+
+extern systime_t mockNow;
+
+static inline systime_t
+chTimeNow(void)
+{
+    return mockNow;
+}
+
+#define chTimeElapsedSince(t) (chTimeNow() - (t))
+
+static inline void *
+chHeapAlloc(void *heap, size_t size)
+{
+    (void)heap;
+    return malloc(size);
+}
+
+static inline void chSysLock(void) {}
+static inline void chSysUnlock(void) {}
+static inline bool chThdShouldTerminate(void) { return false; }
+static inline Thread *chThdSelf(void) { return NULL; }
+
+#endif
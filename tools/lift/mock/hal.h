@@ -0,0 +1,11 @@
+/*
+ * hal.h - lift.c needs nothing from the HAL on the host
+ */
+
+#ifndef MOCK_HAL_H_
+
+#define MOCK_HAL_H_
+
+#include "ch.h"
+
+#endif
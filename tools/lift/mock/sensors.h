@@ -0,0 +1,26 @@
+/*
+ * sensors.h - the sensor snapshot reads used by lift.c, for host builds
+ */
+
+#ifndef MOCK_SENSORS_H_
+
+#define MOCK_SENSORS_H_
+
+#include "vex.h"
+
+extern int16_t mockAnalog[8];
+extern tVexDigitalState mockDigital[12];
+
+static inline int16_t
+sensorsAnalog(tVexAnalogPin pin)
+{
+    return mockAnalog[pin];
+}
+
+static inline tVexDigitalState
+sensorsDigital(tVexDigitalPin pin)
+{
+    return mockDigital[pin];
+}
+
+#endif
@@ -0,0 +1,20 @@
+/*
+ * system.h - the controller call used by lift.c, and the period the
+ * systems are stepped at, for host builds
+ */
+
+#ifndef MOCK_SYSTEM_H_
+
+#define MOCK_SYSTEM_H_
+
+#include "joystick.h"
+
+#define SYSTEM_PERIOD 25
+
+static inline int16_t
+systemControllerGet(tCtlIndex index)
+{
+    return mockControls[index];
+}
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * tune.h - the autotune calls made by lift.c, for host builds
+ *
+ * The relay is not run on the host, the lift never enters its tune mode.
+ */
+
+#ifndef MOCK_TUNE_H_
+
+#define MOCK_TUNE_H_
+
+#include "vex.h"
+
+typedef enum tuneSystem_e { kTuneArm = 0, kTuneLift, kTuneSystemNumber } tuneSystem_t;
+
+static inline bool
+tuneStep(tuneSystem_t system, int32_t position, int16_t *cmd)
+{
+    (void)system;
+    (void)position;
+    *cmd = 0;
+    return false;
+}
+
+static inline void tuneCancel(tuneSystem_t system) { (void)system; }
+
+#endif
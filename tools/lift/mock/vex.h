@@ -0,0 +1,70 @@
+/*
+ * vex.h - the parts of ConVEX used by lift.c, for host builds
+ */
+
+#ifndef MOCK_VEX_H_
+
+#define MOCK_VEX_H_
+
+#include "ch.h"
+#include <stdio.h>
+
+typedef enum {
+    kVexMotorUndefined = 0,
+    kVexMotor269,
+    kVexMotor393T,
+    kVexMotor393S,
+    kVexMotor393R
+} tVexMotorType;
+
+typedef enum {
+    kVexMotor_1 = 0,
+    kVexMotor_2,
+    kVexMotor_3,
+    kVexMotor_4,
+    kVexMotor_5,
+    kVexMotor_6,
+    kVexMotor_7,
+    kVexMotor_8,
+    kVexMotor_9,
+    kVexMotor_10,
+    kVexMotorNum
+} tVexMotor;
+
+typedef enum {
+    kVexAnalog_1 = 0,
+    kVexAnalog_2,
+    kVexAnalog_3,
+    kVexAnalog_4,
+    kVexAnalog_5,
+    kVexAnalog_6,
+    kVexAnalog_7,
+    kVexAnalog_8,
+    kVexAnalog_None = -1
+} tVexAnalogPin;
+
+typedef enum { kVexDigital_1 = 0, kVexDigital_2, kVexDigital_3, kVexDigital_12 = 11, kVexDigital_None = -1 } tVexDigitalPin;
+
+typedef enum { kVexDigitalLow = 0, kVexDigitalHigh = 1 } tVexDigitalState;
+
+typedef enum { kVexSensorUndefined = -1 } tVexSensors;
+
+typedef enum { Ch3Xmtr2 = 0, Btn7DXmtr2, Btn7LXmtr2, Btn7UXmtr2, kMockControls } tCtlIndex;
+
+typedef void vexStream;
+
+static inline int32_t
+vexSensorValueGet(tVexSensors sensor)
+{
+    (void)sensor;
+    return 0;
+}
+
+static inline int
+vexSensorIsAnalog(tVexSensors sensor)
+{
+    (void)sensor;
+    return 0;
+}
+
+#endif
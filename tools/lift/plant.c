@@ -0,0 +1,213 @@
+/*
+ * plant.c - run the lift presets against a model of the lift
+ *
+ * The lift motor is modelled with the SmartMotor 393 constants as in
+ * tools/drive, full power at 7.2V is taken to be LIFT_MAX_VELOCITY.  The
+ * load needs SIM_TAU ms to reach 63% of full speed, gravity pulls it down
+ * with a fixed share of the stall torque and friction holds it still until
+ * the motor overcomes it.  Hard stops sit at the floor and at SIM_TOP, the
+ * limit switch closes in the last SIM_SWITCH counts above the floor and the
+ * pot reads SIM_POT_FLOOR at the floor.
+ *
+ * Each run starts with the lift part way up and not homed, and liftStep is
+ * called every SYSTEM_PERIOD ms.  The lift homes, moves up to the ceiling,
+ * down to carry, holds there and goes back to the floor.  Runs are made with
+ * gravity matching LIFT_BIAS and 30% either side of it.  The harness fails
+ * if homing does not zero the pot, a move overshoots out of LIFT_SETTLE or
+ * does not settle within SIM_SETTLE ms of its profile, the hold drifts out
+ * of LIFT_SETTLE or the lift does not end resting on its switch.
+ */
+
+#include "lift.c"
+
+#include <stdio.h>
+
+#define MOTOR kVexMotor_5
+#define LIMIT kVexDigital_2
+#define POT kVexAnalog_3
+
+#define SIM_TAU 100
+#define SIM_FRICTION 0.04
+#define SIM_TOP 1700
+#define SIM_SWITCH 3
+#define SIM_POT_FLOOR 350
+#define SIM_START 300
+
+#define SIM_OVERSHOOT LIFT_SETTLE
+#define SIM_SETTLE 400
+#define SIM_HOME 2000
+
+systime_t mockNow;
+int16_t mockControls[kMockControls];
+int16_t mockAnalog[8];
+tVexDigitalState mockDigital[12];
+
+static int16_t motor;
+static double gravity;  // share of the stall torque
+static double position; // counts above the floor
+static double speed;    // share of the free speed, up is positive
+
+void
+_SetMotor(int index, int value, bool_t immediate, ...)
+{
+    (void)immediate;
+    if (index == MOTOR) {
+        motor = (int16_t)value;
+    }
+    return;
+}
+
+/* share of the stall torque at 7.2V from a command and the speed */
+static double
+motorTorque(int cmd, double s)
+{
+    double current = (7.2 * cmd / 127.0 - SMLIB_Ke_393 * s * SMLIB_RPM_FREE_393) / SMLIB_R_393;
+
+    if (fabs(current) <= SMLIB_I_FREE_393) {
+        return 0;
+    }
+    return (current - ((current > 0) ? SMLIB_I_FREE_393 : -SMLIB_I_FREE_393)) / (SMLIB_I_STALL_393 - SMLIB_I_FREE_393);
+}
+
+static void
+plantStep(void)
+{
+    double torque = motorTorque(LIFT_REVERSED ? -motor : motor, speed) - gravity;
+    double next;
+
+    if (speed == 0 && fabs(torque) <= SIM_FRICTION) {
+        next = 0;
+    } else {
+        next = speed + (torque - ((speed > 0 || (speed == 0 && torque > 0)) ? SIM_FRICTION : -SIM_FRICTION)) / SIM_TAU;
+        // friction stops the lift, it does not push it back
+        if (speed != 0 && (next > 0) != (speed > 0)) {
+            next = 0;
+        }
+    }
+    speed = next;
+    position += speed * LIFT_MAX_VELOCITY / 1000;
+    if (position <= 0 && speed <= 0) {
+        position = 0;
+        speed = 0;
+    } else if (position >= SIM_TOP && speed >= 0) {
+        position = SIM_TOP;
+        speed = 0;
+    }
+    mockAnalog[POT] = (int16_t)lround(SIM_POT_FLOOR + (LIFT_POT_REVERSED ? -position : position));
+    mockDigital[LIMIT] = (position <= SIM_SWITCH) ? kVexDigitalLow : kVexDigitalHigh;
+    return;
+}
+
+/* run the lift and the model for ms */
+static void
+run(uint32_t ms)
+{
+    while (ms-- > 0) {
+        mockNow++;
+        plantStep();
+        if ((mockNow % SYSTEM_PERIOD) == 0) {
+            liftStep();
+        }
+    }
+    return;
+}
+
+/* move to a preset, return nonzero if it overshoots or is slow to settle */
+static int
+moveTo(int32_t target, const char *name)
+{
+    systime_t start = mockNow;
+    systime_t outside = mockNow;
+    double overshoot = 0;
+    double beyond;
+    uint32_t total;
+    uint32_t settle;
+    int failed;
+
+    liftMoveTo(target);
+    total = lift.profile.total;
+    while (mockNow - start < total + 1500) {
+        run(1);
+        beyond = (lift.profile.distance > 0) ? position - target : target - position;
+        if (beyond > overshoot) {
+            overshoot = beyond;
+        }
+        if (fabs(position - target) > LIFT_SETTLE) {
+            outside = mockNow;
+        }
+    }
+    settle = (outside > start + total) ? outside - (start + total) : 0;
+    failed = (overshoot > SIM_OVERSHOOT || settle > SIM_SETTLE || !liftAtTarget());
+    printf("  %-8s %4d counts  overshoot %5.1f  settled %3u ms after %4u ms%s\n", name, lift.profile.distance, overshoot, settle,
+           total, failed ? "  FAILED" : "");
+    return failed;
+}
+
+static int
+simulate(double share)
+{
+    systime_t start;
+    double drift = 0;
+    int failed = 0;
+    int hold;
+
+    mockNow = 0;
+    motor = 0;
+    position = SIM_START;
+    speed = 0;
+    // gravity the bias command holds at a standstill, scaled by share
+    gravity = share * motorTorque((int)(LIFT_BIAS * 127), 0);
+    plantStep();
+
+    printf("gravity %3.0f%% of the bias\n", share * 100);
+    liftSetup(MOTOR, LIMIT, POT);
+    liftInit();
+
+    start = mockNow;
+    while (lift.mode == kLiftHoming && mockNow - start < SIM_HOME) {
+        run(1);
+    }
+    run(500);
+    if (!lift.homed || lift.zero != SIM_POT_FLOOR || lift.mode != kLiftHold) {
+        printf("  FAILED: homing did not zero the pot, zero %d\n", lift.zero);
+        failed = 1;
+    } else {
+        printf("  homing   found the floor after %u ms\n", mockNow - 500 - start);
+    }
+
+    failed |= moveTo(LIFT_CEILING, "ceiling");
+    failed |= moveTo(LIFT_CARRY, "carry");
+
+    for (hold = 0; hold < 2000; hold++) {
+        run(1);
+        if (fabs(position - LIFT_CARRY) > drift) {
+            drift = fabs(position - LIFT_CARRY);
+        }
+    }
+    if (drift > LIFT_SETTLE) {
+        printf("  FAILED: hold drifted %.1f counts\n", drift);
+        failed = 1;
+    } else {
+        printf("  hold     drifted %.1f counts over 2s\n", drift);
+    }
+
+    failed |= moveTo(LIFT_FLOOR, "floor");
+    if (mockDigital[LIMIT] != kVexDigitalLow || lift.command != -LIFT_REST_POWER) {
+        printf("  FAILED: the lift is not resting on its switch\n");
+        failed = 1;
+    }
+    return failed;
+}
+
+int
+main(void)
+{
+    static const double shares[] = {0.7, 1.0, 1.3};
+    int failed = 0;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(shares) / sizeof(shares[0]); i++) {
+        failed |= simulate(shares[i]);
+    }
+    return failed;
+}
@@ -0,0 +1,62 @@
+/*
+ * ch.h - the parts of ChibiOS used by odometry.c, for host builds
+ *
+ * The odometry thread runs to completion inside chThdCreateStatic, every
+ * millisecond it sleeps the clock moves on and the trace is stepped.
+ */
+
+#ifndef MOCK_CH_H_
+
+#define MOCK_CH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef int bool_t;
+typedef int32_t msg_t;
+typedef uint32_t systime_t;
+typedef msg_t (*tfunc_t)(void *);
+typedef struct {
+    int dummy;
+} Thread;
+
+#define TRUE 1
+#define FALSE 0
+#define NORMALPRIO 64
+#define CH_FREQUENCY 1000
+#define MS2ST(x) (x)
+#define WORKING_AREA(s, n) char s[n]
+
+extern systime_t mockNow;
+extern systime_t mockEnd;
+
+static inline systime_t
+chTimeNow(void)
+{
+    return mockNow;
+}
+
+#define chTimeElapsedSince(t) (chTimeNow() - (t))
+
+static inline bool
+chThdShouldTerminate(void)
+{
+    return mockNow >= mockEnd;
+}
+
+static inline Thread *
+chThdCreateStatic(void *wsp, int size, int prio, tfunc_t pf, void *arg)
+{
+    (void)wsp;
+    (void)size;
+    (void)prio;
+    (void)pf(arg);
+    return NULL;
+}
+
+static inline void chSysLock(void) {}
+static inline void chSysUnlock(void) {}
+static inline void chRegSetThreadName(const char *name) { (void)name; }
+
+#endif
@@ -0,0 +1,57 @@
+/*
+ * vex.h - the parts of ConVEX used by odometry.c and the headers it
+ * includes, for host builds
+ */
+
+#ifndef MOCK_VEX_H_
+
+#define MOCK_VEX_H_
+
+#include "ch.h"
+
+typedef enum {
+    kVexMotorUndefined = 0,
+    kVexMotor269,
+    kVexMotor393T,
+    kVexMotor393S,
+    kVexMotor393R
+} tVexMotorType;
+
+typedef enum {
+    kVexMotor_1 = 0,
+    kVexMotor_2,
+    kVexMotor_3,
+    kVexMotor_4,
+    kVexMotor_5,
+    kVexMotor_6,
+    kVexMotor_7,
+    kVexMotor_8,
+    kVexMotor_9,
+    kVexMotor_10,
+    kVexMotorNum
+} tVexMotor;
+
+typedef enum {
+    kVexAnalog_1 = 0,
+    kVexAnalog_2,
+    kVexAnalog_3,
+    kVexAnalog_4,
+    kVexAnalog_5,
+    kVexAnalog_6,
+    kVexAnalog_7,
+    kVexAnalog_8,
+    kVexAnalog_None = -1
+} tVexAnalogPin;
+
+typedef enum { kVexDigital_1 = 0, kVexDigital_12 = 11, kVexDigital_None = -1 } tVexDigitalPin;
+
+typedef enum { kVexQuadEncoder_1 = 0, kVexQuadEncoder_2, kVexQuadEncoder_Num } tVexQuadEncoderChannel;
+
+typedef enum { kVexSensorUndefined = -1 } tVexSensors;
+
+typedef void vexStream;
+
+int32_t vexEncoderGet(int16_t channel);
+void vexSleep(int32_t ms);
+
+#endif
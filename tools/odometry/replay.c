@@ -0,0 +1,178 @@
+/*
+ * replay.c - replay encoder and gyro traces through the pose estimator
+ *
+ * Each trace is a list of segments driven at a constant speed and turn
+ * rate, so the true pose has a closed form: a line, an arc or a turn on the
+ * spot.  The drive encoder reads the distance travelled in whole counts and
+ * the gyro the heading in whole deg * 10, as they do on the robot, and the
+ * odometry thread runs on them at ODOMETRY_PERIOD.
+ *
+ * After every update the pose from odometryGet is compared with the true
+ * pose at that time.  The worst and final position and heading errors are
+ * printed, the harness fails if a trace is off by more than its limits.
+ */
+
+#include "odometry.c"
+
+#include <math.h>
+#include <stdio.h>
+
+typedef struct {
+    uint32_t time; // ms, 0 ends the trace
+    double speed;  // in/s, negative drives back
+    double rate;   // deg/s, positive turns clockwise
+} segment_t;
+
+typedef struct {
+    const char *name;
+    double limit;   // position error in inches
+    double heading; // heading error in deg
+    segment_t segments[10];
+} trace_t;
+
+typedef struct {
+    double x;       // inches
+    double y;       // inches
+    double heading; // deg
+    double travel;  // inches along the robot
+} truth_t;
+
+static const trace_t traces[] = {
+    {"straight 60in", 0.1, 0.1, {{2000, 30, 0}, {0}}},
+    {"straight back 45in", 0.1, 0.1, {{1500, -30, 0}, {0}}},
+    {"arc 24in 90deg", 0.2, 0.1, {{1257, 30, 71.62}, {0}}},
+    {"arc back 36in -180deg", 0.2, 0.1, {{5655, -20, -31.83}, {0}}},
+    {"spin 720deg", 0.1, 0.1, {{4000, 0, 180}, {0}}},
+    {"spin then drive", 0.1, 0.1, {{250, 0, 180}, {1500, 30, 0}, {0}}},
+    {"square 48in",
+     0.2,
+     0.1,
+     {{1600, 30, 0}, {500, 0, 180}, {1600, 30, 0}, {500, 0, 180}, {1600, 30, 0}, {500, 0, 180}, {1600, 30, 0}, {0}}},
+    {"s curve", 0.2, 0.1, {{1000, 30, 60}, {2000, 30, -60}, {1000, 30, 60}, {0}}},
+};
+
+systime_t mockNow;
+systime_t mockEnd;
+
+static const trace_t *trace;
+static truth_t truth;
+static double worst;
+static double worstHeading;
+
+/* the true pose at t ms into the trace */
+static truth_t
+truthAt(uint32_t t)
+{
+    truth_t p = {0, 0, 0, 0};
+    const segment_t *s;
+    double dt;
+    double h;
+    double r;
+
+    for (s = trace->segments; s->time != 0 && t > 0; s++) {
+        dt = ((t < s->time) ? t : s->time) / 1000.0;
+        t -= (t < s->time) ? t : s->time;
+        h = p.heading * M_PI / 180;
+        if (s->rate == 0) {
+            p.x += s->speed * dt * sin(h);
+            p.y += s->speed * dt * cos(h);
+        } else {
+            // heading is clockwise from y, the arc has radius speed / rate
+            r = s->speed / (s->rate * M_PI / 180);
+            p.heading += s->rate * dt;
+            p.x += r * (cos(h) - cos(p.heading * M_PI / 180));
+            p.y += r * (sin(p.heading * M_PI / 180) - sin(h));
+        }
+        p.travel += s->speed * dt;
+    }
+    return p;
+}
+
+int32_t
+vexEncoderGet(int16_t channel)
+{
+    return (channel == DRIVE_ENCODER) ? (int32_t)floor(truth.travel * DRIVE_TICKS_PER_INCH) : 0;
+}
+
+int32_t
+driveHeading(void)
+{
+    return (int32_t)lround(truth.heading * 10);
+}
+
+static void
+compare(void)
+{
+    truth_t t = truthAt(mockNow - (mockNow % ODOMETRY_PERIOD));
+    pose_t pose;
+    double error;
+
+    odometryGet(&pose);
+    error = hypot(pose.x / 100.0 - t.x, pose.y / 100.0 - t.y);
+    if (error > worst) {
+        worst = error;
+    }
+    if (fabs(pose.heading / 10.0 - t.heading) > worstHeading) {
+        worstHeading = fabs(pose.heading / 10.0 - t.heading);
+    }
+    return;
+}
+
+void
+vexSleep(int32_t ms)
+{
+    while (ms-- > 0) {
+        mockNow++;
+        // halfway between updates, after the last one ran
+        if ((mockNow % ODOMETRY_PERIOD) == ODOMETRY_PERIOD / 2) {
+            compare();
+        }
+        truth = truthAt(mockNow);
+    }
+    return;
+}
+
+static int
+replay(const trace_t *t)
+{
+    const segment_t *s;
+    pose_t pose;
+    truth_t end;
+    double error;
+    double headingError;
+    int failed;
+
+    trace = t;
+    mockNow = 0;
+    mockEnd = 0;
+    for (s = t->segments; s->time != 0; s++) {
+        mockEnd += s->time;
+    }
+    end = truthAt(mockEnd);
+    // one more update after the robot stops
+    mockEnd += ODOMETRY_PERIOD + 1;
+    truth = truthAt(0);
+    worst = worstHeading = 0;
+
+    odometryStart();
+
+    odometryGet(&pose);
+    error = hypot(pose.x / 100.0 - end.x, pose.y / 100.0 - end.y);
+    headingError = fabs(pose.heading / 10.0 - end.heading);
+    failed = (worst > t->limit || worstHeading > t->heading || error > t->limit || headingError > t->heading);
+    printf("%-22s end %7.2f %7.2f in %7.1f deg  error %.3f in %.2f deg  worst %.3f in %.2f deg%s\n", t->name, end.x, end.y,
+           end.heading, error, headingError, worst, worstHeading, failed ? "  FAILED" : "");
+    return failed;
+}
+
+int
+main(void)
+{
+    int failed = 0;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(traces) / sizeof(traces[0]); i++) {
+        failed |= replay(&traces[i]);
+    }
+    return failed;
+}
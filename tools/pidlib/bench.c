@@ -0,0 +1,328 @@
+/*
+ * bench.c - check the fixed point PID controller against float versions
+ *
+ * Four checks:
+ * - a double precision copy of the fixed point algorithm and the real one
+ *   run a simulated mechanism through a step and back with jittered dt,
+ *   the difference is the fixed point quantisation
+ * - a simulated 2000 count drive move, run once with the float
+ *   PidControllerUpdate and the old drive gains and once with the fixed
+ *   point controller and the gains drive.c converted them to
+ * - the relay autotune against first order plus dead time plants, where Pu
+ *   and the relay amplitude have a closed form.  Pu and Ku must be within
+ *   TUNE_CYCLE of the exact relay cycle, which shows the autotune measures
+ *   it correctly, and within TUNE_PU and TUNE_KU of the plant's true
+ *   ultimate period and gain, the error of the describing function itself
+ * - time per update of each on the host
+ *
+ * The host has an FPU so the timing understates the saving on the cortex,
+ * where every float operation is a library call.  Cortex-M3 cycles are not
+ * measured here.
+ */
+
+#include "pidlib.c"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+
+/* the fixed point algorithm in double precision */
+typedef struct {
+    double Kp, Ki, Kd, Kv, tau;
+    double integral, derivative, last;
+    int first;
+} reference_t;
+
+static double
+referenceUpdate(reference_t *r, double target, double velocity, double sensor, double dt)
+{
+    double error = target - sensor;
+    double rate;
+    double drive;
+    double step;
+
+    if (fabs(error) < 10) {
+        error = 0;
+    }
+    rate = r->first ? 0 : (sensor - r->last) * 1000 / dt;
+    r->derivative = r->first ? 0 : r->derivative + (rate - r->derivative) * dt / (r->tau + dt);
+    r->last = sensor;
+    r->first = 0;
+
+    drive = r->Kp * error - r->Kd * r->derivative + r->Kv * velocity;
+    step = r->Ki * error * dt / 1000;
+    if (!((drive + r->integral >= 127) && step > 0) && !((drive + r->integral <= -127) && step < 0)) {
+        r->integral += step;
+        if (r->integral > PIDLIB_INTEGRAL_DRIVE_MAX * 127) {
+            r->integral = PIDLIB_INTEGRAL_DRIVE_MAX * 127;
+        } else if (r->integral < -PIDLIB_INTEGRAL_DRIVE_MAX * 127) {
+            r->integral = -PIDLIB_INTEGRAL_DRIVE_MAX * 127;
+        }
+    }
+    drive += r->integral;
+    return (drive > 127) ? 127 : ((drive < -127) ? -127 : drive);
+}
+
+static int
+checkQuantisation(void)
+{
+    pidFixedController bank[2];
+    reference_t r = {0.38, 1.3, 0.025, 0.5, 30, 0, 0, 0, 1};
+    int32_t snapshot[2];
+    double position = 0;
+    double speed = 0;
+    double worst = 0;
+    int k;
+
+    PidFixedControllerInit(&bank[0], PIDLIB_FIX(0.38), PIDLIB_FIX(1.3), PIDLIB_FIX(0.025), 0);
+    bank[0].Kv = PIDLIB_FIX(0.5);
+    bank[0].derivative_tau = 30;
+    bank[1] = bank[0];
+    bank[1].sensor_index = 1;
+
+    for (k = 0; k < 500; k++) {
+        int32_t target = (k < 250) ? 2000 : 500;
+        int32_t dt = 10 + (k % 3);
+        double drive;
+
+        bank[0].target_value = target;
+        bank[1].target_value = target;
+        snapshot[0] = (int32_t)position;
+        snapshot[1] = (int32_t)position;
+        PidFixedBankUpdate(bank, 2, snapshot, dt);
+        drive = referenceUpdate(&r, target, 0, (int32_t)position, dt);
+        if (fabs(bank[0].drive / 65536.0 - drive) > worst) {
+            worst = fabs(bank[0].drive / 65536.0 - drive);
+        }
+        if (bank[0].drive != bank[1].drive) {
+            printf("bank controllers differ at %d\n", k);
+            return 1;
+        }
+        speed += (bank[0].drive_raw * 30.0 - speed * 3) * dt / 1000.0;
+        position += speed * dt / 1000.0;
+    }
+    printf("quantisation  max %.4f command\n", worst);
+    return (worst < 0.05) ? 0 : 1;
+}
+
+/* a 2000 count move on the drive profile, the drive lags and has friction */
+#define MOVE_DISTANCE 2000
+#define MOVE_VELOCITY 900
+#define MOVE_ACCEL 2400
+#define MOVE_MAX_VELOCITY 1200
+
+static void
+moveTarget(uint32_t t, int32_t *position, int32_t *velocity)
+{
+    double ramp = (double)MOVE_VELOCITY / MOVE_ACCEL;
+    double total = ramp + (double)MOVE_DISTANCE / MOVE_VELOCITY;
+    double s = t / 1000.0;
+
+    if (s < ramp) {
+        *position = (int32_t)(0.5 * MOVE_ACCEL * s * s);
+        *velocity = (int32_t)(MOVE_ACCEL * s);
+    } else if (s < total - ramp) {
+        *position = (int32_t)(0.5 * MOVE_ACCEL * ramp * ramp + MOVE_VELOCITY * (s - ramp));
+        *velocity = MOVE_VELOCITY;
+    } else if (s < total) {
+        *position = (int32_t)(MOVE_DISTANCE - 0.5 * MOVE_ACCEL * (total - s) * (total - s));
+        *velocity = (int32_t)(MOVE_ACCEL * (total - s));
+    } else {
+        *position = MOVE_DISTANCE;
+        *velocity = 0;
+    }
+}
+
+static void
+runMove(bool fixed, int *worst, int *final, uint32_t *settle)
+{
+    pidController *f = PidControllerInit(0.01, 0.0005, 0.02, kVexSensorUndefined, 0);
+    pidFixedController p;
+    double position = 0;
+    double speed = 0;
+    int32_t target;
+    int32_t velocity;
+    int32_t error;
+    int32_t command;
+    uint32_t settled = 0;
+    uint32_t t;
+
+    PidFixedControllerInit(&p, PIDLIB_FIX(1.27), PIDLIB_FIX(6.35), PIDLIB_FIX(0.0254), 0);
+    *worst = 0;
+    *settle = 0;
+    for (t = 0; t <= 4000; t += 10) {
+        moveTarget(t, &target, &velocity);
+        error = target - (int32_t)position;
+        command = (velocity * 127) / MOVE_MAX_VELOCITY;
+        if (fixed) {
+            command += PidFixedControllerUpdate(&p, -error, (t == 0) ? 0 : 10);
+        } else {
+            f->error = error;
+            command += PidControllerUpdate(f);
+        }
+        command = (command > 127) ? 127 : ((command < -127) ? -127 : command);
+
+        // full command reaches MOVE_MAX_VELOCITY less 8 commands of friction, 80ms lag
+        if (abs(command) > 8) {
+            speed += ((command - ((command > 0) ? 8 : -8)) * MOVE_MAX_VELOCITY / 119.0 - speed) * 10 / 80.0;
+        } else {
+            speed += (0 - speed) * 10 / 80.0;
+        }
+        position += speed * 10 / 1000.0;
+
+        if (abs(error) > *worst) {
+            *worst = abs(error);
+        }
+        settled = (velocity == 0 && target == MOVE_DISTANCE && abs(error) <= 15) ? settled + 10 : 0;
+        if (*settle == 0 && settled >= 100) {
+            *settle = t;
+        }
+    }
+    *final = MOVE_DISTANCE - (int32_t)position;
+}
+
+static int
+checkDriveLoops(void)
+{
+    int worst[2];
+    int final[2];
+    uint32_t settle[2];
+
+    runMove(false, &worst[0], &final[0], &settle[0]);
+    runMove(true, &worst[1], &final[1], &settle[1]);
+    printf("drive move    float: max error %d, final %d, settled at %u ms\n", worst[0], final[0], settle[0]);
+    printf("drive move    fixed: max error %d, final %d, settled at %u ms\n", worst[1], final[1], settle[1]);
+    return (settle[1] != 0 && abs(final[1]) <= 15 && worst[1] <= worst[0] + worst[0] / 10) ? 0 : 1;
+}
+
+/* first order plus dead time, counts = TUNE_TARGET + K * command delayed by L, lagged by T */
+#define TUNE_TARGET 1000
+#define TUNE_RELAY 40
+#define TUNE_HYSTERESIS 10
+#define TUNE_PERIOD 10
+#define TUNE_CYCLE 0.05
+#define TUNE_PU 0.15
+#define TUNE_KU 0.25
+
+typedef struct {
+    const char *name;
+    double K; // counts per command
+    double T; // ms
+    int L;    // ms
+} fopdt_t;
+
+static const fopdt_t plants[] = {
+    {"lift", 10, 200, 50},
+    {"arm", 6, 300, 120},
+    {"drive", 12, 150, 100},
+    {"slow", 8, 400, 400},
+    {"dead", 5, 100, 300},
+};
+
+static int
+runAutotune(const fopdt_t *f)
+{
+    static int16_t delay[1000];
+    pidAutotune a;
+    double y = TUNE_TARGET - 50;
+    double d = f->K * TUNE_RELAY;
+    double h = TUNE_HYSTERESIS;
+    double L, half, amplitude, w, lo, hi;
+    double cycleKu, trueKu, truePu;
+    int16_t u = 0;
+    uint32_t t;
+    int failed;
+
+    PidAutotuneInit(&a, TUNE_TARGET, TUNE_RELAY, TUNE_HYSTERESIS, 4);
+    for (t = 0; a.state == kPidTuneRunning && t < 2 * PIDLIB_TUNE_TIMEOUT; t++) {
+        if ((t % TUNE_PERIOD) == 0) {
+            u = PidAutotuneUpdate(&a, (int32_t)lround(y), t);
+        }
+        delay[t % f->L] = u;
+        // the command from L ms ago, it is overwritten next ms
+        y += (TUNE_TARGET + f->K * delay[(t + 1) % f->L] - y) / f->T;
+    }
+
+    // the relay switches on average half a period after y crosses the band, the
+    // same lag as the sampling adds to any controller
+    L = f->L + TUNE_PERIOD / 2.0;
+    amplitude = d - (d - h) * exp(-L / f->T);
+    half = L + f->T * log((d + amplitude) / (d - h));
+    cycleKu = 4 * TUNE_RELAY / (M_PI * sqrt(amplitude * amplitude - h * h));
+
+    // true ultimate frequency where the phase is -180 deg, atan(wT) + wL = pi
+    lo = 0;
+    hi = M_PI / L;
+    while (hi - lo > 1e-12) {
+        w = (lo + hi) / 2;
+        if (atan(w * f->T) + w * L < M_PI) {
+            lo = w;
+        } else {
+            hi = w;
+        }
+    }
+    truePu = 2 * M_PI / lo / 1000;
+    trueKu = sqrt(1 + lo * lo * f->T * f->T) / f->K;
+
+    failed = (a.state != kPidTuneDone || fabs(a.Pu / (2 * half / 1000) - 1) > TUNE_CYCLE || fabs(a.Ku / cycleKu - 1) > TUNE_CYCLE ||
+              fabs(a.Pu / truePu - 1) > TUNE_PU || fabs(a.Ku / trueKu - 1) > TUNE_KU);
+    printf("autotune      %-5s L/T %.2f  Pu %.3f s, cycle %.3f, true %.3f  Ku %.3f, cycle %.3f, true %.3f%s\n", f->name,
+           f->L / f->T, a.Pu, 2 * half / 1000, truePu, a.Ku, cycleKu, trueKu, failed ? "  FAILED" : "");
+    return failed;
+}
+
+static int
+checkAutotune(void)
+{
+    int failed = 0;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(plants) / sizeof(plants[0]); i++) {
+        failed |= runAutotune(&plants[i]);
+    }
+    return failed;
+}
+
+static void
+timeUpdates(void)
+{
+    pidController *fp = PidControllerInit(0.003, 0.0002, 0.01, kVexSensorUndefined, 0);
+    pidFixedController p;
+    volatile int16_t sink = 0;
+    clock_t start;
+    double floatTime;
+    double fixedTime;
+    int k;
+
+    PidFixedControllerInit(&p, PIDLIB_FIX(0.38), PIDLIB_FIX(1.3), PIDLIB_FIX(0.025), 0);
+    p.derivative_tau = 30;
+
+    start = clock();
+    for (k = 0; k < 10000000; k++) {
+        fp->error = (float)(k & 1023);
+        sink += PidControllerUpdate(fp);
+    }
+    floatTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (k = 0; k < 10000000; k++) {
+        sink += PidFixedControllerUpdate(&p, k & 1023, 10);
+    }
+    fixedTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    (void)sink;
+    printf("host timing   float %.1f ns, fixed %.1f ns per update\n", floatTime * 100, fixedTime * 100);
+}
+
+int
+main(void)
+{
+    int failed = 0;
+
+    failed += checkQuantisation();
+    failed += checkDriveLoops();
+    failed += checkAutotune();
+    timeUpdates();
+    printf("%s\n", failed ? "FAILED" : "passed");
+    return failed ? 1 : 0;
+}
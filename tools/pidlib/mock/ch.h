@@ -0,0 +1,24 @@
+/*
+ * ch.h - the parts of ChibiOS used by pidlib.c, for host builds
+ */
+
+#ifndef MOCK_CH_H_
+
+#define MOCK_CH_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef int bool_t;
+
+#define TRUE 1
+#define FALSE 0
+
+static inline void *
+chHeapAlloc(void *heap, size_t size)
+{
+    (void)heap;
+    return malloc(size);
+}
+
+#endif
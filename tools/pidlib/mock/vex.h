@@ -0,0 +1,27 @@
+/*
+ * vex.h - the parts of ConVEX used by pidlib.c, for host builds
+ */
+
+#ifndef MOCK_VEX_H_
+
+#define MOCK_VEX_H_
+
+#include "ch.h"
+
+typedef enum { kVexSensorUndefined = -1 } tVexSensors;
+
+static inline int32_t
+vexSensorValueGet(tVexSensors sensor)
+{
+    (void)sensor;
+    return 0;
+}
+
+static inline int
+vexSensorIsAnalog(tVexSensors sensor)
+{
+    (void)sensor;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * bench.c - time one interpreter tick on the host
+ *
+ * A 160 step script of groups of four moves, every other group also waiting
+ * on a sensor, is run with a 10 ms tick over and over through operations
+ * that do nothing.  The time per scriptTick is the interpreter overhead.
+ * A group of SCRIPT_GROUP_MAX sensor steps is timed as the worst case.
+ *
+ * The host has a far faster core than the cortex, the numbers are for
+ * comparing changes to the interpreter and not an absolute budget.
+ */
+
+#include "autonomous/script.c"
+
+#include <string.h>
+#include <time.h>
+
+#define STEPS 160
+#define TICKS 2000000
+
+uint32_t mockPages[kStoragePageNumber][STORAGE_PAGE_SIZE / 4];
+
+static volatile int32_t sink;
+
+static void
+benchMove(uint8_t mask, int16_t a, int16_t b)
+{
+    sink += mask + a + b;
+    return;
+}
+
+static int32_t
+benchSensor(uint8_t sensor)
+{
+    return sink + sensor;
+}
+
+static const scriptOps_t benchOps = {.move = benchMove, .sensor = benchSensor};
+
+static const scriptHeader_t *
+build(scriptStep_t *steps, uint16_t count, uint8_t group, bool sensors)
+{
+    scriptHeader_t *header = (scriptHeader_t *)mockPages[0];
+    uint16_t i;
+
+    for (i = 0; i < count; i++) {
+        scriptStep_t s = {SCRIPT_OP_MOVE, (uint8_t)(1 << (i % 6)), (int8_t)i, 100, 0, SCRIPT_SENSOR_NONE, 40, 0, 0};
+        if ((i % group) != group - 1) {
+            s.flags |= SCRIPT_FLAG_WITH_NEXT;
+        }
+        if (sensors && ((i / group) & 1) != 0) {
+            s.sensor = 2;
+            s.threshold = 30000;
+            s.duration = 60;
+        }
+        steps[i] = s;
+    }
+    header->magic = SCRIPT_MAGIC;
+    header->count = count;
+    memcpy(header + 1, steps, count * sizeof(scriptStep_t));
+    header->checksum = scriptChecksum(steps, count);
+    return header;
+}
+
+static double
+bench(const scriptHeader_t *header)
+{
+    script_t script;
+    clock_t start;
+    uint32_t now = 0;
+    long k;
+
+    scriptInit(&script, header, false, &benchOps, 0);
+    start = clock();
+    for (k = 0; k < TICKS; k++) {
+        if (!scriptTick(&script, now)) {
+            now = 0;
+            scriptInit(&script, header, false, &benchOps, 0);
+        } else {
+            now += 10;
+        }
+    }
+    return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / TICKS;
+}
+
+int
+main(void)
+{
+    scriptStep_t steps[STEPS];
+
+    printf("host timing   groups of 4 %.1f ns per tick\n", bench(build(steps, STEPS, 4, true)));
+    printf("host timing   groups of %d sensor steps %.1f ns per tick\n", SCRIPT_GROUP_MAX,
+           bench(build(steps, SCRIPT_GROUP_MAX * 4, SCRIPT_GROUP_MAX, true)));
+    return 0;
+}
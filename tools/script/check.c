@@ -0,0 +1,281 @@
+/*
+ * check.c - run scripts through the interpreter against mock operations
+ *
+ * The operations record the last command of every subsystem and how often
+ * it was sent, and read the sensors from a table the checks set.  The checks
+ * cover timed groups handing their intended end to the next group, parallel
+ * groups and their size limit, sensor conditions and their timeouts,
+ * mirroring, the end of a script, and loading scripts from the storage
+ * pages.  Every failed check is printed and the harness then fails.
+ */
+
+#include "autonomous/script.c"
+
+#include <string.h>
+
+#define SYSTEMS 6
+#define TICK 10
+
+uint32_t mockPages[kStoragePageNumber][STORAGE_PAGE_SIZE / 4];
+
+static int16_t lastA[SYSTEMS];
+static int16_t lastB[SYSTEMS];
+static int moves[SYSTEMS];
+static int32_t sensors[8];
+static int failures;
+
+static void
+mockMove(uint8_t mask, int16_t a, int16_t b)
+{
+    int i;
+
+    for (i = 0; i < SYSTEMS; i++) {
+        if (mask & (1 << i)) {
+            lastA[i] = a;
+            lastB[i] = b;
+            moves[i]++;
+        }
+    }
+    return;
+}
+
+static int32_t
+mockSensor(uint8_t sensor)
+{
+    return sensors[sensor];
+}
+
+static const scriptOps_t mockOps = {.move = mockMove, .sensor = mockSensor};
+
+static int
+systemIndex(uint8_t mask)
+{
+    int i;
+
+    for (i = 0; i < SYSTEMS; i++) {
+        if (mask == (1 << i)) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+static void
+expect(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+    return;
+}
+
+static scriptStep_t
+step(uint8_t op, uint8_t mask, int8_t a, int8_t b, uint8_t flags, uint16_t duration)
+{
+    scriptStep_t s = {op, mask, a, b, flags, SCRIPT_SENSOR_NONE, duration, 0, 0};
+    return s;
+}
+
+/* write a script to a storage page and return its header */
+static const scriptHeader_t *
+store(uint8_t slot, const scriptStep_t *steps, uint16_t count, uint16_t modes, uint16_t mirror)
+{
+    scriptHeader_t *header = (scriptHeader_t *)mockPages[slot];
+
+    memset(mockPages[slot], 0xff, sizeof(mockPages[slot]));
+    header->magic = SCRIPT_MAGIC;
+    header->count = count;
+    header->modes = modes;
+    header->mirror = mirror;
+    memcpy(header + 1, steps, count * sizeof(scriptStep_t));
+    header->checksum = scriptChecksum(steps, count);
+    return header;
+}
+
+static void
+reset(void)
+{
+    memset(lastA, 0, sizeof(lastA));
+    memset(lastB, 0, sizeof(lastB));
+    memset(moves, 0, sizeof(moves));
+    memset(sensors, 0, sizeof(sensors));
+    return;
+}
+
+/* tick a script until it ends, return the time it ended */
+static uint32_t
+runTo(script_t *script, uint32_t now, uint32_t limit)
+{
+    while (now <= limit && scriptTick(script, now)) {
+        now += TICK;
+    }
+    return now;
+}
+
+static void
+checkTiming(void)
+{
+    scriptStep_t steps[] = {
+        step(SCRIPT_OP_MOVE, ROBOT_DRIVE, 10, 100, 0, 25),
+        step(SCRIPT_OP_MOVE, ROBOT_INTAKE, 60, 0, 0, 25),
+        step(SCRIPT_OP_END, 0, 0, 0, 0, 0),
+    };
+    script_t script;
+    uint32_t end;
+
+    reset();
+    scriptInit(&script, store(0, steps, 3, 1, 0), false, &mockOps, 0);
+    expect(scriptTick(&script, 0) && lastA[systemIndex(ROBOT_DRIVE)] == 10 && lastB[systemIndex(ROBOT_DRIVE)] == 100,
+           "first step drives");
+    expect(scriptTick(&script, 30) && script.pc == 1 && script.start == 25, "timed step hands on its intended end");
+    expect(lastA[systemIndex(ROBOT_INTAKE)] == 60, "second step runs in the tick the first one ends");
+    end = runTo(&script, 40, 1000);
+    expect(end == 50, "script ends 50 ms after it started");
+    expect(lastA[systemIndex(ROBOT_DRIVE)] == 0 && lastA[systemIndex(ROBOT_INTAKE)] == 0, "end stops every system");
+    expect(!scriptTick(&script, end + TICK), "an ended script stays ended");
+    return;
+}
+
+static void
+checkParallel(void)
+{
+    scriptStep_t steps[] = {
+        step(SCRIPT_OP_MOVE, ROBOT_LIFT, 127, 0, SCRIPT_FLAG_WITH_NEXT, 100),
+        step(SCRIPT_OP_MOVE, ROBOT_INTAKE, 60, 0, 0, 40),
+        step(SCRIPT_OP_STOP, ROBOT_LIFT, 0, 0, 0, 10),
+    };
+    scriptStep_t many[12];
+    script_t script;
+    uint32_t now;
+    int intake;
+    int i;
+
+    reset();
+    scriptInit(&script, store(0, steps, 3, 1, 0), false, &mockOps, 0);
+    for (now = 0; now < 40; now += TICK) {
+        (void)scriptTick(&script, now);
+    }
+    expect(lastA[systemIndex(ROBOT_LIFT)] == 127 && lastA[systemIndex(ROBOT_INTAKE)] == 60, "a group runs its steps together");
+    (void)scriptTick(&script, 40);
+    intake = moves[systemIndex(ROBOT_INTAKE)];
+    for (now = 50; now < 100; now += TICK) {
+        (void)scriptTick(&script, now);
+    }
+    expect(moves[systemIndex(ROBOT_INTAKE)] == intake, "a finished step is not sent again");
+    expect(script.pc == 0, "a group waits for its longest step");
+    (void)scriptTick(&script, 100);
+    expect(script.pc == 2 && script.start == 100 && lastA[systemIndex(ROBOT_LIFT)] == 0, "the next group starts on time");
+    expect(runTo(&script, 110, 1000) == 110, "a script without an end op ends after its last step");
+
+    for (i = 0; i < 12; i++) {
+        many[i] = step(SCRIPT_OP_WAIT, 0, 0, 0, SCRIPT_FLAG_WITH_NEXT, 10);
+    }
+    scriptInit(&script, store(0, many, 12, 1, 0), false, &mockOps, 0);
+    expect(script.end - script.pc == SCRIPT_GROUP_MAX, "a group has at most SCRIPT_GROUP_MAX steps");
+    return;
+}
+
+static void
+checkSensors(void)
+{
+    scriptStep_t steps[] = {
+        step(SCRIPT_OP_MOVE, ROBOT_ARM, 50, 0, 0, 1000),
+        step(SCRIPT_OP_MOVE, ROBOT_ARM, -50, 0, SCRIPT_FLAG_BELOW, 0),
+        step(SCRIPT_OP_MOVE, ROBOT_ARM, 20, 0, 0, 300),
+        step(SCRIPT_OP_END, 0, 0, 0, 0, 0),
+    };
+    script_t script;
+    uint32_t now;
+
+    steps[0].sensor = steps[1].sensor = steps[2].sensor = 3;
+    steps[0].threshold = 500;
+    steps[1].threshold = 100;
+    steps[2].threshold = 2000;
+
+    reset();
+    scriptInit(&script, store(0, steps, 4, 1, 0), false, &mockOps, 0);
+    for (now = 0; now < 1000; now += TICK) {
+        sensors[3] = (int32_t)now * 4;
+        (void)scriptTick(&script, now);
+        if (script.pc != 0) {
+            break;
+        }
+    }
+    expect(now == 130 && script.start == 130, "a sensor step ends when its condition holds, the next group starts then");
+    expect(lastA[systemIndex(ROBOT_ARM)] == -50, "the next step runs in the same tick");
+    for (now += TICK; now < 1000; now += TICK) {
+        sensors[3] = 520 - ((int32_t)now - 130) * 4;
+        (void)scriptTick(&script, now);
+        if (script.pc != 1) {
+            break;
+        }
+    }
+    expect(now == 240 && script.start == 240, "a below condition ends when the value drops to the threshold");
+    now = runTo(&script, now + TICK, 2000);
+    expect(now == 540 && lastA[systemIndex(ROBOT_ARM)] == 0, "a sensor step without its condition ends at its timeout");
+    return;
+}
+
+static void
+checkMirror(void)
+{
+    scriptStep_t steps[] = {
+        step(SCRIPT_OP_MOVE, ROBOT_DRIVE, 40, 80, SCRIPT_FLAG_MIRROR | SCRIPT_FLAG_WITH_NEXT, 10),
+        step(SCRIPT_OP_MOVE, ROBOT_SETTER, 30, 0, 0, 10),
+    };
+    script_t script;
+
+    reset();
+    scriptInit(&script, store(0, steps, 2, 1, 0), true, &mockOps, 0);
+    (void)scriptTick(&script, 0);
+    expect(lastA[systemIndex(ROBOT_DRIVE)] == -40 && lastB[systemIndex(ROBOT_DRIVE)] == 80, "mirroring negates a");
+    expect(lastA[systemIndex(ROBOT_SETTER)] == 30, "steps without the mirror flag are not mirrored");
+    scriptInit(&script, store(0, steps, 2, 1, 0), false, &mockOps, 0);
+    (void)scriptTick(&script, 0);
+    expect(lastA[systemIndex(ROBOT_DRIVE)] == 40, "an unmirrored run keeps a");
+    return;
+}
+
+static void
+checkStorage(void)
+{
+    scriptStep_t steps[] = {
+        step(SCRIPT_OP_MOVE, ROBOT_DRIVE, 0, 127, 0, 500),
+        step(SCRIPT_OP_END, 0, 0, 0, 0, 0),
+    };
+    scriptHeader_t *header;
+    bool mirror = false;
+
+    memset(mockPages, 0xff, sizeof(mockPages));
+    expect(scriptLoad(0) == NULL && scriptFind(0, &mirror) == NULL, "an erased page holds no script");
+
+    header = (scriptHeader_t *)store(1, steps, 2, 0x0003, 0x0002);
+    expect(scriptLoad(1) == header, "a stored script loads");
+    expect(scriptFind(0, &mirror) == header && !mirror, "a script is found for its modes");
+    expect(scriptFind(1, &mirror) == header && mirror, "a script runs mirrored for its mirror modes");
+    expect(scriptFind(2, &mirror) == NULL && scriptFind(16, &mirror) == NULL, "no script for other modes");
+    expect(scriptLoad(SCRIPT_SLOTS) == NULL, "slots past the last one are empty");
+
+    ((scriptStep_t *)(header + 1))[0].b = 100;
+    expect(scriptLoad(1) == NULL, "a changed step fails the checksum");
+    header = (scriptHeader_t *)store(1, steps, 2, 1, 0);
+    header->count = (STORAGE_PAGE_SIZE / sizeof(scriptStep_t)) + 1;
+    expect(scriptLoad(1) == NULL, "a script larger than its page is rejected");
+    header = (scriptHeader_t *)store(1, steps, 2, 1, 0);
+    header->magic = 0;
+    expect(scriptLoad(1) == NULL, "a page without the magic is rejected");
+    return;
+}
+
+int
+main(void)
+{
+    checkTiming();
+    checkParallel();
+    checkSensors();
+    checkMirror();
+    checkStorage();
+    printf("script checks %s\n", failures ? "failed" : "passed");
+    return failures ? 1 : 0;
+}
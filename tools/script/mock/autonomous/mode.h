@@ -0,0 +1,28 @@
+/*
+ * autonomous/mode.h - the subsystem masks and moves used by script.c, for
+ * host builds
+ */
+
+#ifndef MOCK_AUTONOMOUS_MODE_H_
+
+#define MOCK_AUTONOMOUS_MODE_H_
+
+#include "vex.h"
+
+#define ROBOT_ARM 0x01
+#define ROBOT_DRIVE 0x02
+#define ROBOT_INTAKE 0x04
+#define ROBOT_FLIPPER 0x20
+#define ROBOT_LIFT 0x08
+#define ROBOT_SETTER 0x10
+#define ROBOT_ALL (ROBOT_ARM | ROBOT_DRIVE | ROBOT_INTAKE | ROBOT_FLIPPER | ROBOT_LIFT | ROBOT_SETTER)
+
+static inline void armMove(int16_t cmd, bool immediate) { (void)cmd; (void)immediate; }
+static inline void driveMove(int16_t x, int16_t y, bool immediate) { (void)x; (void)y; (void)immediate; }
+static inline void intakeMove(int16_t cmd, bool immediate) { (void)cmd; (void)immediate; }
+static inline void flipperMove(int16_t cmd, bool immediate) { (void)cmd; (void)immediate; }
+static inline void liftMove(int16_t cmd, bool immediate) { (void)cmd; (void)immediate; }
+static inline void setterMove(int16_t cmd, bool immediate) { (void)cmd; (void)immediate; }
+static inline void systemUnlockAll(void) {}
+
+#endif
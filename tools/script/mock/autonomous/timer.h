@@ -0,0 +1,27 @@
+/*
+ * autonomous/timer.h - the ticker and timer calls used by script.c, for
+ * host builds
+ *
+ * scriptRun only has to build, the harness calls scriptTick itself.
+ */
+
+#ifndef MOCK_AUTONOMOUS_TIMER_H_
+
+#define MOCK_AUTONOMOUS_TIMER_H_
+
+#include "ch.h"
+
+#define AUTONOMOUS_TIMER_PERIOD 10
+#define AUTONOMOUS_TIMER_LOG 0
+
+typedef struct {
+    systime_t epoch;
+} ticker_t;
+
+static inline void tickerInit(ticker_t *ticker, uint32_t periodMs) { ticker->epoch = 0; (void)periodMs; }
+static inline systime_t tickerElapsed(const ticker_t *ticker) { (void)ticker; return 0; }
+static inline bool tickerWait(ticker_t *ticker) { (void)ticker; return true; }
+static inline bool tickerWaitBounded(ticker_t *ticker, systime_t limit) { (void)ticker; (void)limit; return true; }
+static inline void timerSync(void) {}
+
+#endif
@@ -0,0 +1,21 @@
+/*
+ * ch.h - the parts of ChibiOS used by script.c, for host builds
+ */
+
+#ifndef MOCK_CH_H_
+
+#define MOCK_CH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int bool_t;
+typedef uint32_t systime_t;
+
+#define TRUE 1
+#define FALSE 0
+#define CH_FREQUENCY 1000
+#define MS2ST(x) (x)
+
+#endif
@@ -0,0 +1,11 @@
+/*
+ * hal.h - the parts of the ChibiOS HAL used by script.c, for host builds
+ */
+
+#ifndef MOCK_HAL_H_
+
+#define MOCK_HAL_H_
+
+#include "ch.h"
+
+#endif
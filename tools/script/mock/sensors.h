@@ -0,0 +1,21 @@
+/*
+ * sensors.h - the sensor snapshot used by script.c, for host builds
+ *
+ * The harness runs scripts through its own operations, the robot ones
+ * only need to build.
+ */
+
+#ifndef MOCK_SENSORS_H_
+
+#define MOCK_SENSORS_H_
+
+#include "vex.h"
+
+typedef struct {
+    int dummy;
+} sensorsSnapshot_t;
+
+static inline const sensorsSnapshot_t *sensorsGet(void) { return NULL; }
+static inline int32_t sensorsValue(const sensorsSnapshot_t *snapshot, tVexSensors sensor) { (void)snapshot; (void)sensor; return 0; }
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ * storage.h - the flash pages used by script.c, for host builds
+ *
+ * The pages are plain memory the harness fills in.
+ */
+
+#ifndef MOCK_STORAGE_H_
+
+#define MOCK_STORAGE_H_
+
+#include "ch.h"
+
+#define STORAGE_PAGE_SIZE 2048
+
+typedef enum { kStoragePageScript0 = 0, kStoragePageScript1, kStoragePageNumber } kStoragePageType;
+
+extern uint32_t mockPages[kStoragePageNumber][STORAGE_PAGE_SIZE / 4];
+
+static inline const void *
+storageAddress(kStoragePageType page)
+{
+    return mockPages[page];
+}
+
+#endif
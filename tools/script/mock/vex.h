@@ -0,0 +1,16 @@
+/*
+ * vex.h - the parts of ConVEX used by script.c, for host builds
+ */
+
+#ifndef MOCK_VEX_H_
+
+#define MOCK_VEX_H_
+
+#include "ch.h"
+#include <stdio.h>
+
+typedef int16_t tVexSensors;
+
+#define vex_printf printf
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * current.c - compare the fixed point SmartMotor models with the float ones
+ *
+ * Sweeps command, rpm (to 1.5x free speed either way) and battery (6.5 to
+ * 8.5V) for each motor type and reports the largest and rms difference in
+ * the modeled current.  Then runs a 10s stall and 20s recovery through both
+ * temperature models and reports the largest difference.
+ *
+ * Only accuracy is checked here, the cycle counts of the two paths need the
+ * cortex and are not measured by this harness.
+ */
+
+#include "smartmotor.c"
+
+#include <stdio.h>
+
+static const char *names[] = {"269", "393 torque", "393 speed", "393 turbo"};
+
+static int
+sweepCurrent(int port)
+{
+    smartMotor *m = _SmartMotorGetPtr(port);
+    double worst = 0;
+    double sum = 0;
+    long count = 0;
+    int worstCmd = 0;
+    int worstRpm = 0;
+    int worstBattery = 0;
+    int battery;
+    int cmd;
+    int rpm;
+    int limit = (int)(m->rpm_free * 1.5);
+
+    for (battery = 6500; battery <= 8500; battery += 100) {
+        for (cmd = -127; cmd <= 127; cmd++) {
+            for (rpm = -limit; rpm <= limit; rpm++) {
+                float reference;
+                int32_t fixed;
+                double error;
+
+                mockMotors[port] = cmd;
+                m->rpm = rpm;
+                reference = SmartMotorCurrent(m, battery / 1000.0f);
+                fixed = SmartMotorCurrentFixed(m, (battery << 16) / 1000);
+                error = fabs(reference - FIX2F(fixed));
+                sum += error * error;
+                count++;
+                if (error > worst) {
+                    worst = error;
+                    worstCmd = cmd;
+                    worstRpm = rpm;
+                    worstBattery = battery;
+                }
+            }
+        }
+    }
+    printf("%-10s current  max %7.4f mA  rms %7.4f mA  (cmd %4d rpm %4d battery %4d mV)\n", names[port], worst * 1000,
+           sqrt(sum / count) * 1000, worstCmd, worstRpm, worstBattery);
+    return (worst < 0.001) ? 0 : 1;
+}
+
+static int
+traceTemperature(int port)
+{
+    smartMotor *m = _SmartMotorGetPtr(port);
+    float reference = m->t_ambient;
+    int32_t fixed = FIX(m->t_ambient);
+    double worst = 0;
+    int t;
+
+    // 10s stalled then 20s at a light load, 10ms steps
+    for (t = 0; t < 3000; t++) {
+        m->current = (t < 1000) ? m->i_stall * 0.8f : 0.5f;
+        m->fx_current = FIX(m->current);
+
+        m->temperature = reference;
+        SmartMotorTemperature(m, 10);
+        reference = m->temperature;
+
+        m->fx_temperature = fixed;
+        SmartMotorTemperatureFixed(m, 10);
+        fixed = m->fx_temperature;
+
+        if (fabs(reference - FIX2F(fixed)) > worst) {
+            worst = fabs(reference - FIX2F(fixed));
+        }
+    }
+    printf("%-10s temp     max %7.4f C   (end %.2f C float, %.2f C fixed)\n", names[port], worst, reference, FIX2F(fixed));
+    return (worst < 0.05) ? 0 : 1;
+}
+
+int
+main(void)
+{
+    int failed = 0;
+    int port;
+
+    SmartMotorsInit();
+    SmartMotorFixedSync();
+    for (port = 0; port < 4; port++) {
+        failed += sweepCurrent(port);
+        failed += traceTemperature(port);
+    }
+    printf("%s\n", failed ? "FAILED" : "passed");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,14 @@
+/*
+ * hal.h - the parts of the ChibiOS HAL used by smartmotor.c, for host builds
+ */
+
+#ifndef MOCK_HAL_H_
+
+#define MOCK_HAL_H_
+
+#include "ch.h"
+
+#define halGetCounterValue() (0)
+#define halGetCounterFrequency() (72000000)
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * vex.c - host stand-ins for the ConVEX calls made by smartmotor.c
+ */
+
+#include "vex.h"
+
+systime_t mockNow;
+int16_t mockMotors[kVexMotorNum];
+
+// one of each motor type on the first four ports
+static const tVexMotorType mockTypes[kVexMotorNum] = {kVexMotor269, kVexMotor393T, kVexMotor393S, kVexMotor393R};
+
+int16_t vexMotorGet(int16_t index) { return mockMotors[index]; }
+void vexMotorSet(int16_t index, int16_t value) { mockMotors[index] = value; }
+int32_t vexMotorPositionGet(int16_t index) { (void)index; return 0; }
+int32_t vexMotorVelocityGet(int16_t index) { (void)index; return 0; }
+int16_t vexMotorTypeGet(int16_t index) { return mockTypes[index]; }
+int16_t vexMotorEncoderIdGet(int16_t index) { (void)index; return -1; }
+int16_t vexAdcGet(int16_t index) { (void)index; return 2000; }
+uint16_t vexSpiGetMainBattery(void) { return 7800; }
+void vexDigitalPinSet(int16_t pin, int16_t value) { (void)pin; (void)value; }
+void vexTracePoint(tVexTraceStage stage) { (void)stage; }
+void vexSleep(int32_t ms) { mockNow += ms; }
+void vexTaskRegisterPersistant(const char *name, bool_t persistent) { (void)name; (void)persistent; }
+Thread *StartTaskWithPriority(tfunc_t pf, tprio_t priority, ...) { (void)pf; (void)priority; return NULL; }
+void StopTask(tfunc_t pf) { (void)pf; }
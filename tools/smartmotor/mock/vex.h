@@ -0,0 +1,73 @@
+/*
+ * vex.h - the parts of ConVEX used by smartmotor.c, for host builds
+ */
+
+#ifndef MOCK_VEX_H_
+
+#define MOCK_VEX_H_
+
+#include "ch.h"
+#include <stdio.h>
+
+typedef enum {
+    kVexMotorUndefined = 0,
+    kVexMotor269,
+    kVexMotor393T,
+    kVexMotor393S,
+    kVexMotor393R
+} tVexMotorType;
+
+typedef enum {
+    kVexMotor_1 = 0,
+    kVexMotor_2,
+    kVexMotor_3,
+    kVexMotor_4,
+    kVexMotor_5,
+    kVexMotor_6,
+    kVexMotor_7,
+    kVexMotor_8,
+    kVexMotor_9,
+    kVexMotor_10,
+    kVexMotorNum
+} tVexMotor;
+
+typedef enum {
+    kVexAnalog_1 = 0,
+    kVexAnalog_2,
+    kVexAnalog_3,
+    kVexAnalog_4,
+    kVexAnalog_5,
+    kVexAnalog_6,
+    kVexAnalog_7,
+    kVexAnalog_8,
+    kVexAnalog_None = -1
+} tVexAnalogPin;
+
+typedef enum { kVexDigital_1 = 0, kVexDigital_12 = 11, kVexDigital_None = -1 } tVexDigitalPin;
+
+typedef enum { kVexTraceControl, kVexTraceSetMotor, kVexTraceMotor, kVexTracePwm, kVexTraceSpi, kVexTraceNum } tVexTraceStage;
+
+typedef void vexStream;
+
+extern int16_t mockMotors[kVexMotorNum];
+
+int16_t vexMotorGet(int16_t index);
+void vexMotorSet(int16_t index, int16_t value);
+int32_t vexMotorPositionGet(int16_t index);
+int32_t vexMotorVelocityGet(int16_t index);
+int16_t vexMotorTypeGet(int16_t index);
+int16_t vexMotorEncoderIdGet(int16_t index);
+int16_t vexAdcGet(int16_t index);
+uint16_t vexSpiGetMainBattery(void);
+void vexDigitalPinSet(int16_t pin, int16_t value);
+void vexTracePoint(tVexTraceStage stage);
+void vexSleep(int32_t ms);
+void vexTaskRegisterPersistant(const char *name, bool_t persistent);
+Thread *StartTaskWithPriority(tfunc_t pf, tprio_t priority, ...);
+void StopTask(tfunc_t pf);
+
+// the debug output is not needed, and the formats are for the cortex
+#define vex_printf(...) ((void)0)
+#define vex_chprintf(chp, ...) ((void)(chp))
+
+#endif
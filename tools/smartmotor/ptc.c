@@ -0,0 +1,160 @@
+/*
+ * ptc.c - check the PTC prediction and count trips with and without it
+ *
+ * First compares the fixed point prediction with the float one over a grid
+ * of PTC temperature and current, for a 393 and for a cortex bank.  Then
+ * drives a 393 on the fixed point monitor path through a 120s cycle of 5s
+ * pushing against a wall and 5s driving, once with the PTC limit alone and
+ * once with the prediction derating it as well, and counts the trips.  The
+ * harness fails if the predictive run trips at all.
+ */
+
+#include "smartmotor.c"
+
+#include <stdio.h>
+
+#define PORT kVexMotor_2
+#define BATTERY 7800
+
+static double worstTrip;
+static long worstShort;
+static double worstAllowed;
+static int mismatched;
+
+static void
+compare(long tripFloat, float allowedFloat, long tripFixed, int32_t allowedFixed)
+{
+    double error;
+
+    if (tripFloat == SMLIB_TRIP_NEVER || tripFixed == SMLIB_TRIP_NEVER) {
+        // allow the two to disagree right at the edge of never tripping
+        if (tripFloat != tripFixed && labs((tripFloat == SMLIB_TRIP_NEVER) ? tripFixed : tripFloat) < 1000000) {
+            mismatched++;
+        }
+    } else if (tripFloat < 1000) {
+        // under a second the error is a few ms, relative to the trip time it looks large
+        if (labs(tripFloat - tripFixed) > worstShort) {
+            worstShort = labs(tripFloat - tripFixed);
+        }
+    } else {
+        error = labs(tripFloat - tripFixed) / (double)tripFloat;
+        if (error > worstTrip) {
+            worstTrip = error;
+        }
+    }
+    error = fabs(allowedFloat - FIX2F(allowedFixed));
+    if (error > worstAllowed) {
+        worstAllowed = error;
+    }
+}
+
+static int
+checkPrediction(void)
+{
+    smartMotor *m = _SmartMotorGetPtr(PORT);
+    smartController *s = _SmartMotorControllerGetPtr(0);
+    long trip;
+    float allowed;
+    int k;
+
+    for (k = 0; k < 4000; k++) {
+        float temperature = SMLIB_TEMP_AMBIENT + (k / 50) * 1.0f;
+        float current = (k % 50) * 0.1f;
+
+        m->temperature = temperature;
+        m->current = current;
+        SmartMotorPredictPtc(m);
+        trip = m->trip_time;
+        allowed = m->allowed_current;
+        m->fx_temperature = FIX(temperature);
+        m->fx_current = FIX(current);
+        SmartMotorPredictPtcFixed(m);
+        compare(trip, allowed, m->trip_time, m->fx_allowed);
+
+        s->temperature = temperature;
+        s->current = current * 2;
+        SmartMotorControllerPredictPtc(s);
+        trip = s->trip_time;
+        allowed = s->allowed_current;
+        s->fx_temperature = FIX(temperature);
+        s->fx_current = FIX(current * 2);
+        SmartMotorControllerPredictPtcFixed(s);
+        compare(trip, allowed, s->trip_time, s->fx_allowed);
+    }
+    printf("prediction  trip time max %.2f%% (%ld ms under 1s)  allowed current max %.1f mA  never mismatches %d\n",
+           worstTrip * 100, worstShort, worstAllowed * 1000, mismatched);
+    return (worstTrip < 0.02 && worstShort <= 20 && worstAllowed < 0.005 && mismatched == 0) ? 0 : 1;
+}
+
+static int
+runCycle(bool predict)
+{
+    smartMotor *m = _SmartMotorGetPtr(PORT);
+    int32_t vb = (BATTERY << 16) / 1000;
+    double peak = 0;
+    double amps = 0;
+    int trips = 0;
+    int derated = 0;
+    bool tripped;
+    int cmd;
+    int t;
+
+    if (predict) {
+        SmartMotorPtcPredictEnable();
+    } else {
+        SmartMotorPtcPredictDisable();
+    }
+    m->fx_temperature = FIX(SMLIB_TEMP_AMBIENT);
+    m->ptc_tripped = FALSE;
+    m->derating = FALSE;
+    m->limit_cmd = SMLIB_MOTOR_MAX_CMD_UNDEFINED;
+
+    // 10ms monitor period
+    for (t = 0; t < 12000; t++) {
+        bool pushing = ((t / 500) % 2) == 0;
+
+        // the driver holds full stick, the limit cuts it back as the slew task would
+        m->motor_cmd = 127;
+        cmd = SmartMotorSlewRequest(m);
+        mockMotors[PORT] = cmd;
+        m->rpm = pushing ? 0 : (m->rpm_free * cmd * 0.7f) / 127;
+
+        SmartMotorCurrentFixed(m, vb);
+        SmartMotorTemperatureFixed(m, 10);
+        SmartMotorPredictPtcFixed(m);
+        tripped = m->ptc_tripped;
+        SmartMotorMonitorPtcFixed(m, vb);
+        if (!tripped && m->ptc_tripped) {
+            trips++;
+        }
+        if (m->derating) {
+            derated++;
+        }
+        if (FIX2F(m->fx_temperature) > peak) {
+            peak = FIX2F(m->fx_temperature);
+        }
+        amps += fabs(FIX2F(m->fx_current));
+    }
+    printf("%-10s  trips %d  peak %.1f C  derating %.1fs  mean current %.2f A\n", predict ? "predictive" : "reactive", trips,
+           peak, derated / 100.0, amps / 12000);
+    return trips;
+}
+
+int
+main(void)
+{
+    int failed;
+
+    SmartMotorsInit();
+    SmartMotorPredictSync();
+    SmartMotorFixedSync();
+    SmartMotorPtcMonitorEnable();
+
+    failed = checkPrediction();
+    runCycle(false);
+    if (runCycle(true) != 0) {
+        failed = 1;
+    }
+    printf("%s\n", failed ? "FAILED" : "passed");
+    return failed;
+}
@@ -0,0 +1,174 @@
+/*
+ * edges.c - run modelled quad encoder edges through the encoder interrupts
+ *
+ * A 360 count encoder turns at a steady speed.  Its A channel is high for
+ * SIM_DUTY more than half of each cycle and its B channel is SIM_PHASE of a
+ * cycle away from quadrature, as a worn encoder is.  Every edge calls the
+ * interrupt handler vexEncoderAdd hands to vexExtSet, up to SIM_LATENCY us
+ * late, the cycle counter runs at 72MHz and wraps one second into each
+ * case.  The model is stepped every us.
+ *
+ * vexEncoderVelocityGet is called every SIM_SAMPLE ms, up to SIM_JITTER us
+ * late as the SmartMotor task is, and compared with the true speed after
+ * the first SIM_SETTLE ms.  Count differencing over the time between the
+ * same samples is shown beside it.  Each
+ * case then stops the encoder and the velocity must read 0 once
+ * VEX_ENCODER_VEL_TIMEOUT has passed.  The harness fails if the RMS error
+ * of a case is above its limit or no better than count differencing.
+ */
+
+#include "vex.h"
+
+#include "vexencoder.c"
+
+#include <math.h>
+#include <stdio.h>
+
+#define SIM_DUTY 0.05
+#define SIM_PHASE 0.03
+#define SIM_LATENCY 8
+#define SIM_SAMPLE 20
+#define SIM_JITTER 2000
+#define SIM_SETTLE 500
+#define SIM_RUN 3000
+#define SIM_STOP (VEX_ENCODER_VEL_TIMEOUT + 2 * SIM_SAMPLE)
+
+#define PIN_A kVexDigital_1
+#define PIN_B kVexDigital_2
+
+typedef struct {
+    const char *name;
+    double rpm;
+    double limit; // RMS error in counts/s, 2% of the speed but at least 3
+} case_t;
+
+static const case_t cases[] = {
+    {"3 rpm", 3, 3},       {"-3 rpm", -3, 3},       {"100 rpm", 100, 12},
+    {"-100 rpm", -100, 12}, {"150 rpm", 150, 18}, {"-150 rpm", -150, 18},
+};
+
+EXTDriver EXTD1;
+uint32_t mockCycles;
+int mockPins[16];
+ioDef vexioDefinition[kVexDigital_Num] = {{0, 0}, {0, 1}, {0, 2}, {0, 3}, {0, 4},  {0, 5},
+                                          {0, 6}, {0, 7}, {0, 8}, {0, 9}, {0, 10}, {0, 11}};
+
+static extcallback_t handlers[16];
+static uint32_t seed = 1;
+
+void
+vexExtSet(ioportid_t port, uint16_t channel, uint32_t mode, extcallback_t cb)
+{
+    (void)port;
+    (void)mode;
+    handlers[channel] = cb;
+    return;
+}
+
+static uint32_t
+random32(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+/* the channels at x quadrature cycles, B leads A when turning forward */
+static void
+pinsAt(double x, int *a, int *b)
+{
+    double f = x - floor(x);
+    double g = x - 0.25 - SIM_PHASE;
+
+    g -= floor(g);
+    *b = (f < 0.5);
+    *a = (g < 0.5 + SIM_DUTY);
+    return;
+}
+
+static int
+runCase(const case_t *c)
+{
+    // counts per us, four counts to a quadrature cycle
+    double rate = c->rpm * 360 / 60 / 1e6;
+    double actual = c->rpm * 360 / 60;
+    double x = 0;
+    double sum = 0;
+    double sumDiff = 0;
+    double rms;
+    double rmsDiff;
+    uint32_t base = 0xFFFFFFFF - 72000000u;
+    uint32_t t;
+    uint32_t sample = SIM_SAMPLE * 1000;
+    uint32_t previous = 0;
+    int32_t pending[2] = {-1, -1};
+    int32_t last = 0;
+    int32_t v;
+    int32_t diff;
+    int samples = 0;
+    int pins[2];
+    int failed;
+    int i;
+
+    mockCycles = base;
+    pinsAt(0, &pins[0], &pins[1]);
+    mockPins[vexioDefinition[PIN_A].pad] = pins[0];
+    mockPins[vexioDefinition[PIN_B].pad] = pins[1];
+    vexEncoderInit();
+    vexEncoderAdd(kVexQuadEncoder_1, PIN_A, PIN_B);
+    vexEncoderStart(kVexQuadEncoder_1);
+
+    for (t = 1; t <= (SIM_RUN + SIM_STOP) * 1000; t++) {
+        mockCycles = base + t * 72;
+        if (t <= SIM_RUN * 1000) {
+            x += rate / 4;
+        }
+        pinsAt(x, &pins[0], &pins[1]);
+        for (i = 0; i < 2; i++) {
+            int pad = vexioDefinition[i ? PIN_B : PIN_A].pad;
+
+            if (pins[i] != mockPins[pad]) {
+                mockPins[pad] = pins[i];
+                pending[i] = (int32_t)(t + 1 + random32() % SIM_LATENCY);
+            }
+            if (pending[i] == (int32_t)t) {
+                pending[i] = -1;
+                handlers[pad](&EXTD1, pad);
+            }
+        }
+
+        if (t == sample) {
+            v = vexEncoderVelocityGet(kVexQuadEncoder_1);
+            diff = (int32_t)((vexEncoderGet(kVexQuadEncoder_1) - last) * 1000000LL / (t - previous));
+            last = vexEncoderGet(kVexQuadEncoder_1);
+            previous = t;
+            sample = (t / (SIM_SAMPLE * 1000) + 1) * SIM_SAMPLE * 1000 + random32() % SIM_JITTER;
+            if (t > SIM_SETTLE * 1000 && t <= SIM_RUN * 1000) {
+                sum += (v - actual) * (v - actual);
+                sumDiff += (diff - actual) * (diff - actual);
+                samples++;
+            }
+        }
+    }
+
+    rms = sqrt(sum / samples);
+    rmsDiff = sqrt(sumDiff / samples);
+    v = vexEncoderVelocityGet(kVexQuadEncoder_1);
+    failed = (rms > c->limit || rms >= rmsDiff || v != 0);
+    printf("%-9s %6.0f counts/s  RMS error %5.2f, count differencing %5.2f  stopped %ld%s\n", c->name, actual, rms, rmsDiff,
+           (long)v, failed ? "  FAILED" : "");
+    return failed;
+}
+
+int
+main(void)
+{
+    int failed = 0;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        failed |= runCase(&cases[i]);
+    }
+    return failed;
+}
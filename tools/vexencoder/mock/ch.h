@@ -0,0 +1,27 @@
+/*
+ * ch.h - the parts of ChibiOS used by vexencoder.c, for host builds
+ *
+ * The harness calls the interrupt handlers and vexEncoderVelocityGet from
+ * one thread, so the locks do nothing.
+ */
+
+#ifndef MOCK_CH_H_
+
+#define MOCK_CH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef int bool_t;
+typedef int32_t msg_t;
+typedef uint32_t systime_t;
+
+#define TRUE 1
+#define FALSE 0
+
+static inline void chSysLock(void) {}
+static inline void chSysUnlock(void) {}
+static inline void chSysLockFromIsr(void) {}
+static inline void chSysUnlockFromIsr(void) {}
+
+#endif
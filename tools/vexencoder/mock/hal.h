@@ -0,0 +1,49 @@
+/*
+ * hal.h - the parts of the ChibiOS HAL used by vexencoder.c, for host builds
+ *
+ * The pins and the cycle counter are provided by the harness from its
+ * encoder model.
+ */
+
+#ifndef MOCK_HAL_H_
+
+#define MOCK_HAL_H_
+
+#include "ch.h"
+
+#define EXT_CH_MODE_BOTH_EDGES 3
+
+typedef int ioportid_t;
+typedef uint32_t expchannel_t;
+typedef struct {
+    int dummy;
+} EXTDriver;
+typedef void (*extcallback_t)(EXTDriver *extp, expchannel_t channel);
+
+extern EXTDriver EXTD1;
+extern uint32_t mockCycles;
+extern int mockPins[16];
+
+static inline uint32_t
+halGetCounterValue(void)
+{
+    return mockCycles;
+}
+
+static inline uint32_t
+halGetCounterFrequency(void)
+{
+    return 72000000;
+}
+
+static inline int
+palReadPad(ioportid_t port, int16_t pad)
+{
+    (void)port;
+    return mockPins[pad];
+}
+
+static inline void extChannelEnable(EXTDriver *extp, expchannel_t channel) { (void)extp; (void)channel; }
+static inline void extChannelDisable(EXTDriver *extp, expchannel_t channel) { (void)extp; (void)channel; }
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * ch.h - the parts of ChibiOS used by vexgyro.c, for host builds
+ *
+ * The gyro task runs to completion inside chThdCreateStatic, every
+ * millisecond it sleeps the clock moves on and the robot model is stepped.
+ */
+
+#ifndef MOCK_CH_H_
+
+#define MOCK_CH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef int bool_t;
+typedef int32_t msg_t;
+typedef uint32_t systime_t;
+typedef msg_t (*tfunc_t)(void *);
+typedef struct {
+    int dummy;
+} Thread;
+
+#define TRUE 1
+#define FALSE 0
+#define WORKING_AREA(s, n) char s[n]
+#define USER_TASK_STACK_SIZE 256
+#define USER_THREAD_PRIORITY 64
+
+extern systime_t mockNow;
+extern systime_t mockEnd;
+extern void mockTick(void);
+
+static inline systime_t
+chTimeNow(void)
+{
+    return mockNow;
+}
+
+static inline void
+chThdSleepMilliseconds(int ms)
+{
+    while (ms-- > 0) {
+        mockNow++;
+        mockTick();
+    }
+}
+
+static inline bool
+chThdShouldTerminate(void)
+{
+    return mockNow >= mockEnd;
+}
+
+static inline Thread *
+chThdCreateStatic(void *wsp, int size, int prio, tfunc_t pf, void *arg)
+{
+    (void)wsp;
+    (void)size;
+    (void)prio;
+    (void)pf(arg);
+    return NULL;
+}
+
+static inline void chRegSetThreadName(const char *name) { (void)name; }
+static inline void chThdTerminate(Thread *tp) { (void)tp; }
+static inline void chThdWait(Thread *tp) { (void)tp; }
+
+#endif
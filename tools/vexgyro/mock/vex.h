@@ -0,0 +1,55 @@
+/*
+ * vex.h - the parts of ConVEX used by vexgyro.c, for host builds
+ *
+ * The functions are provided by the harness from its robot model.
+ */
+
+#ifndef MOCK_VEX_H_
+
+#define MOCK_VEX_H_
+
+#include "ch.h"
+
+#define VEX_ADC_DEPTH 16
+
+typedef enum {
+    kVexMotor_1 = 0,
+    kVexMotor_2,
+    kVexMotor_3,
+    kVexMotor_4,
+    kVexMotor_5,
+    kVexMotor_6,
+    kVexMotor_7,
+    kVexMotor_8,
+    kVexMotor_9,
+    kVexMotor_10,
+    kVexMotorNum
+} tVexMotor;
+
+typedef enum {
+    kVexAnalog_1 = 0,
+    kVexAnalog_2,
+    kVexAnalog_3,
+    kVexAnalog_4,
+    kVexAnalog_5,
+    kVexAnalog_6,
+    kVexAnalog_7,
+    kVexAnalog_8,
+    kVexAnalog_None = -1
+} tVexAnalogPin;
+
+typedef enum {
+    kVexQuadEncoder_1 = 0,
+    kVexQuadEncoder_2,
+    kVexQuadEncoder_3,
+    kVexQuadEncoder_4,
+    kVexQuadEncoder_5,
+    kVexQuadEncoder_Num
+} tVexQuadEncoderChannel;
+
+extern int32_t vexAdcGetSum(int16_t index);
+extern int16_t vexMotorGet(int16_t index);
+extern int32_t vexMotorPositionGet(int16_t index);
+extern int32_t vexEncoderGet(int16_t channel);
+
+#endif
@@ -0,0 +1,234 @@
+/*
+ * replay.c - replay synthetic gyro traces through the gyro task
+ *
+ * Each trace is 120s of a robot standing still for 15s, running an
+ * autonomous period, standing still for 3s and then driving with a 2s pause
+ * every 20s.  The gyro output carries per conversion noise and a bias that
+ * drifts over the trace.  While the robot stands still the lift rests on its
+ * switch at -LIFT_REST_POWER and the arm holds against gravity, as they do on
+ * the robot, unless a trace turns the holds off.
+ *
+ * Every trace is run through vexgyro.c and through the original algorithm,
+ * one conversion per ms with a fixed deadband and bias correction, and the
+ * final heading errors are printed.  The harness fails if the bias is not
+ * tracked for most of the still time, or if the heading error is above the
+ * limit of the trace or no better than the original.
+ */
+
+#include "vexgyro.c"
+
+#include <math.h>
+#include <stdio.h>
+
+#define TRACE_TIME 120000
+#define GYRO_IDLE_COUNTS 1860.3
+#define GYRO_DEG_PER_COUNT 0.769
+
+#define DRIVE_FORWARD 60
+#define LIFT_REST_POWER 15
+#define ARM_GRAVITY_POWER 18
+
+// ms of the still periods, less the time needed to see them as still
+#define GYRO_STILL_LIMIT 15000
+
+typedef struct {
+    double drift; // bias change in raw counts over the trace
+    double noise; // noise per conversion in raw counts
+    bool holds;   // lift and arm hold while the robot is still
+    double limit; // heading error in deg allowed after the trace
+} trace_t;
+
+static const trace_t traces[] = {
+    {0.0, 2.0, true, 2.0}, {0.5, 2.0, true, 4.0}, {2.0, 3.0, true, 15.0}, {0.5, 2.0, false, 4.0},
+};
+
+systime_t mockNow;
+systime_t mockEnd;
+
+static const trace_t *trace;
+static uint32_t seed;
+static int conv[VEX_ADC_DEPTH];
+static int16_t motors[kVexMotorNum];
+static double encoder;
+static double rate;
+static double target;
+static double heading;
+static int32_t stillTime;
+
+// the original algorithm
+static int32_t oldBiasAcc;
+static int32_t oldBias;
+static int32_t oldSmallBias;
+static int32_t oldFiltered;
+static int32_t oldCycles;
+static int32_t oldValue;
+
+static uint32_t
+random32(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static double
+gauss(void)
+{
+    double u = (random32() + 1.0) / 4294967297.0;
+    double v = (random32() + 1.0) / 4294967297.0;
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+int32_t
+vexAdcGetSum(int16_t index)
+{
+    int32_t sum = 0;
+    int k;
+
+    (void)index;
+    for (k = 0; k < VEX_ADC_DEPTH; k++) {
+        sum += conv[k];
+    }
+    return sum;
+}
+
+int16_t
+vexMotorGet(int16_t index)
+{
+    return motors[index];
+}
+
+int32_t
+vexMotorPositionGet(int16_t index)
+{
+    // IMEs on the left and right drive
+    return (index == kVexMotor_1 || index == kVexMotor_3) ? (int32_t)encoder : 0;
+}
+
+int32_t
+vexEncoderGet(int16_t channel)
+{
+    return (channel == kVexQuadEncoder_1) ? (int32_t)encoder : 0;
+}
+
+static bool
+robotStill(uint32_t t)
+{
+    return (t < 15000 || (t >= 30000 && t < 33000) || (t >= 33000 && (t % 20000) < 2000));
+}
+
+static void
+robotStep(uint32_t t)
+{
+    double bias = GYRO_IDLE_COUNTS + trace->drift * t / TRACE_TIME;
+    int turn;
+    int k;
+
+    if (robotStill(t)) {
+        target = 0;
+        for (k = 0; k < kVexMotorNum; k++) {
+            motors[k] = 0;
+        }
+        if (trace->holds) {
+            motors[kVexMotor_5] = -LIFT_REST_POWER;
+            motors[kVexMotor_6] = ARM_GRAVITY_POWER + (int16_t)(random32() % 9) - 4;
+        }
+    } else {
+        // a new turn rate every 1.5s, sometimes with a slow creep
+        if (t % 1500 == 0) {
+            target = ((int)(random32() % 3) - 1) * (60.0 + random32() % 200) + ((random32() % 4 == 0) ? 1.5 : 0.0);
+        }
+        turn = (int)(target * 127 / 300);
+        motors[kVexMotor_1] = motors[kVexMotor_2] = DRIVE_FORWARD + turn;
+        motors[kVexMotor_3] = motors[kVexMotor_4] = DRIVE_FORWARD - turn;
+        motors[kVexMotor_5] = 0;
+        motors[kVexMotor_6] = ARM_GRAVITY_POWER;
+        encoder += 0.5;
+    }
+
+    rate += (target - rate) * 0.01;
+    if (target == 0 && fabs(rate) < 0.01) {
+        rate = 0;
+    }
+    heading += rate * 0.01;
+
+    for (k = 0; k < VEX_ADC_DEPTH; k++) {
+        int r = (int)floor(bias + rate / GYRO_DEG_PER_COUNT + trace->noise * gauss() + 0.5);
+        conv[k] = (r < 0) ? 0 : ((r > 4095) ? 4095 : r);
+    }
+    return;
+}
+
+static void
+oldStep(uint32_t t)
+{
+    int32_t d;
+
+    if (t <= 1024) {
+        oldBiasAcc += conv[VEX_ADC_DEPTH - 1];
+        if (t == 1024) {
+            oldBias = oldBiasAcc / 1024;
+            oldSmallBias = oldBiasAcc - oldBias * 1024;
+        }
+        return;
+    }
+    d = conv[VEX_ADC_DEPTH - 1] - oldBias;
+    if (d < -4 || d > 4) {
+        oldFiltered += d;
+        if ((++oldCycles % 1024) == 0) {
+            oldFiltered -= oldSmallBias;
+        }
+    }
+    oldValue = oldFiltered / GYRO_SENSOR_SCALE;
+    return;
+}
+
+void
+mockTick(void)
+{
+    robotStep(mockNow);
+    oldStep(mockNow);
+    if (vexGyroStillGet()) {
+        stillTime++;
+    }
+    return;
+}
+
+static int
+replay(const trace_t *t)
+{
+    double newError;
+    double oldError;
+    int failed;
+
+    trace = t;
+    seed = 2463534242u;
+    mockNow = 0;
+    mockEnd = TRACE_TIME;
+    encoder = rate = target = heading = 0;
+    stillTime = 0;
+    oldBiasAcc = oldBias = oldSmallBias = oldFiltered = oldCycles = oldValue = 0;
+
+    robotStep(0);
+    vexGyroInit(kVexAnalog_1);
+
+    newError = fabs(vexGyroGet() - heading) / 10;
+    oldError = fabs(oldValue - heading) / 10;
+    failed = (stillTime < GYRO_STILL_LIMIT || newError > t->limit || newError >= oldError);
+    printf("drift %.1f noise %.1f holds %-3s  still %5.1fs  error %6.2f deg (original %6.2f deg)%s\n", t->drift, t->noise,
+           t->holds ? "on" : "off", stillTime / 1000.0, newError, oldError, failed ? "  FAILED" : "");
+    return failed;
+}
+
+int
+main(void)
+{
+    int failed = 0;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(traces) / sizeof(traces[0]); i++) {
+        failed |= replay(&traces[i]);
+    }
+    return failed;
+}